@@ -0,0 +1,202 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Appliance registry with incrementally maintained load totals, see
+ * ApplianceRegistry.h.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "ApplianceRegistry.h"
+
+#define applianceWORD( usId )    ( ( usId ) / applianceBITS_PER_WORD )
+#define applianceBIT( usId )     ( 1UL << ( ( usId ) % applianceBITS_PER_WORD ) )
+
+/* Add lDelta W to the total of ucPriority, and to the running totals of
+ * ucPriority and every less important priority. */
+static void prvAdjustLoad( ApplianceRegistry_t * pxRegistry,
+                           uint8_t ucPriority,
+                           int32_t lDelta );
+
+/*-----------------------------------------------------------*/
+
+void vApplianceRegistryInit( ApplianceRegistry_t * pxRegistry )
+{
+    memset( pxRegistry, 0x00, sizeof( *pxRegistry ) );
+}
+/*-----------------------------------------------------------*/
+
+uint16_t usApplianceRegister( ApplianceRegistry_t * pxRegistry,
+                              const char * pcName,
+                              uint16_t usPower,
+                              uint8_t ucPriority,
+                              bool bOn )
+{
+    uint16_t usId = applianceINVALID_ID;
+
+    configASSERT( ucPriority < applianceNUM_PRIORITIES );
+
+    taskENTER_CRITICAL();
+    {
+        if( pxRegistry->usCount < applianceMAX_DEVICES )
+        {
+            usId = pxRegistry->usCount;
+            pxRegistry->xDevices[ usId ].pcName = pcName;
+            pxRegistry->xDevices[ usId ].usPower = usPower;
+            pxRegistry->xDevices[ usId ].ucPriority = ucPriority;
+            pxRegistry->xDevices[ usId ].bStatus = false;
+            pxRegistry->usCount++;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if( ( usId != applianceINVALID_ID ) && bOn )
+    {
+        vApplianceSetStatus( pxRegistry, usId, true );
+    }
+
+    return usId;
+}
+/*-----------------------------------------------------------*/
+
+void vApplianceSetStatus( ApplianceRegistry_t * pxRegistry,
+                          uint16_t usId,
+                          bool bOn )
+{
+    Appliance * pxDevice;
+
+    configASSERT( usId < pxRegistry->usCount );
+    pxDevice = &( pxRegistry->xDevices[ usId ] );
+
+    taskENTER_CRITICAL();
+    {
+        if( pxDevice->bStatus != bOn )
+        {
+            pxDevice->bStatus = bOn;
+
+            if( bOn )
+            {
+                pxRegistry->ulOn[ pxDevice->ucPriority ][ applianceWORD( usId ) ] |= applianceBIT( usId );
+                prvAdjustLoad( pxRegistry, pxDevice->ucPriority, ( int32_t ) pxDevice->usPower );
+            }
+            else
+            {
+                pxRegistry->ulOn[ pxDevice->ucPriority ][ applianceWORD( usId ) ] &= ~applianceBIT( usId );
+                prvAdjustLoad( pxRegistry, pxDevice->ucPriority, -( int32_t ) pxDevice->usPower );
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+const Appliance * pxApplianceGet( const ApplianceRegistry_t * pxRegistry,
+                                  uint16_t usId )
+{
+    configASSERT( usId < pxRegistry->usCount );
+
+    return &( pxRegistry->xDevices[ usId ] );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulApplianceGetTotalLoad( const ApplianceRegistry_t * pxRegistry )
+{
+    return pxRegistry->ulLoadAtOrAbove[ applianceNUM_PRIORITIES - 1U ];
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulApplianceGetLoadAtPriority( const ApplianceRegistry_t * pxRegistry,
+                                       uint8_t ucPriority )
+{
+    if( ucPriority >= applianceNUM_PRIORITIES )
+    {
+        ucPriority = ( uint8_t ) ( applianceNUM_PRIORITIES - 1U );
+    }
+
+    return pxRegistry->ulLoadAtOrAbove[ ucPriority ];
+}
+/*-----------------------------------------------------------*/
+
+uint16_t usApplianceFindOn( const ApplianceRegistry_t * pxRegistry,
+                            uint8_t ucPriority,
+                            uint16_t usStart )
+{
+    uint16_t usFound = applianceINVALID_ID;
+    uint32_t ulWord, ulIndex;
+
+    configASSERT( ucPriority < applianceNUM_PRIORITIES );
+
+    if( usStart < pxRegistry->usCount )
+    {
+        ulIndex = applianceWORD( usStart );
+
+        /* Ignore the bits below usStart in the first word. */
+        ulWord = pxRegistry->ulOn[ ucPriority ][ ulIndex ] & ~( applianceBIT( usStart ) - 1UL );
+
+        for( ; ; )
+        {
+            if( ulWord != 0UL )
+            {
+                usFound = ( uint16_t ) ( ( ulIndex * applianceBITS_PER_WORD ) + ( uint32_t ) __builtin_ctz( ulWord ) );
+                break;
+            }
+
+            ulIndex++;
+
+            if( ulIndex >= applianceBITSET_WORDS )
+            {
+                break;
+            }
+
+            ulWord = pxRegistry->ulOn[ ucPriority ][ ulIndex ];
+        }
+    }
+
+    return usFound;
+}
+/*-----------------------------------------------------------*/
+
+static void prvAdjustLoad( ApplianceRegistry_t * pxRegistry,
+                           uint8_t ucPriority,
+                           int32_t lDelta )
+{
+    uint32_t ulPriority;
+
+    pxRegistry->ulPriorityLoad[ ucPriority ] += ( uint32_t ) lDelta;
+
+    for( ulPriority = ucPriority; ulPriority < applianceNUM_PRIORITIES; ulPriority++ )
+    {
+        pxRegistry->ulLoadAtOrAbove[ ulPriority ] += ( uint32_t ) lDelta;
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,135 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef APPLIANCE_REGISTRY_H
+#define APPLIANCE_REGISTRY_H
+
+/*
+ * Registry of the appliances in a household.
+ *
+ * The load is kept up to date as appliances are switched, instead of being
+ * summed every sample.  For each priority the registry holds a bitset of the
+ * appliances that are on and the 32-bit total of their power, plus a running
+ * total across priorities, so both the total load and the load at priority N
+ * or better are single reads whatever the number of appliances.
+ *
+ * Switching an appliance is a short critical section.  The query functions
+ * read one word and need no locking.
+ */
+
+#include <stdbool.h>
+
+/* Most appliances one registry can hold. */
+#ifndef applianceMAX_DEVICES
+    #define applianceMAX_DEVICES    ( 256U )
+#endif
+
+/* Priorities run from 0, the most important, to applianceNUM_PRIORITIES - 1. */
+#ifndef applianceNUM_PRIORITIES
+    #define applianceNUM_PRIORITIES    ( 8U )
+#endif
+
+#define applianceBITS_PER_WORD      ( 32U )
+#define applianceBITSET_WORDS       ( ( applianceMAX_DEVICES + applianceBITS_PER_WORD - 1U ) / applianceBITS_PER_WORD )
+
+/* Returned by usApplianceRegister() when the registry is full. */
+#define applianceINVALID_ID         ( 0xFFFFU )
+
+/* Structure of an appliance */
+typedef struct {
+    const char * pcName;
+    uint16_t usPower;   // Power consuption in W
+    bool bStatus;       // On or Off
+    uint8_t ucPriority; // Lowest number means higher priority
+} Appliance;
+
+typedef struct ApplianceRegistry
+{
+    Appliance xDevices[ applianceMAX_DEVICES ];
+    uint16_t usCount;
+
+    /* Bit n of ulOn[ p ] is set when device n has priority p and is on. */
+    uint32_t ulOn[ applianceNUM_PRIORITIES ][ applianceBITSET_WORDS ];
+
+    /* Power of the devices that are on at each priority, and at each priority
+     * or better. */
+    uint32_t ulPriorityLoad[ applianceNUM_PRIORITIES ];
+    volatile uint32_t ulLoadAtOrAbove[ applianceNUM_PRIORITIES ];
+} ApplianceRegistry_t;
+
+/*
+ * Empty a registry.  A zero initialised static registry is already empty.
+ */
+void vApplianceRegistryInit( ApplianceRegistry_t * pxRegistry );
+
+/*
+ * Add an appliance.  pcName is not copied so must remain valid.  Returns the
+ * ID used to refer to the appliance, or applianceINVALID_ID if the registry
+ * is full.
+ */
+uint16_t usApplianceRegister( ApplianceRegistry_t * pxRegistry,
+                              const char * pcName,
+                              uint16_t usPower,
+                              uint8_t ucPriority,
+                              bool bOn );
+
+/*
+ * Switch an appliance on or off.  Switching to the state it is already in
+ * does nothing.
+ */
+void vApplianceSetStatus( ApplianceRegistry_t * pxRegistry,
+                          uint16_t usId,
+                          bool bOn );
+
+/*
+ * Returns the appliance with the given ID.
+ */
+const Appliance * pxApplianceGet( const ApplianceRegistry_t * pxRegistry,
+                                  uint16_t usId );
+
+/*
+ * Returns the power, in W, of every appliance that is on.
+ */
+uint32_t ulApplianceGetTotalLoad( const ApplianceRegistry_t * pxRegistry );
+
+/*
+ * Returns the power, in W, of the appliances that are on and have a priority
+ * of ucPriority or better (a number less than or equal to ucPriority).
+ */
+uint32_t ulApplianceGetLoadAtPriority( const ApplianceRegistry_t * pxRegistry,
+                                       uint8_t ucPriority );
+
+/*
+ * Find the first appliance at or after usStart that is on and has exactly
+ * priority ucPriority.  Returns its ID, or applianceINVALID_ID if there is
+ * none.  Cost is proportional to the number of bitset words scanned, not to
+ * the number of appliances.
+ */
+uint16_t usApplianceFindOn( const ApplianceRegistry_t * pxRegistry,
+                            uint8_t ucPriority,
+                            uint16_t usStart );
+
+#endif /* APPLIANCE_REGISTRY_H */
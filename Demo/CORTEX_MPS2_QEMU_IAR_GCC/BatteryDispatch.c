@@ -0,0 +1,319 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Price aware battery dispatch, see BatteryDispatch.h.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "BatteryDispatch.h"
+
+#define dispatchLAST_LEVEL    ( dispatchSOC_LEVELS - 1U )
+
+/* Energy held at a level, in W.h. */
+static int32_t prvLevelEnergy( const BatteryDispatch_t * pxDispatch,
+                               UBaseType_t uxLevel );
+
+/* Level closest to lEnergy W.h. */
+static UBaseType_t prvNearestLevel( const BatteryDispatch_t * pxDispatch,
+                                    int32_t lEnergy );
+
+/* Value of llGrid W.h sold, or bought if negative, in slot uxSlot of the
+ * solve in progress. */
+static int64_t prvGridValue( const BatteryDispatch_t * pxDispatch,
+                             UBaseType_t uxSlot,
+                             int64_t llGrid );
+
+/*-----------------------------------------------------------*/
+
+void vBatteryDispatchInit( BatteryDispatch_t * pxDispatch,
+                           uint32_t ulCapacity,
+                           uint32_t ulMaxSlotEnergy )
+{
+    uint32_t ulStep;
+
+    /* Energies are int32_t, so the capacity must fit in one. */
+    configASSERT( ( ulCapacity > 0UL ) && ( ulCapacity <= ( uint32_t ) INT32_MAX ) );
+    configASSERT( dispatchSOC_LEVELS <= 256U );
+
+    memset( pxDispatch, 0x00, sizeof( *pxDispatch ) );
+    pxDispatch->ulCapacity = ulCapacity;
+    pxDispatch->ulMaxSlotEnergy = ulMaxSlotEnergy;
+
+    /* Whole levels the battery can move in a slot, at least one so the plan
+     * can always do something. */
+    ulStep = ( ulCapacity + ( dispatchLAST_LEVEL / 2U ) ) / dispatchLAST_LEVEL;
+    pxDispatch->uxMaxStep = ( UBaseType_t ) ( ulMaxSlotEnergy / ( ( ulStep > 0UL ) ? ulStep : 1UL ) );
+
+    if( pxDispatch->uxMaxStep == 0U )
+    {
+        pxDispatch->uxMaxStep = 1U;
+    }
+    else if( pxDispatch->uxMaxStep > dispatchLAST_LEVEL )
+    {
+        pxDispatch->uxMaxStep = dispatchLAST_LEVEL;
+    }
+    else
+    {
+        /* In range. */
+    }
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xBatteryDispatchIsSolving( const BatteryDispatch_t * pxDispatch )
+{
+    return pxDispatch->xSolving;
+}
+/*-----------------------------------------------------------*/
+
+void vBatteryDispatchStartSolve( BatteryDispatch_t * pxDispatch,
+                                 uint32_t ulSlot,
+                                 const BatteryDispatchInputs_t * pxInputs )
+{
+    UBaseType_t uxLevel, uxSlot;
+    int32_t lMeanPrice = 0;
+
+    pxDispatch->xInputs = *pxInputs;
+    pxDispatch->ulSolveSlot = ulSlot;
+
+    /* Value what is left in the battery at the end of the horizon between
+     * what it would save and what it would earn, so the plan neither sells it
+     * all off at the last moment nor hoards it. */
+    for( uxSlot = 0; uxSlot < dispatchHORIZON_SLOTS; uxSlot++ )
+    {
+        lMeanPrice += pxInputs->lImport[ uxSlot ] + pxInputs->lExport[ uxSlot ];
+    }
+
+    lMeanPrice /= ( int32_t ) ( 2U * dispatchHORIZON_SLOTS );
+
+    for( uxLevel = 0; uxLevel < dispatchSOC_LEVELS; uxLevel++ )
+    {
+        pxDispatch->llValue[ 0 ][ uxLevel ] = ( int64_t ) prvLevelEnergy( pxDispatch, uxLevel ) * lMeanPrice;
+    }
+
+    pxDispatch->uxSlot = dispatchHORIZON_SLOTS - 1U;
+    pxDispatch->uxLevel = 0;
+    pxDispatch->xSolving = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xBatteryDispatchStep( BatteryDispatch_t * pxDispatch,
+                                 UBaseType_t uxBudget )
+{
+    UBaseType_t uxBuilding = pxDispatch->uxActive ^ 1U;
+    UBaseType_t uxDone = 0, uxFirst, uxLast, uxNext, uxBest;
+    int32_t lNet, lEnergy;
+    int64_t llBest, llCandidate;
+    BaseType_t xCompleted = pdFALSE;
+
+    /* A smaller budget could never fit a level, and the solve would stall. */
+    configASSERT( uxBudget >= dispatchMIN_BUDGET );
+
+    /* A level costs up to 2 * uxMaxStep + 1 relaxations.  Only start one if
+     * it fits in what is left of the budget, so the budget is never exceeded. */
+    while( ( pxDispatch->xSolving != pdFALSE ) &&
+           ( ( uxDone + ( 2U * pxDispatch->uxMaxStep ) + 1U ) <= uxBudget ) )
+    {
+        lNet = pxDispatch->xInputs.lNet[ pxDispatch->uxSlot ];
+        lEnergy = prvLevelEnergy( pxDispatch, pxDispatch->uxLevel );
+
+        uxFirst = ( pxDispatch->uxLevel > pxDispatch->uxMaxStep ) ? ( pxDispatch->uxLevel - pxDispatch->uxMaxStep ) : 0U;
+        uxLast = pxDispatch->uxLevel + pxDispatch->uxMaxStep;
+
+        if( uxLast > dispatchLAST_LEVEL )
+        {
+            uxLast = dispatchLAST_LEVEL;
+        }
+
+        /* Staying put is tried first, so a move is only made when it is worth
+         * strictly more. */
+        uxBest = pxDispatch->uxLevel;
+        llBest = prvGridValue( pxDispatch, pxDispatch->uxSlot, lNet ) + pxDispatch->llValue[ 0 ][ uxBest ];
+        uxDone++;
+
+        for( uxNext = uxFirst; uxNext <= uxLast; uxNext++ )
+        {
+            if( uxNext != pxDispatch->uxLevel )
+            {
+                /* Whatever the battery does not absorb is sold, or whatever it
+                 * gives up is bought less. */
+                llCandidate = prvGridValue( pxDispatch, pxDispatch->uxSlot,
+                                            ( int64_t ) lNet - ( ( int64_t ) prvLevelEnergy( pxDispatch, uxNext ) - lEnergy ) ) +
+                              pxDispatch->llValue[ 0 ][ uxNext ];
+
+                if( llCandidate > llBest )
+                {
+                    llBest = llCandidate;
+                    uxBest = uxNext;
+                }
+
+                uxDone++;
+            }
+        }
+
+        pxDispatch->llValue[ 1 ][ pxDispatch->uxLevel ] = llBest;
+        pxDispatch->ucNext[ uxBuilding ][ pxDispatch->uxSlot ][ pxDispatch->uxLevel ] = ( uint8_t ) uxBest;
+        pxDispatch->uxLevel++;
+
+        if( pxDispatch->uxLevel == dispatchSOC_LEVELS )
+        {
+            /* This slot is done, move back to the one before it. */
+            memcpy( pxDispatch->llValue[ 0 ], pxDispatch->llValue[ 1 ], sizeof( pxDispatch->llValue[ 0 ] ) );
+            pxDispatch->uxLevel = 0;
+
+            if( pxDispatch->uxSlot == 0U )
+            {
+                pxDispatch->xSolving = pdFALSE;
+                pxDispatch->ulSolves++;
+
+                /* Switch plans with the reader locked out, so it never mixes
+                 * the plan in use with the slot it is for. */
+                taskENTER_CRITICAL();
+                {
+                    pxDispatch->uxActive = uxBuilding;
+                    pxDispatch->ulActiveSlot = pxDispatch->ulSolveSlot;
+                    pxDispatch->xHavePlan = pdTRUE;
+                }
+                taskEXIT_CRITICAL();
+
+                xCompleted = pdTRUE;
+            }
+            else
+            {
+                pxDispatch->uxSlot--;
+            }
+        }
+    }
+
+    if( uxDone > pxDispatch->ulMaxRelaxations )
+    {
+        pxDispatch->ulMaxRelaxations = ( uint32_t ) uxDone;
+    }
+
+    return xCompleted;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulBatteryDispatchGetResolution( const BatteryDispatch_t * pxDispatch )
+{
+    return pxDispatch->ulCapacity / dispatchLAST_LEVEL;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xBatteryDispatchGetTarget( BatteryDispatch_t * pxDispatch,
+                                      uint32_t ulSlot,
+                                      uint32_t ulLevel,
+                                      uint32_t * pulTarget )
+{
+    UBaseType_t uxLevel, uxNext = 0;
+    uint32_t ulRow;
+    int64_t llTarget;
+    BaseType_t xReturn = pdFALSE;
+
+    uxLevel = prvNearestLevel( pxDispatch, ( int32_t ) ulLevel );
+
+    taskENTER_CRITICAL();
+    {
+        ulRow = ulSlot - pxDispatch->ulActiveSlot;
+
+        if( ( pxDispatch->xHavePlan != pdFALSE ) && ( ulRow < dispatchHORIZON_SLOTS ) )
+        {
+            uxNext = pxDispatch->ucNext[ pxDispatch->uxActive ][ ulRow ][ uxLevel ];
+            xReturn = pdTRUE;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if( xReturn != pdFALSE )
+    {
+        /* Apply the planned move to the actual level rather than jumping to
+         * the level the plan has, otherwise rounding to the nearest level would
+         * have the battery trade back and forth for nothing. */
+        llTarget = ( int64_t ) ulLevel + ( prvLevelEnergy( pxDispatch, uxNext ) - prvLevelEnergy( pxDispatch, uxLevel ) );
+
+        if( llTarget < 0 )
+        {
+            llTarget = 0;
+        }
+        else if( llTarget > ( int64_t ) pxDispatch->ulCapacity )
+        {
+            llTarget = ( int64_t ) pxDispatch->ulCapacity;
+        }
+        else
+        {
+            /* In range. */
+        }
+
+        *pulTarget = ( uint32_t ) llTarget;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static int32_t prvLevelEnergy( const BatteryDispatch_t * pxDispatch,
+                               UBaseType_t uxLevel )
+{
+    return ( int32_t ) ( ( ( uint64_t ) pxDispatch->ulCapacity * uxLevel ) / dispatchLAST_LEVEL );
+}
+/*-----------------------------------------------------------*/
+
+static int64_t prvGridValue( const BatteryDispatch_t * pxDispatch,
+                             UBaseType_t uxSlot,
+                             int64_t llGrid )
+{
+    return llGrid * ( ( llGrid >= 0 ) ? pxDispatch->xInputs.lExport[ uxSlot ] : pxDispatch->xInputs.lImport[ uxSlot ] );
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvNearestLevel( const BatteryDispatch_t * pxDispatch,
+                                    int32_t lEnergy )
+{
+    UBaseType_t uxLevel = 0;
+
+    if( lEnergy >= ( int32_t ) pxDispatch->ulCapacity )
+    {
+        uxLevel = dispatchLAST_LEVEL;
+    }
+    else if( lEnergy > 0 )
+    {
+        uxLevel = ( UBaseType_t ) ( ( ( ( uint64_t ) lEnergy * dispatchLAST_LEVEL ) + ( pxDispatch->ulCapacity / 2U ) ) / pxDispatch->ulCapacity );
+    }
+    else
+    {
+        /* Empty. */
+    }
+
+    return uxLevel;
+}
+/*-----------------------------------------------------------*/
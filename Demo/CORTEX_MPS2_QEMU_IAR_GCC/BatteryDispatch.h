@@ -0,0 +1,150 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef BATTERY_DISPATCH_H
+#define BATTERY_DISPATCH_H
+
+/*
+ * Price aware battery dispatch.
+ *
+ * Plans how much energy the battery should hold at the end of each of the
+ * next dispatchHORIZON_SLOTS slots so that the value of the energy exchanged
+ * with the grid is as high as possible, given forecasts of the net solar
+ * energy (solar minus load) and the price in each slot.  The state of charge
+ * is discretised into dispatchSOC_LEVELS levels and the plan is found by
+ * backward dynamic programming in integer arithmetic:
+ *
+ *   V[ t ][ s ] = max over s' of ( value( t, grid( t, s, s' ) ) + V[ t + 1 ][ s' ] )
+ *
+ * where grid() is the energy sold (negative if bought) when the battery goes
+ * from level s to level s' while the household nets lNet[ t ], value() prices
+ * it at the export or import price of the slot, and s' is limited by the rate
+ * at which the battery can charge or discharge.  Energy left at the end of the
+ * horizon is valued halfway between the mean import and export prices.  Tier
+ * surcharges and fixed charges are not modelled.
+ *
+ * A full solve takes up to dispatchHORIZON_SLOTS * dispatchSOC_LEVELS *
+ * dispatchSOC_LEVELS relaxations, which is too long to run in one go next to
+ * the control tasks.  Instead xBatteryDispatchStep() does at most a given
+ * number of relaxations each call, which bounds the time it takes, and a solve
+ * is spread over as many calls as it needs.  Each relaxation is a handful of
+ * integer operations.  The plan in use is only replaced once a solve
+ * completes, so a target is always available from the last complete plan.
+ * A call must be allowed at least dispatchMIN_BUDGET relaxations, the most
+ * one level of one slot can take, or the solve could never move on.
+ *
+ * Values are 64 bit, so they do not overflow whatever the capacity, which can
+ * be up to INT32_MAX W.h.
+ */
+
+#ifndef dispatchHORIZON_SLOTS
+    #define dispatchHORIZON_SLOTS    ( 24U )
+#endif
+
+#ifndef dispatchSOC_LEVELS
+    #define dispatchSOC_LEVELS       ( 21U )
+#endif
+
+/* Fewest relaxations xBatteryDispatchStep() can be given. */
+#define dispatchMIN_BUDGET           ( ( 2U * ( dispatchSOC_LEVELS - 1U ) ) + 1U )
+
+/* Forecast for the horizon, starting with the slot the solve is for. */
+typedef struct BatteryDispatchInputs
+{
+    int32_t lNet[ dispatchHORIZON_SLOTS ];    /* Solar minus load in W.h. */
+    int32_t lImport[ dispatchHORIZON_SLOTS ]; /* Import price in miliCents/W.h. */
+    int32_t lExport[ dispatchHORIZON_SLOTS ]; /* Export price in miliCents/W.h. */
+} BatteryDispatchInputs_t;
+
+typedef struct BatteryDispatch
+{
+    uint32_t ulCapacity;      /* W.h */
+    uint32_t ulMaxSlotEnergy; /* Most the battery can charge or discharge in a slot, in W.h. */
+    UBaseType_t uxMaxStep;    /* The same in levels. */
+
+    /* The solve in progress. */
+    BaseType_t xSolving;
+    uint32_t ulSolveSlot;
+    BatteryDispatchInputs_t xInputs;
+    int64_t llValue[ 2 ][ dispatchSOC_LEVELS ]; /* V[ t + 1 ] and V[ t ]. */
+    UBaseType_t uxSlot;                        /* t, counting down. */
+    UBaseType_t uxLevel;                       /* s, counting up. */
+
+    /* The level to move to from each level in each slot.  One plan is in use
+     * while the other is being solved. */
+    uint8_t ucNext[ 2 ][ dispatchHORIZON_SLOTS ][ dispatchSOC_LEVELS ];
+    UBaseType_t uxActive;
+    uint32_t ulActiveSlot;
+    BaseType_t xHavePlan;
+
+    /* Statistics. */
+    uint32_t ulSolves;
+    uint32_t ulMaxRelaxations; /* Most relaxations done by one call. */
+} BatteryDispatch_t;
+
+void vBatteryDispatchInit( BatteryDispatch_t * pxDispatch,
+                           uint32_t ulCapacity,
+                           uint32_t ulMaxSlotEnergy );
+
+/*
+ * Returns pdTRUE while a solve is in progress.
+ */
+BaseType_t xBatteryDispatchIsSolving( const BatteryDispatch_t * pxDispatch );
+
+/*
+ * Start solving for the horizon beginning at slot ulSlot.  pxInputs is
+ * copied.  Any solve in progress is abandoned.
+ */
+void vBatteryDispatchStartSolve( BatteryDispatch_t * pxDispatch,
+                                 uint32_t ulSlot,
+                                 const BatteryDispatchInputs_t * pxInputs );
+
+/*
+ * Carry on with the solve in progress, doing no more than uxBudget
+ * relaxations, which must be at least dispatchMIN_BUDGET.  Returns pdTRUE if
+ * the solve completed and its plan is now the one in use.
+ */
+BaseType_t xBatteryDispatchStep( BatteryDispatch_t * pxDispatch,
+                                 UBaseType_t uxBudget );
+
+/*
+ * Returns the energy between two levels of the plan, in W.h.  The plan cannot
+ * tell apart levels closer than this.
+ */
+uint32_t ulBatteryDispatchGetResolution( const BatteryDispatch_t * pxDispatch );
+
+/*
+ * Look up the energy the plan in use wants in the battery at the end of slot
+ * ulSlot, starting from ulLevel W.h.  The planned move between levels is
+ * applied to ulLevel itself.  Returns pdFALSE if no plan covers the
+ * slot, in which case *pulTarget is not written.  Can be called from any task.
+ */
+BaseType_t xBatteryDispatchGetTarget( BatteryDispatch_t * pxDispatch,
+                                      uint32_t ulSlot,
+                                      uint32_t ulLevel,
+                                      uint32_t * pulTarget );
+
+#endif /* BATTERY_DISPATCH_H */
@@ -0,0 +1,185 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Lock free battery ledger, see BatteryLedger.h.
+ */
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+
+/* Demo includes. */
+#include "BatteryLedger.h"
+
+/* Apply a signed change to the level, saturating at 0 and the capacity.
+ * *pulLost receives the part of the change that could not be applied. */
+static uint32_t prvApply( BatteryLedger_t * pxLedger,
+                          uint32_t ulEnergy,
+                          BaseType_t xCharge,
+                          uint32_t * pulLost );
+
+/*-----------------------------------------------------------*/
+
+#if defined( __ARM_ARCH_7M__ ) || defined( __ARM_ARCH_7EM__ )
+
+    static uint32_t prvLoadExclusive( volatile uint32_t * pulAddress )
+    {
+        uint32_t ulValue;
+
+        __asm volatile ( "ldrex %0, [%1]" : "=r" ( ulValue ) : "r" ( pulAddress ) : "memory" );
+
+        return ulValue;
+    }
+    /*-----------------------------------------------------------*/
+
+    /* Returns pdTRUE if the store happened, pdFALSE if the reservation was
+     * lost and the update must be retried. */
+    static BaseType_t prvStoreExclusive( volatile uint32_t * pulAddress,
+                                         uint32_t ulValue )
+    {
+        uint32_t ulFailed;
+
+        __asm volatile ( "strex %0, %2, [%1]" : "=&r" ( ulFailed ) : "r" ( pulAddress ), "r" ( ulValue ) : "memory" );
+
+        return ( ulFailed == 0UL ) ? pdTRUE : pdFALSE;
+    }
+    /*-----------------------------------------------------------*/
+
+    #define ledgerLOAD( pulAddress )                            prvLoadExclusive( pulAddress )
+    #define ledgerSTORE( pulAddress, ulExpected, ulNew )        prvStoreExclusive( ( pulAddress ), ( ulNew ) )
+
+#else /* if defined( __ARM_ARCH_7M__ ) || defined( __ARM_ARCH_7EM__ ) */
+
+    #define ledgerLOAD( pulAddress )                            __atomic_load_n( ( pulAddress ), __ATOMIC_RELAXED )
+    #define ledgerSTORE( pulAddress, ulExpected, ulNew )        \
+    ( __atomic_compare_exchange_n( ( pulAddress ), &( ulExpected ), ( ulNew ), pdTRUE, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED ) ? pdTRUE : pdFALSE )
+
+#endif /* if defined( __ARM_ARCH_7M__ ) || defined( __ARM_ARCH_7EM__ ) */
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvApply( BatteryLedger_t * pxLedger,
+                          uint32_t ulEnergy,
+                          BaseType_t xCharge,
+                          uint32_t * pulLost )
+{
+    uint32_t ulOld, ulNew, ulLost, ulCapacity;
+
+    do
+    {
+        ulOld = ledgerLOAD( &( pxLedger->ulLevel ) );
+
+        if( xCharge != pdFALSE )
+        {
+            /* Read after the level, so the capacity is the one in force for
+             * the reservation. */
+            ulCapacity = pxLedger->ulCapacity;
+
+            if( ulOld >= ulCapacity )
+            {
+                /* Full, or above a capacity that has just been reduced. */
+                ulNew = ulOld;
+            }
+            else if( ulEnergy > ( ulCapacity - ulOld ) )
+            {
+                ulNew = ulCapacity;
+            }
+            else
+            {
+                ulNew = ulOld + ulEnergy;
+            }
+
+            ulLost = ulEnergy - ( ulNew - ulOld );
+        }
+        else
+        {
+            if( ulEnergy > ulOld )
+            {
+                ulNew = 0;
+            }
+            else
+            {
+                ulNew = ulOld - ulEnergy;
+            }
+
+            ulLost = ulEnergy - ( ulOld - ulNew );
+        }
+    } while( ledgerSTORE( &( pxLedger->ulLevel ), ulOld, ulNew ) == pdFALSE );
+
+    if( pulLost != NULL )
+    {
+        *pulLost = ulLost;
+    }
+
+    return ulNew;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulBatteryLedgerCharge( BatteryLedger_t * pxLedger,
+                                uint32_t ulEnergy,
+                                uint32_t * pulOverflow )
+{
+    return prvApply( pxLedger, ulEnergy, pdTRUE, pulOverflow );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulBatteryLedgerDischarge( BatteryLedger_t * pxLedger,
+                                   uint32_t ulEnergy,
+                                   uint32_t * pulShortfall )
+{
+    return prvApply( pxLedger, ulEnergy, pdFALSE, pulShortfall );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulBatteryLedgerSetCapacity( BatteryLedger_t * pxLedger,
+                                     uint32_t ulCapacity,
+                                     uint32_t * pulLost )
+{
+    uint32_t ulOld, ulNew;
+
+    pxLedger->ulCapacity = ulCapacity;
+
+    do
+    {
+        ulOld = ledgerLOAD( &( pxLedger->ulLevel ) );
+        ulNew = ( ulOld > ulCapacity ) ? ulCapacity : ulOld;
+    } while( ledgerSTORE( &( pxLedger->ulLevel ), ulOld, ulNew ) == pdFALSE );
+
+    if( pulLost != NULL )
+    {
+        *pulLost = ulOld - ulNew;
+    }
+
+    return ulNew;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulBatteryLedgerGetLevel( const BatteryLedger_t * pxLedger )
+{
+    /* An aligned word read is atomic on every supported target. */
+    return pxLedger->ulLevel;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,90 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef BATTERY_LEDGER_H
+#define BATTERY_LEDGER_H
+
+/*
+ * Lock free record of the energy stored in a battery.  The level is a single
+ * word updated with an atomic read-modify-write, so any number of tasks and
+ * interrupts can charge or discharge it at the same time without a mutex and
+ * without an update ever being lost.  The level saturates at zero and at the
+ * capacity, and each operation reports exactly how much energy did not fit.
+ *
+ * On ARMv7-M the update is an LDREX/STREX loop.  Elsewhere, including the
+ * Posix port, the GCC __atomic builtins are used.
+ *
+ * The capacity can change while the ledger is in use, see
+ * ulBatteryLedgerSetCapacity().
+ */
+
+typedef struct BatteryLedger
+{
+    volatile uint32_t ulLevel; /* W.h, always between 0 and ulCapacity. */
+    volatile uint32_t ulCapacity; /* W.h */
+} BatteryLedger_t;
+
+/* Initialiser for a BatteryLedger_t. */
+#define ledgerINIT( ulCapacityWh, ulInitialWh )    { ( ulInitialWh ), ( ulCapacityWh ) }
+
+/*
+ * Add ulEnergy W.h.  Whatever would take the level above the capacity is not
+ * stored and is written to *pulOverflow if pulOverflow is not NULL.  Returns
+ * the new level.
+ */
+uint32_t ulBatteryLedgerCharge( BatteryLedger_t * pxLedger,
+                                uint32_t ulEnergy,
+                                uint32_t * pulOverflow );
+
+/*
+ * Remove ulEnergy W.h.  Whatever the battery could not supply is written to
+ * *pulShortfall if pulShortfall is not NULL.  Returns the new level.
+ */
+uint32_t ulBatteryLedgerDischarge( BatteryLedger_t * pxLedger,
+                                   uint32_t ulEnergy,
+                                   uint32_t * pulShortfall );
+
+/*
+ * Change the capacity to ulCapacity W.h.  Energy above the new capacity is
+ * removed and written to *pulLost if pulLost is not NULL.  Returns the new
+ * level.
+ *
+ * On ARMv7-M a charge pre-empted by this is retried against the new
+ * capacity, as an exception clears the LDREX reservation.  A compare and swap
+ * only sees the level, so elsewhere a charge that straddles the change can
+ * finish against the old capacity.  Charges then store nothing until the
+ * level is back within the capacity.
+ */
+uint32_t ulBatteryLedgerSetCapacity( BatteryLedger_t * pxLedger,
+                                     uint32_t ulCapacity,
+                                     uint32_t * pulLost );
+
+/*
+ * Returns the current level in W.h.
+ */
+uint32_t ulBatteryLedgerGetLevel( const BatteryLedger_t * pxLedger );
+
+#endif /* BATTERY_LEDGER_H */
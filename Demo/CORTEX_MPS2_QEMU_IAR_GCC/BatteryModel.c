@@ -0,0 +1,445 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Fixed point battery model, see BatteryModel.h.
+ */
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+
+/* Demo includes. */
+#include "BatteryModel.h"
+
+/* One in Q15, and the mask of a Q15 fraction. */
+#define modelONE                  ( 32768UL )
+#define modelFRACTION_MASK        ( modelONE - 1UL )
+
+/* Positions in the efficiency tables are in 1/256ths of the most power, and
+ * the points are 32 apart. */
+#define modelPOSITION_MAX         ( 256UL )
+#define modelPOSITION_SHIFT       ( 5U )
+#define modelPOSITION_MASK        ( ( 1UL << modelPOSITION_SHIFT ) - 1UL )
+
+/* Returns the value of a table of modelEFFICIENCY_POINTS points at
+ * ulPosition, interpolating between the points either side. */
+static uint32_t prvLookup16( const uint16_t * pusTable,
+                             uint32_t ulPosition );
+static uint32_t prvLookup32( const uint32_t * pulTable,
+                             uint32_t ulPosition );
+
+/* Returns the position in the efficiency tables of ulEnergy in a period, with
+ * ulScale one of the scales of the model. */
+static uint32_t prvPosition( uint32_t ulEnergy,
+                             uint32_t ulScale );
+
+/* Returns the most energy each period, in W.h, for a rate in 1/100 C, and the
+ * scale from energy to a position in the efficiency tables. */
+static uint32_t prvMaxEnergy( uint32_t ulCapacity,
+                              uint16_t usRate,
+                              uint32_t ulPeriod,
+                              uint32_t ulHour );
+static uint32_t prvScale( uint32_t ulMaxEnergy );
+
+/* Claim up to ulWanted of what *pulUsed has left below ulLimit.  Returns
+ * what was claimed and writes what is used with it to *pulNowUsed. */
+static uint32_t prvClaim( uint32_t * pulUsed,
+                          uint32_t ulLimit,
+                          uint32_t ulWanted,
+                          uint32_t * pulNowUsed );
+
+/* Give back ulAmount of a claim, never taking *pulUsed below zero, as the
+ * period may have ended since the claim was made. */
+static void prvUnclaim( uint32_t * pulUsed,
+                        uint32_t ulAmount );
+
+/* Fade the capacity to what is left after ulCycles full cycles.  Called from
+ * vBatteryModelUpdate(). */
+static void prvFade( BatteryModel_t * pxModel,
+                     uint32_t ulCycles );
+
+/*-----------------------------------------------------------*/
+
+void vBatteryModelInit( BatteryModel_t * pxModel,
+                        const BatteryModelParams_t * pxParams,
+                        uint32_t ulCapacity,
+                        uint32_t ulInitial,
+                        uint32_t ulPeriod,
+                        uint32_t ulHour )
+{
+    uint32_t ulPoint;
+
+    configASSERT( ( ulCapacity > 0UL ) && ( ulInitial <= ulCapacity ) );
+    configASSERT( pxParams->usFadeCycles > 0U );
+
+    pxModel->xLedger.ulCapacity = ulCapacity;
+    pxModel->xLedger.ulLevel = ulInitial;
+    pxModel->xParams = *pxParams;
+    pxModel->ulNominalCapacity = ulCapacity;
+    pxModel->ulCharged = 0;
+    pxModel->ulDischarged = 0;
+
+    /* Divides, done once here rather than on every operation. */
+    for( ulPoint = 0; ulPoint < modelEFFICIENCY_POINTS; ulPoint++ )
+    {
+        configASSERT( pxParams->usDischargeEfficiency[ ulPoint ] > 0U );
+        pxModel->ulDischargeInverse[ ulPoint ] = ( modelONE * modelONE ) / pxParams->usDischargeEfficiency[ ulPoint ];
+    }
+
+    vBatteryModelSetPeriod( pxModel, ulPeriod, ulHour );
+    pxModel->ulSelfDischargeCarry = 0;
+    pxModel->ulChargeCarry = 0;
+    pxModel->ulDischargeCarry = 0;
+
+    pxModel->ulThroughput = 0;
+    pxModel->ulMilliCyclesPerWh = ( uint32_t ) ( ( 1000ULL << 16 ) / ulCapacity );
+    pxModel->ulFadedCycles = 0;
+
+    pxModel->xStats.ulChargeLoss = 0;
+    pxModel->xStats.ulDischargeLoss = 0;
+    pxModel->xStats.ulSelfDischarge = 0;
+    pxModel->xStats.ulMilliCycles = 0;
+    pxModel->xStats.ulCapacity = ulCapacity;
+
+    prvFade( pxModel, 0 );
+}
+/*-----------------------------------------------------------*/
+
+void vBatteryModelSetPeriod( BatteryModel_t * pxModel,
+                             uint32_t ulPeriod,
+                             uint32_t ulHour )
+{
+    const BatteryModelParams_t * pxParams = &( pxModel->xParams );
+
+    uint32_t ulMaxCharge, ulMaxDischarge;
+
+    configASSERT( ( ulPeriod > 0UL ) && ( ulHour > 0UL ) );
+
+    ulMaxCharge = prvMaxEnergy( pxModel->ulNominalCapacity, pxParams->usMaxChargeRate, ulPeriod, ulHour );
+    ulMaxDischarge = prvMaxEnergy( pxModel->ulNominalCapacity, pxParams->usMaxDischargeRate, ulPeriod, ulHour );
+
+    __atomic_store_n( &( pxModel->ulMaxCharge ), ulMaxCharge, __ATOMIC_RELAXED );
+    __atomic_store_n( &( pxModel->ulMaxDischarge ), ulMaxDischarge, __ATOMIC_RELAXED );
+    __atomic_store_n( &( pxModel->ulChargeScale ), prvScale( ulMaxCharge ), __ATOMIC_RELAXED );
+    __atomic_store_n( &( pxModel->ulDischargeScale ), prvScale( ulMaxDischarge ), __ATOMIC_RELAXED );
+
+    /* Only used by vBatteryModelUpdate(), in the same task. */
+    pxModel->ulSelfDischargeFactor = ( uint32_t ) ( ( ( ( uint64_t ) pxParams->ulSelfDischarge << 32 ) * ulPeriod ) /
+                                                    ( 1000000ULL * 24ULL * ulHour ) );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulBatteryModelCharge( BatteryModel_t * pxModel,
+                               uint32_t ulEnergy,
+                               uint32_t * pulOverflow )
+{
+    uint32_t ulAccepted, ulStored, ulFull, ulUsed, ulLevel, ulEfficiency, ulPosition;
+    uint64_t ullStored;
+
+    /* What this period's limit lets in. */
+    ulAccepted = prvClaim( &( pxModel->ulCharged ), __atomic_load_n( &( pxModel->ulMaxCharge ), __ATOMIC_RELAXED ), ulEnergy, &ulUsed );
+
+    ulPosition = prvPosition( ulUsed, __atomic_load_n( &( pxModel->ulChargeScale ), __ATOMIC_RELAXED ) );
+    ulEfficiency = prvLookup16( pxModel->xParams.usChargeEfficiency, ulPosition );
+    ullStored = ( ( uint64_t ) ulAccepted * ulEfficiency ) + __atomic_exchange_n( &( pxModel->ulChargeCarry ), 0UL, __ATOMIC_RELAXED );
+    ulStored = ( uint32_t ) ( ullStored >> 15 );
+
+    ulLevel = ulBatteryLedgerCharge( &( pxModel->xLedger ), ulStored, &ulFull );
+
+    if( ulFull > 0UL )
+    {
+        /* The battery filled up, so only let in what filled it and give the
+         * rest of the claim back.  The fraction carried is lost with it. */
+        ulStored -= ulFull;
+        ulFull = ( ulEfficiency == modelONE ) ? ulStored :
+                 ( uint32_t ) ( ( ( ( uint64_t ) ulStored * modelONE ) + ulEfficiency - 1U ) / ulEfficiency );
+        ulFull = ( ulFull < ulAccepted ) ? ulFull : ulAccepted;
+        prvUnclaim( &( pxModel->ulCharged ), ulAccepted - ulFull );
+        ulAccepted = ulFull;
+    }
+    else
+    {
+        ( void ) __atomic_add_fetch( &( pxModel->ulChargeCarry ), ( uint32_t ) ( ullStored & modelFRACTION_MASK ), __ATOMIC_RELAXED );
+    }
+
+    if( ulAccepted > ulStored )
+    {
+        ( void ) __atomic_add_fetch( &( pxModel->xStats.ulChargeLoss ), ulAccepted - ulStored, __ATOMIC_RELAXED );
+    }
+
+    if( pulOverflow != NULL )
+    {
+        *pulOverflow = ulEnergy - ulAccepted;
+    }
+
+    return ulLevel;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulBatteryModelDischarge( BatteryModel_t * pxModel,
+                                  uint32_t ulEnergy,
+                                  uint32_t * pulShortfall )
+{
+    uint32_t ulDelivered, ulNeeded, ulEmpty, ulUsed, ulLevel, ulPosition;
+    uint64_t ullNeeded;
+
+    /* What this period's limit lets out. */
+    ulDelivered = prvClaim( &( pxModel->ulDischarged ), __atomic_load_n( &( pxModel->ulMaxDischarge ), __ATOMIC_RELAXED ), ulEnergy, &ulUsed );
+
+    ulPosition = prvPosition( ulUsed, __atomic_load_n( &( pxModel->ulDischargeScale ), __ATOMIC_RELAXED ) );
+    ullNeeded = ( ( uint64_t ) ulDelivered * prvLookup32( pxModel->ulDischargeInverse, ulPosition ) ) +
+                __atomic_exchange_n( &( pxModel->ulDischargeCarry ), 0UL, __ATOMIC_RELAXED );
+    ulNeeded = ( uint32_t ) ( ullNeeded >> 15 );
+
+    ulLevel = ulBatteryLedgerDischarge( &( pxModel->xLedger ), ulNeeded, &ulEmpty );
+
+    if( ulEmpty > 0UL )
+    {
+        /* The battery ran out, so deliver what there was and give the rest
+         * of the claim back.  The fraction carried is lost with it. */
+        ulNeeded -= ulEmpty;
+        ulEmpty = ( uint32_t ) ( ( ( uint64_t ) ulNeeded * prvLookup16( pxModel->xParams.usDischargeEfficiency, ulPosition ) ) >> 15 );
+        ulEmpty = ( ulEmpty < ulDelivered ) ? ulEmpty : ulDelivered;
+        prvUnclaim( &( pxModel->ulDischarged ), ulDelivered - ulEmpty );
+        ulDelivered = ulEmpty;
+    }
+    else
+    {
+        ( void ) __atomic_add_fetch( &( pxModel->ulDischargeCarry ), ( uint32_t ) ( ullNeeded & modelFRACTION_MASK ), __ATOMIC_RELAXED );
+    }
+
+    ( void ) __atomic_add_fetch( &( pxModel->ulThroughput ), ulNeeded, __ATOMIC_RELAXED );
+
+    if( ulNeeded > ulDelivered )
+    {
+        ( void ) __atomic_add_fetch( &( pxModel->xStats.ulDischargeLoss ), ulNeeded - ulDelivered, __ATOMIC_RELAXED );
+    }
+
+    if( pulShortfall != NULL )
+    {
+        *pulShortfall = ulEnergy - ulDelivered;
+    }
+
+    return ulLevel;
+}
+/*-----------------------------------------------------------*/
+
+void vBatteryModelUpdate( BatteryModel_t * pxModel )
+{
+    uint32_t ulLost, ulMissing, ulMilliCycles;
+    uint64_t ullLost;
+
+    /* The self-discharge carry and the cycles last faded for are only used
+     * here. */
+    ullLost = ( ( uint64_t ) ulBatteryLedgerGetLevel( &( pxModel->xLedger ) ) * pxModel->ulSelfDischargeFactor ) +
+              pxModel->ulSelfDischargeCarry;
+    ulLost = ( uint32_t ) ( ullLost >> 32 );
+    pxModel->ulSelfDischargeCarry = ( uint32_t ) ullLost;
+
+    if( ulLost > 0UL )
+    {
+        ( void ) ulBatteryLedgerDischarge( &( pxModel->xLedger ), ulLost, &ulMissing );
+        ( void ) __atomic_add_fetch( &( pxModel->xStats.ulSelfDischarge ), ulLost - ulMissing, __ATOMIC_RELAXED );
+    }
+
+    ulMilliCycles = ( uint32_t ) ( ( ( uint64_t ) __atomic_load_n( &( pxModel->ulThroughput ), __ATOMIC_RELAXED ) *
+                                     pxModel->ulMilliCyclesPerWh ) >> 16 );
+    __atomic_store_n( &( pxModel->xStats.ulMilliCycles ), ulMilliCycles, __ATOMIC_RELAXED );
+
+    if( ( ulMilliCycles / 1000UL ) != pxModel->ulFadedCycles )
+    {
+        prvFade( pxModel, ulMilliCycles / 1000UL );
+    }
+
+    __atomic_store_n( &( pxModel->ulCharged ), 0UL, __ATOMIC_RELAXED );
+    __atomic_store_n( &( pxModel->ulDischarged ), 0UL, __ATOMIC_RELAXED );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulBatteryModelGetLevel( const BatteryModel_t * pxModel )
+{
+    return ulBatteryLedgerGetLevel( &( pxModel->xLedger ) );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulBatteryModelGetCapacity( const BatteryModel_t * pxModel )
+{
+    return pxModel->xLedger.ulCapacity;
+}
+/*-----------------------------------------------------------*/
+
+void vBatteryModelGetStats( const BatteryModel_t * pxModel,
+                            BatteryModelStats_t * pxStats )
+{
+    pxStats->ulChargeLoss = __atomic_load_n( &( pxModel->xStats.ulChargeLoss ), __ATOMIC_RELAXED );
+    pxStats->ulDischargeLoss = __atomic_load_n( &( pxModel->xStats.ulDischargeLoss ), __ATOMIC_RELAXED );
+    pxStats->ulSelfDischarge = __atomic_load_n( &( pxModel->xStats.ulSelfDischarge ), __ATOMIC_RELAXED );
+    pxStats->ulMilliCycles = __atomic_load_n( &( pxModel->xStats.ulMilliCycles ), __ATOMIC_RELAXED );
+    pxStats->ulCapacity = __atomic_load_n( &( pxModel->xStats.ulCapacity ), __ATOMIC_RELAXED );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvLookup16( const uint16_t * pusTable,
+                             uint32_t ulPosition )
+{
+    uint32_t ulPoint = ulPosition >> modelPOSITION_SHIFT;
+    int32_t lStep;
+    uint32_t ulValue;
+
+    if( ulPoint >= ( modelEFFICIENCY_POINTS - 1U ) )
+    {
+        ulValue = pusTable[ modelEFFICIENCY_POINTS - 1U ];
+    }
+    else
+    {
+        lStep = ( int32_t ) pusTable[ ulPoint + 1U ] - ( int32_t ) pusTable[ ulPoint ];
+        ulValue = ( uint32_t ) ( ( int32_t ) pusTable[ ulPoint ] +
+                                 ( ( lStep * ( int32_t ) ( ulPosition & modelPOSITION_MASK ) ) / ( int32_t ) ( modelPOSITION_MASK + 1UL ) ) );
+    }
+
+    return ulValue;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvLookup32( const uint32_t * pulTable,
+                             uint32_t ulPosition )
+{
+    uint32_t ulPoint = ulPosition >> modelPOSITION_SHIFT;
+    int32_t lStep;
+    uint32_t ulValue;
+
+    if( ulPoint >= ( modelEFFICIENCY_POINTS - 1U ) )
+    {
+        ulValue = pulTable[ modelEFFICIENCY_POINTS - 1U ];
+    }
+    else
+    {
+        lStep = ( int32_t ) pulTable[ ulPoint + 1U ] - ( int32_t ) pulTable[ ulPoint ];
+        ulValue = ( uint32_t ) ( ( int32_t ) pulTable[ ulPoint ] +
+                                 ( ( lStep * ( int32_t ) ( ulPosition & modelPOSITION_MASK ) ) / ( int32_t ) ( modelPOSITION_MASK + 1UL ) ) );
+    }
+
+    return ulValue;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvPosition( uint32_t ulEnergy,
+                             uint32_t ulScale )
+{
+    uint32_t ulPosition = ( uint32_t ) ( ( ( uint64_t ) ulEnergy * ulScale ) >> 16 );
+
+    return ( ulPosition > modelPOSITION_MAX ) ? modelPOSITION_MAX : ulPosition;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvMaxEnergy( uint32_t ulCapacity,
+                              uint16_t usRate,
+                              uint32_t ulPeriod,
+                              uint32_t ulHour )
+{
+    uint32_t ulMax = UINT32_MAX;
+
+    if( usRate > 0U )
+    {
+        ulMax = ( uint32_t ) ( ( ( uint64_t ) ulCapacity * usRate * ulPeriod ) / ( 100ULL * ulHour ) );
+        ulMax = ( ulMax == 0UL ) ? 1UL : ulMax;
+    }
+
+    return ulMax;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvScale( uint32_t ulMaxEnergy )
+{
+    /* Without a limit every operation is at the first point. */
+    return ( ulMaxEnergy == UINT32_MAX ) ? 0UL : ( uint32_t ) ( ( modelPOSITION_MAX << 16 ) / ulMaxEnergy );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvClaim( uint32_t * pulUsed,
+                          uint32_t ulLimit,
+                          uint32_t ulWanted,
+                          uint32_t * pulNowUsed )
+{
+    uint32_t ulUsed = __atomic_load_n( pulUsed, __ATOMIC_RELAXED );
+    uint32_t ulClaim;
+
+    do
+    {
+        ulClaim = ( ulUsed < ulLimit ) ? ( ulLimit - ulUsed ) : 0UL;
+        ulClaim = ( ulWanted < ulClaim ) ? ulWanted : ulClaim;
+    } while( !__atomic_compare_exchange_n( pulUsed, &ulUsed, ulUsed + ulClaim, pdFALSE, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) );
+
+    *pulNowUsed = ulUsed + ulClaim;
+
+    return ulClaim;
+}
+/*-----------------------------------------------------------*/
+
+static void prvUnclaim( uint32_t * pulUsed,
+                        uint32_t ulAmount )
+{
+    uint32_t ulUsed = __atomic_load_n( pulUsed, __ATOMIC_RELAXED );
+
+    while( ( ulAmount > 0UL ) &&
+           !__atomic_compare_exchange_n( pulUsed, &ulUsed, ( ulUsed > ulAmount ) ? ( ulUsed - ulAmount ) : 0UL,
+                                         pdFALSE, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+    {
+        /* ulUsed was reloaded by the failed compare and swap. */
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvFade( BatteryModel_t * pxModel,
+                     uint32_t ulCycles )
+{
+    const uint16_t * pusFade = pxModel->xParams.usCapacityFade;
+    uint32_t ulStep = pxModel->xParams.usFadeCycles;
+    uint32_t ulPoint = ulCycles / ulStep;
+    uint32_t ulShare, ulCapacity, ulExcess;
+    int32_t lStep;
+
+    if( ulPoint >= ( modelFADE_POINTS - 1U ) )
+    {
+        ulShare = pusFade[ modelFADE_POINTS - 1U ];
+    }
+    else
+    {
+        lStep = ( int32_t ) pusFade[ ulPoint + 1U ] - ( int32_t ) pusFade[ ulPoint ];
+        ulShare = ( uint32_t ) ( ( int32_t ) pusFade[ ulPoint ] +
+                                 ( ( lStep * ( int32_t ) ( ulCycles - ( ulPoint * ulStep ) ) ) / ( int32_t ) ulStep ) );
+    }
+
+    ulCapacity = ( uint32_t ) ( ( ( uint64_t ) pxModel->ulNominalCapacity * ulShare ) >> 15 );
+
+    /* Energy that no longer fits is lost. */
+    ( void ) ulBatteryLedgerSetCapacity( &( pxModel->xLedger ), ulCapacity, &ulExcess );
+    ( void ) __atomic_add_fetch( &( pxModel->xStats.ulSelfDischarge ), ulExcess, __ATOMIC_RELAXED );
+
+    __atomic_store_n( &( pxModel->xStats.ulCapacity ), ulCapacity, __ATOMIC_RELAXED );
+    pxModel->ulFadedCycles = ulCycles;
+}
+/*-----------------------------------------------------------*/
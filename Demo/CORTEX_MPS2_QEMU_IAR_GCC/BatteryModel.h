@@ -0,0 +1,219 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef BATTERY_MODEL_H
+#define BATTERY_MODEL_H
+
+/*
+ * Physical model of a battery, in front of the BatteryLedger_t that holds the
+ * energy stored.  Energies given to and returned by the model are at the
+ * battery's terminals; the ledger holds what is inside.  The model adds:
+ *
+ *   efficiency       a share of the energy is lost going in and coming out,
+ *                    looked up by the power of the period as a share of the
+ *                    most allowed, between points of a table
+ *   C-rate           the energy that can go in or come out each period is
+ *                    limited to a multiple of the capacity per hour
+ *   self-discharge   a share of the stored energy is lost each period
+ *   degradation      the capacity fades with the equivalent full cycles the
+ *                    battery has been through, between points of a table
+ *
+ * Everything is integer: efficiencies are Q15, their reciprocals are computed
+ * once, and fractions of a W.h are carried to the next operation rather than
+ * lost, so an ideal model behaves exactly like the ledger on its own.  An
+ * operation is a few multiplies and shifts and no divides.
+ *
+ * Like the ledger, the model takes no lock.  The load, battery and grid tasks
+ * charge and discharge it at the same time, so each counter they share is a
+ * word updated atomically: the energy let in or out this period is claimed
+ * against the limit with a compare and swap, and given back if the ledger
+ * could not take it, and the fractions carried between operations are taken
+ * and added back whole.  A snapshot of the stats is of each field on its own.
+ *
+ * The parameters are a BatteryModelParams_t, so other chemistries are a new
+ * set of tables; modelIDEAL and modelLITHIUM_ION are provided.
+ */
+
+#include "BatteryLedger.h"
+
+/* Points of the efficiency tables, at 0, 1/8 ... 8/8 of the most power. */
+#define modelEFFICIENCY_POINTS    ( 9U )
+
+/* Points of the capacity fade table. */
+#define modelFADE_POINTS          ( 9U )
+
+/* A share between 0 and 1 in Q15.  Only for constants, so no floating point
+ * code is generated. */
+#define modelQ15( x )             ( ( uint16_t ) ( ( ( x ) * 32768.0 ) + 0.5 ) )
+
+typedef struct BatteryModelParams
+{
+    uint16_t usChargeEfficiency[ modelEFFICIENCY_POINTS ];    /* Q15 share of the energy put in that is stored. */
+    uint16_t usDischargeEfficiency[ modelEFFICIENCY_POINTS ]; /* Q15 share of the energy taken out of store that is delivered. */
+    uint16_t usMaxChargeRate;                                 /* Most charging power in 1/100 C, 0 for no limit.  With no limit
+                                                               * the first point of the efficiency table is used. */
+    uint16_t usMaxDischargeRate;                              /* Most discharging power in 1/100 C, 0 for no limit. */
+    uint32_t ulSelfDischarge;                                 /* Share of the stored energy lost each day, in parts per million. */
+    uint16_t usFadeCycles;                                    /* Equivalent full cycles between points of usCapacityFade. */
+    uint16_t usCapacityFade[ modelFADE_POINTS ];              /* Q15 share of the capacity left after 0, 1 ... 8 times
+                                                               * usFadeCycles cycles, and after that the last. */
+} BatteryModelParams_t;
+
+/* A perfect battery, the same as the ledger on its own. */
+#define modelIDEAL                                                                              \
+    {                                                                                           \
+        { 32768U, 32768U, 32768U, 32768U, 32768U, 32768U, 32768U, 32768U, 32768U },             \
+        { 32768U, 32768U, 32768U, 32768U, 32768U, 32768U, 32768U, 32768U, 32768U },             \
+        0U, 0U, 0UL, 1U,                                                                        \
+        { 32768U, 32768U, 32768U, 32768U, 32768U, 32768U, 32768U, 32768U, 32768U }              \
+    }
+
+/* A typical home lithium-ion battery: about 94% round trip at low power and
+ * 88% at its 0.5 C limit, 2% self-discharge a month, and 80% of its capacity
+ * left after 4000 cycles. */
+#define modelLITHIUM_ION                                                                        \
+    {                                                                                           \
+        { modelQ15( 0.970 ), modelQ15( 0.970 ), modelQ15( 0.965 ), modelQ15( 0.960 ),           \
+          modelQ15( 0.955 ), modelQ15( 0.950 ), modelQ15( 0.945 ), modelQ15( 0.940 ),           \
+          modelQ15( 0.935 ) },                                                                  \
+        { modelQ15( 0.970 ), modelQ15( 0.970 ), modelQ15( 0.965 ), modelQ15( 0.960 ),           \
+          modelQ15( 0.955 ), modelQ15( 0.950 ), modelQ15( 0.945 ), modelQ15( 0.940 ),           \
+          modelQ15( 0.935 ) },                                                                  \
+        50U, 50U, 667UL, 500U,                                                                  \
+        { modelQ15( 1.000 ), modelQ15( 0.975 ), modelQ15( 0.955 ), modelQ15( 0.935 ),           \
+          modelQ15( 0.915 ), modelQ15( 0.895 ), modelQ15( 0.875 ), modelQ15( 0.850 ),           \
+          modelQ15( 0.800 ) }                                                                   \
+    }
+
+/* What the model has lost, and how worn the battery is. */
+typedef struct BatteryModelStats
+{
+    uint32_t ulChargeLoss;     /* W.h lost going in. */
+    uint32_t ulDischargeLoss;  /* W.h lost coming out. */
+    uint32_t ulSelfDischarge;  /* W.h lost while stored. */
+    uint32_t ulMilliCycles;    /* Equivalent full cycles, in thousandths. */
+    uint32_t ulCapacity;       /* W.h the battery holds now. */
+} BatteryModelStats_t;
+
+typedef struct BatteryModel
+{
+    BatteryLedger_t xLedger;        /* The energy stored.  Its capacity fades. */
+    BatteryModelParams_t xParams;
+    uint32_t ulNominalCapacity;     /* W.h when new. */
+
+    /* Most energy in or out each period, in W.h, UINT32_MAX for no limit,
+     * what has gone in and out this period, and the Q16 scale from energy
+     * in a period to a position in the efficiency tables in 1/256ths. */
+    uint32_t ulMaxCharge;
+    uint32_t ulMaxDischarge;
+    uint32_t ulCharged;
+    uint32_t ulDischarged;
+    uint32_t ulChargeScale;
+    uint32_t ulDischargeScale;
+
+    /* Q15 reciprocals of the discharge efficiencies, energy to take out of
+     * store for each W.h delivered. */
+    uint32_t ulDischargeInverse[ modelEFFICIENCY_POINTS ];
+
+    /* Q32 share of the stored energy lost each period, and the fractions of a
+     * W.h carried to the next operation: Q15 for charge and discharge and Q32
+     * for self-discharge. */
+    uint32_t ulSelfDischargeFactor;
+    uint32_t ulSelfDischargeCarry;
+    uint32_t ulChargeCarry;
+    uint32_t ulDischargeCarry;
+
+    /* W.h taken out of store over the battery's life, Q16 thousandths of a
+     * cycle per W.h of it, and the whole cycles the capacity was last faded
+     * for. */
+    uint32_t ulThroughput;
+    uint32_t ulMilliCyclesPerWh;
+    uint32_t ulFadedCycles;
+
+    BatteryModelStats_t xStats;
+} BatteryModel_t;
+
+/*
+ * Set up pxModel with the parameters in pxParams, which are copied, a new
+ * battery of ulCapacity W.h holding ulInitial W.h, and periods of ulPeriod
+ * ticks in an hour of ulHour ticks.
+ */
+void vBatteryModelInit( BatteryModel_t * pxModel,
+                        const BatteryModelParams_t * pxParams,
+                        uint32_t ulCapacity,
+                        uint32_t ulInitial,
+                        uint32_t ulPeriod,
+                        uint32_t ulHour );
+
+/*
+ * Change the length of the periods to ulPeriod ticks of an hour of ulHour
+ * ticks, from the next vBatteryModelUpdate() on.  This divides, so is only
+ * for when the period changes.  Call from the task that calls
+ * vBatteryModelUpdate().  An operation in another task at the same moment may
+ * use the old limit with the new position in the efficiency tables.
+ */
+void vBatteryModelSetPeriod( BatteryModel_t * pxModel,
+                             uint32_t ulPeriod,
+                             uint32_t ulHour );
+
+/*
+ * Put ulEnergy W.h in.  Whatever is over this period's charging limit or does
+ * not fit is written to *pulOverflow if pulOverflow is not NULL.  Returns the
+ * new level.
+ */
+uint32_t ulBatteryModelCharge( BatteryModel_t * pxModel,
+                               uint32_t ulEnergy,
+                               uint32_t * pulOverflow );
+
+/*
+ * Take ulEnergy W.h out.  Whatever is over this period's discharging limit or
+ * the battery cannot supply is written to *pulShortfall if pulShortfall is
+ * not NULL.  Returns the new level.
+ */
+uint32_t ulBatteryModelDischarge( BatteryModel_t * pxModel,
+                                  uint32_t ulEnergy,
+                                  uint32_t * pulShortfall );
+
+/*
+ * End the period: lose the period's self-discharge, fade the capacity with
+ * the cycles so far and start the next period's charging and discharging
+ * limits.  Call once each period, from one task.
+ */
+void vBatteryModelUpdate( BatteryModel_t * pxModel );
+
+/*
+ * Returns the energy stored, in W.h, and the capacity, which fades with use.
+ */
+uint32_t ulBatteryModelGetLevel( const BatteryModel_t * pxModel );
+uint32_t ulBatteryModelGetCapacity( const BatteryModel_t * pxModel );
+
+/*
+ * Take a snapshot of the losses and wear of the battery.
+ */
+void vBatteryModelGetStats( const BatteryModel_t * pxModel,
+                            BatteryModelStats_t * pxStats );
+
+#endif /* BATTERY_MODEL_H */
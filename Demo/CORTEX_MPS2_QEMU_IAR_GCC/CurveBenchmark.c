@@ -0,0 +1,206 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Compares the cost and accuracy of the fixed-point curves in EnergyCurve.c
+ * with the double precision sin() macros they replaced.  Each evaluation is
+ * timed individually with the SysTick down counter clocked from the core, so
+ * the figures are in CPU cycles.  When running in QEMU add "-icount shift=0"
+ * to the command line to make the figures repeatable.
+ *
+ * Set RUN_CURVE_BENCHMARK to 1 in main.c to run it at start up.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+
+/* Demo includes. */
+#include "EnergyConfig.h"
+#include "CurveBenchmark.h"
+
+/* SysTick registers.  The benchmark runs before the scheduler so it can use
+ * the timer freely - the port reconfigures it when the scheduler starts. */
+#define benchSYSTICK_CTRL        ( *( ( volatile uint32_t * ) 0xe000e010UL ) )
+#define benchSYSTICK_LOAD        ( *( ( volatile uint32_t * ) 0xe000e014UL ) )
+#define benchSYSTICK_VAL         ( *( ( volatile uint32_t * ) 0xe000e018UL ) )
+#define benchSYSTICK_ENABLE      ( ( 1UL << 2UL ) | ( 1UL << 0UL ) ) /* Core clock, no interrupt. */
+#define benchSYSTICK_MAX         ( 0x00ffffffUL )
+
+/* Number of evenly spaced samples taken over one period of each curve. */
+#define benchSAMPLES             ( 240UL )
+
+/* The original floating point definition of ENERGY_PRICE, kept only for
+ * comparison. */
+#define benchFLOAT_ENERGY_PRICE( tick )    ( ( TickType_t ) ( ( 0.22 + 0.07 * sin( 2 * M_PI / PRICE_PERIOD * ( tick ) / configTICK_RATE_HZ - M_PI / 2 ) ) * 100 ) )
+
+typedef struct BenchResult
+{
+    uint32_t ulMin;
+    uint32_t ulMax;
+    uint32_t ulTotal;
+} BenchResult_t;
+
+static TickType_t prvFloatSolarPower( TickType_t xTick );
+static void prvRecord( BenchResult_t * pxResult,
+                       uint32_t ulStart,
+                       uint32_t ulEnd );
+static void prvPrint( const char * pcName,
+                      const BenchResult_t * pxFloat,
+                      const BenchResult_t * pxFixed,
+                      uint32_t ulMaxError );
+
+/* Results are written here so the compiler cannot discard the evaluations. */
+static volatile int32_t lSink;
+
+/* Cycles taken by back to back reads of the counter, removed from every
+ * measurement. */
+static uint32_t ulOverhead;
+
+/*-----------------------------------------------------------*/
+
+void vCurveBenchmarkRun( void )
+{
+    static const EnergyCurve_t xSolarCurve = SOLAR_POWER_CURVE;
+    static const EnergyCurve_t xPriceCurve = ENERGY_PRICE_CURVE;
+    BenchResult_t xSolarFloat = { UINT32_MAX, 0, 0 }, xSolarFixed = { UINT32_MAX, 0, 0 };
+    BenchResult_t xPriceFloat = { UINT32_MAX, 0, 0 }, xPriceFixed = { UINT32_MAX, 0, 0 };
+    uint32_t ulSolarError = 0, ulPriceError = 0, ulStart, ulEnd, ulSample;
+    int32_t lFloat, lFixed;
+    volatile TickType_t xTick;
+
+    benchSYSTICK_CTRL = 0UL;
+    benchSYSTICK_LOAD = benchSYSTICK_MAX;
+    benchSYSTICK_VAL = 0UL;
+    benchSYSTICK_CTRL = benchSYSTICK_ENABLE;
+
+    ulStart = benchSYSTICK_VAL;
+    ulEnd = benchSYSTICK_VAL;
+    ulOverhead = ( ulStart - ulEnd ) & benchSYSTICK_MAX;
+
+    for( ulSample = 0; ulSample < benchSAMPLES; ulSample++ )
+    {
+        xTick = ( TickType_t ) ( ( ulSample * PERIOD * configTICK_RATE_HZ ) / benchSAMPLES );
+
+        ulStart = benchSYSTICK_VAL;
+        lSink = ( int32_t ) prvFloatSolarPower( xTick );
+        ulEnd = benchSYSTICK_VAL;
+        prvRecord( &xSolarFloat, ulStart, ulEnd );
+        lFloat = lSink;
+
+        ulStart = benchSYSTICK_VAL;
+        lSink = lEnergyCurveEvaluate( &xSolarCurve, xTick );
+        ulEnd = benchSYSTICK_VAL;
+        prvRecord( &xSolarFixed, ulStart, ulEnd );
+        lFixed = lSink;
+
+        if( ( uint32_t ) labs( lFloat - lFixed ) > ulSolarError )
+        {
+            ulSolarError = ( uint32_t ) labs( lFloat - lFixed );
+        }
+
+        xTick = ( TickType_t ) ( ( ulSample * PRICE_PERIOD * configTICK_RATE_HZ ) / benchSAMPLES );
+
+        ulStart = benchSYSTICK_VAL;
+        lSink = ( int32_t ) benchFLOAT_ENERGY_PRICE( xTick );
+        ulEnd = benchSYSTICK_VAL;
+        prvRecord( &xPriceFloat, ulStart, ulEnd );
+        lFloat = lSink;
+
+        ulStart = benchSYSTICK_VAL;
+        lSink = lEnergyCurveEvaluate( &xPriceCurve, xTick );
+        ulEnd = benchSYSTICK_VAL;
+        prvRecord( &xPriceFixed, ulStart, ulEnd );
+        lFixed = lSink;
+
+        if( ( uint32_t ) labs( lFloat - lFixed ) > ulPriceError )
+        {
+            ulPriceError = ( uint32_t ) labs( lFloat - lFixed );
+        }
+    }
+
+    /* Leave the timer as the port expects to find it. */
+    benchSYSTICK_CTRL = 0UL;
+    benchSYSTICK_VAL = 0UL;
+
+    printf( "Curve benchmark, cycles per sample over %u samples\r\n", ( unsigned ) benchSAMPLES );
+    prvPrint( "SOLAR_POWER", &xSolarFloat, &xSolarFixed, ulSolarError );
+    prvPrint( "ENERGY_PRICE", &xPriceFloat, &xPriceFixed, ulPriceError );
+}
+/*-----------------------------------------------------------*/
+
+static TickType_t prvFloatSolarPower( TickType_t xTick )
+{
+    double dPower;
+
+    /* The original floating point definition of SOLAR_POWER.  The value is
+     * clamped at zero before the cast, which is what the soft-float conversion
+     * to an unsigned type did with the negative half of the wave. */
+    dPower = AMPLITUDE * sin( 2 * M_PI / PERIOD * xTick / configTICK_RATE_HZ - M_PI / 2 );
+
+    return ( TickType_t ) ( ( dPower < 0.0 ) ? 0.0 : dPower );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRecord( BenchResult_t * pxResult,
+                       uint32_t ulStart,
+                       uint32_t ulEnd )
+{
+    uint32_t ulCycles;
+
+    /* The counter counts down, and the mask handles a reload in between. */
+    ulCycles = ( ( ulStart - ulEnd ) & benchSYSTICK_MAX ) - ulOverhead;
+
+    if( ulCycles < pxResult->ulMin )
+    {
+        pxResult->ulMin = ulCycles;
+    }
+
+    if( ulCycles > pxResult->ulMax )
+    {
+        pxResult->ulMax = ulCycles;
+    }
+
+    pxResult->ulTotal += ulCycles;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPrint( const char * pcName,
+                      const BenchResult_t * pxFloat,
+                      const BenchResult_t * pxFixed,
+                      uint32_t ulMaxError )
+{
+    printf( "%s float min %u avg %u max %u, fixed min %u avg %u max %u, max error %u\r\n",
+            pcName,
+            ( unsigned ) pxFloat->ulMin, ( unsigned ) ( pxFloat->ulTotal / benchSAMPLES ), ( unsigned ) pxFloat->ulMax,
+            ( unsigned ) pxFixed->ulMin, ( unsigned ) ( pxFixed->ulTotal / benchSAMPLES ), ( unsigned ) pxFixed->ulMax,
+            ( unsigned ) ulMaxError );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,210 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Exact energy accounting, see EnergyAccount.h.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "EnergyAccount.h"
+
+/* pxResult = pxEnd - pxStart, flow by flow. */
+static void prvDifference( EnergyAccountTotals_t * pxResult,
+                           const EnergyAccountTotals_t * pxEnd,
+                           const EnergyAccountTotals_t * pxStart );
+
+/*-----------------------------------------------------------*/
+
+void vEnergyAccountInit( EnergyAccount_t * pxAccount,
+                         TickType_t xDayTicks )
+{
+    configASSERT( xDayTicks > 0 );
+
+    memset( pxAccount, 0x00, sizeof( *pxAccount ) );
+    pxAccount->xDayTicks = xDayTicks;
+    pxAccount->xHaveDay = pdFALSE;
+    pxAccount->xHaveMonth = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vEnergyAccountAddEnergy( EnergyAccount_t * pxAccount,
+                              eEnergyFlow eFlow,
+                              uint64_t ullMicroWh )
+{
+    configASSERT( ( uint32_t ) eFlow < accountNUM_FLOWS );
+
+    taskENTER_CRITICAL();
+    {
+        pxAccount->xTotals.ullEnergy[ eFlow ] += ullMicroWh;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vEnergyAccountAddBill( EnergyAccount_t * pxAccount,
+                            int64_t llMicroCents )
+{
+    taskENTER_CRITICAL();
+    {
+        pxAccount->xTotals.llBill += llMicroCents;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vEnergyAccountUpdate( EnergyAccount_t * pxAccount,
+                           TickType_t xNow )
+{
+    uint32_t ulDay = ( uint32_t ) ( xNow / pxAccount->xDayTicks );
+    EnergyAccountTotals_t xNowTotals;
+    EnergyAccountSettlement_t xDay, xMonth;
+    BaseType_t xNewMonth;
+
+    if( ulDay != pxAccount->ulDay )
+    {
+        vEnergyAccountGetTotals( pxAccount, &xNowTotals );
+
+        /* Everything since the last update is put down to the day that was
+         * being accounted, even if more than one day has passed.  The starts
+         * are only written by this task, so the settlements are worked out
+         * here and only published in the critical section. */
+        xDay.ulPeriod = pxAccount->ulDay;
+        prvDifference( &( xDay.xTotals ), &xNowTotals, &( pxAccount->xDayStart ) );
+
+        xNewMonth = ( ( ulDay / accountDAYS_PER_MONTH ) != ( pxAccount->ulDay / accountDAYS_PER_MONTH ) ) ? pdTRUE : pdFALSE;
+
+        if( xNewMonth != pdFALSE )
+        {
+            xMonth.ulPeriod = pxAccount->ulDay / accountDAYS_PER_MONTH;
+            prvDifference( &( xMonth.xTotals ), &xNowTotals, &( pxAccount->xMonthStart ) );
+        }
+
+        taskENTER_CRITICAL();
+        {
+            pxAccount->xLastDay = xDay;
+            pxAccount->xDayStart = xNowTotals;
+            pxAccount->xHaveDay = pdTRUE;
+
+            if( xNewMonth != pdFALSE )
+            {
+                pxAccount->xLastMonth = xMonth;
+                pxAccount->xMonthStart = xNowTotals;
+                pxAccount->xHaveMonth = pdTRUE;
+            }
+
+            pxAccount->ulDay = ulDay;
+        }
+        taskEXIT_CRITICAL();
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vEnergyAccountGetTotals( const EnergyAccount_t * pxAccount,
+                              EnergyAccountTotals_t * pxTotals )
+{
+    taskENTER_CRITICAL();
+    {
+        *pxTotals = pxAccount->xTotals;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xEnergyAccountGetSettlement( const EnergyAccount_t * pxAccount,
+                                        eAccountPeriod ePeriod,
+                                        EnergyAccountSettlement_t * pxSettlement )
+{
+    BaseType_t xReturn;
+
+    taskENTER_CRITICAL();
+    {
+        if( ePeriod == eAccountDay )
+        {
+            xReturn = pxAccount->xHaveDay;
+            *pxSettlement = pxAccount->xLastDay;
+        }
+        else
+        {
+            xReturn = pxAccount->xHaveMonth;
+            *pxSettlement = pxAccount->xLastMonth;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vEnergyIntegratorInit( EnergyIntegrator_t * pxIntegrator,
+                            TickType_t xTicksPerHour )
+{
+    configASSERT( ( xTicksPerHour > 0 ) && ( ( accountMICRO % ( int64_t ) xTicksPerHour ) == 0 ) );
+
+    pxIntegrator->ullMicroPerTick = ( uint64_t ) accountMICRO / ( uint64_t ) xTicksPerHour;
+    pxIntegrator->ulRemainder = 0;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulEnergyIntegrate( EnergyIntegrator_t * pxIntegrator,
+                            uint32_t ulPower,
+                            TickType_t xTicks,
+                            uint64_t * pullMicroWh )
+{
+    uint64_t ullMicroWh = ( uint64_t ) ulPower * ( uint64_t ) xTicks * pxIntegrator->ullMicroPerTick;
+    uint64_t ullPending = ullMicroWh + pxIntegrator->ulRemainder;
+
+    pxIntegrator->ulRemainder = ( uint32_t ) ( ullPending % ( uint64_t ) accountMICRO );
+
+    if( pullMicroWh != NULL )
+    {
+        *pullMicroWh = ullMicroWh;
+    }
+
+    return ( uint32_t ) ( ullPending / ( uint64_t ) accountMICRO );
+}
+/*-----------------------------------------------------------*/
+
+static void prvDifference( EnergyAccountTotals_t * pxResult,
+                           const EnergyAccountTotals_t * pxEnd,
+                           const EnergyAccountTotals_t * pxStart )
+{
+    uint32_t ulFlow;
+
+    pxResult->llBill = pxEnd->llBill - pxStart->llBill;
+
+    for( ulFlow = 0; ulFlow < accountNUM_FLOWS; ulFlow++ )
+    {
+        pxResult->ullEnergy[ ulFlow ] = pxEnd->ullEnergy[ ulFlow ] - pxStart->ullEnergy[ ulFlow ];
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,165 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef ENERGY_ACCOUNT_H
+#define ENERGY_ACCOUNT_H
+
+/*
+ * Exact accounting of the energy that flows through the household and of the
+ * money it earns or costs.
+ *
+ * Energy is counted in micro W.h and money in micro cents, in 64 bit
+ * accumulators that will not overflow in any simulation that can be run.  A
+ * flow of a few kW adds about 10^9 micro W.h an hour, so 2^63 lasts over a
+ * million years.
+ *
+ * Power samples are turned into energy by an integrator that carries what is
+ * left below a whole W.h from one sample to the next, so the whole W.h the
+ * tasks trade with add up exactly to the energy measured, however the samples
+ * fall.
+ *
+ * At the end of each day, and of each month of accountDAYS_PER_MONTH days,
+ * what the totals moved by in that period is kept as its settlement.
+ *
+ * Each update is a short critical section, so several tasks can add to the
+ * same account and readers always see consistent 64 bit values.
+ */
+
+#ifndef accountDAYS_PER_MONTH
+    #define accountDAYS_PER_MONTH    ( 30U )
+#endif
+
+/* Micro units in a unit. */
+#define accountMICRO                 ( 1000000LL )
+
+/* Micro cents in a miliCent, the unit prices are given in. */
+#define accountMICRO_PER_MILI        ( 1000LL )
+
+typedef enum
+{
+    eEnergyGenerated = 0, /* Produced by the solar panels. */
+    eEnergyConsumed,      /* Used by the household. */
+    eEnergyImported,      /* Bought from the grid. */
+    eEnergyExported,      /* Sold to the grid. */
+    eEnergySolarExported  /* Of the energy sold, solar sold as it was made. */
+} eEnergyFlow;
+
+#define accountNUM_FLOWS             ( 5U )
+
+typedef struct EnergyAccountTotals
+{
+    int64_t llBill;                           /* Micro cents, positive is profit. */
+    uint64_t ullEnergy[ accountNUM_FLOWS ];   /* Micro W.h, indexed by eEnergyFlow. */
+} EnergyAccountTotals_t;
+
+/* What the totals moved by over a day or a month. */
+typedef struct EnergyAccountSettlement
+{
+    uint32_t ulPeriod;           /* Number of the day or month, from 0. */
+    EnergyAccountTotals_t xTotals;
+} EnergyAccountSettlement_t;
+
+typedef enum
+{
+    eAccountDay = 0,
+    eAccountMonth
+} eAccountPeriod;
+
+typedef struct EnergyAccount
+{
+    EnergyAccountTotals_t xTotals;
+    TickType_t xDayTicks;
+    uint32_t ulDay;                           /* The day being accounted. */
+    EnergyAccountTotals_t xDayStart;          /* Totals when it started. */
+    EnergyAccountTotals_t xMonthStart;        /* Totals when the month started. */
+    EnergyAccountSettlement_t xLastDay;
+    EnergyAccountSettlement_t xLastMonth;
+    BaseType_t xHaveDay;
+    BaseType_t xHaveMonth;
+} EnergyAccount_t;
+
+/* Turns power samples into whole W.h, carrying the remainder. */
+typedef struct EnergyIntegrator
+{
+    uint64_t ullMicroPerTick; /* Micro W.h in a W for one tick. */
+    uint32_t ulRemainder;     /* Micro W.h not yet handed out as a whole W.h. */
+} EnergyIntegrator_t;
+
+/*
+ * Start an account with all totals at zero, with days of xDayTicks ticks.
+ */
+void vEnergyAccountInit( EnergyAccount_t * pxAccount,
+                         TickType_t xDayTicks );
+
+/*
+ * Add ullMicroWh micro W.h to a flow, or llMicroCents micro cents to the bill.
+ */
+void vEnergyAccountAddEnergy( EnergyAccount_t * pxAccount,
+                              eEnergyFlow eFlow,
+                              uint64_t ullMicroWh );
+void vEnergyAccountAddBill( EnergyAccount_t * pxAccount,
+                            int64_t llMicroCents );
+
+/*
+ * Settle every day and month that has ended by xNow.  Call from one task,
+ * at least once a day.
+ */
+void vEnergyAccountUpdate( EnergyAccount_t * pxAccount,
+                           TickType_t xNow );
+
+/*
+ * Copy the running totals.
+ */
+void vEnergyAccountGetTotals( const EnergyAccount_t * pxAccount,
+                              EnergyAccountTotals_t * pxTotals );
+
+/*
+ * Copy the settlement of the last day or month to end.  Returns pdFALSE if
+ * none has ended yet.
+ */
+BaseType_t xEnergyAccountGetSettlement( const EnergyAccount_t * pxAccount,
+                                        eAccountPeriod ePeriod,
+                                        EnergyAccountSettlement_t * pxSettlement );
+
+/*
+ * Prepare an integrator for a tick of 1 / xTicksPerHour hours.  xTicksPerHour
+ * must divide a million, so the energy of a sample is a whole number of micro
+ * W.h.
+ */
+void vEnergyIntegratorInit( EnergyIntegrator_t * pxIntegrator,
+                            TickType_t xTicksPerHour );
+
+/*
+ * The energy of ulPower W held for xTicks ticks.  The exact energy in micro
+ * W.h is written to *pullMicroWh if it is not NULL, and the whole W.h it
+ * completes, counting what was left over from earlier samples, are returned.
+ */
+uint32_t ulEnergyIntegrate( EnergyIntegrator_t * pxIntegrator,
+                            uint32_t ulPower,
+                            TickType_t xTicks,
+                            uint64_t * pullMicroWh );
+
+#endif /* ENERGY_ACCOUNT_H */
@@ -0,0 +1,183 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Zero copy energy bus, see EnergyBus.h.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* Demo includes. */
+#include "EnergyBus.h"
+#include "LoopStats.h"
+
+/*-----------------------------------------------------------*/
+
+void vEnergyBusInit( EnergyBus_t * pxBus )
+{
+    memset( pxBus, 0x00, sizeof( EnergyBus_t ) );
+}
+/*-----------------------------------------------------------*/
+
+EnergyBusSubscriber_t xEnergyBusSubscribe( EnergyBus_t * pxBus,
+                                           EnergyTopic_t eTopic,
+                                           UBaseType_t uxDepth )
+{
+    EnergyBusSubscriber_t xSubscriber = NULL;
+
+    configASSERT( eTopic < busNUM_TOPICS );
+
+    if( pxBus->uxSubscriberCount[ eTopic ] < busMAX_SUBSCRIBERS )
+    {
+        xSubscriber = xQueueCreate( uxDepth, sizeof( EnergySample_t * ) );
+
+        if( xSubscriber != NULL )
+        {
+            pxBus->xSubscribers[ eTopic ][ pxBus->uxSubscriberCount[ eTopic ] ] = xSubscriber;
+            pxBus->uxSubscriberCount[ eTopic ]++;
+        }
+    }
+
+    return xSubscriber;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xEnergyBusPublish( EnergyBus_t * pxBus,
+                              EnergyTopic_t eTopic,
+                              EnergySource_t eSource,
+                              TickType_t xTimestamp,
+                              int32_t lValue )
+{
+    EnergySample_t * pxSample = NULL;
+    UBaseType_t uxSlot, uxTried, uxSubscriber, uxCount;
+    BaseType_t xDelivered = pdFAIL;
+
+    configASSERT( eTopic < busNUM_TOPICS );
+
+    uxCount = pxBus->uxSubscriberCount[ eTopic ];
+
+    /* Claim the first free slot at or after uxNextSlot.  The reference count
+     * is set to the number of subscribers before any of them can see the
+     * sample, as a higher priority subscriber may release it before the last
+     * one has been sent it. */
+    if( uxCount > 0 )
+    {
+        taskENTER_CRITICAL();
+        {
+            for( uxTried = 0; uxTried < busRING_LENGTH; uxTried++ )
+            {
+                uxSlot = ( pxBus->uxNextSlot + uxTried ) % busRING_LENGTH;
+
+                if( pxBus->uxReferences[ uxSlot ] == 0 )
+                {
+                    pxBus->uxReferences[ uxSlot ] = uxCount;
+                    pxBus->uxNextSlot = ( uxSlot + 1 ) % busRING_LENGTH;
+                    pxSample = &( pxBus->xRing[ uxSlot ] );
+                    break;
+                }
+            }
+
+            if( pxSample == NULL )
+            {
+                pxBus->ulDropped += ( uint32_t ) uxCount;
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    if( pxSample != NULL )
+    {
+        pxSample->xTimestamp = xTimestamp;
+        pxSample->lValue = lValue;
+        pxSample->ucTopic = ( uint8_t ) eTopic;
+        pxSample->ucSource = ( uint8_t ) eSource;
+        pxSample->ulPublished = ulLoopStatsTimestamp();
+
+        for( uxSubscriber = 0; uxSubscriber < uxCount; uxSubscriber++ )
+        {
+            if( xQueueSend( pxBus->xSubscribers[ eTopic ][ uxSubscriber ], &pxSample, 0 ) == pdPASS )
+            {
+                xDelivered = pdPASS;
+            }
+            else
+            {
+                /* This subscriber will never release the sample. */
+                vEnergyBusRelease( pxBus, pxSample );
+
+                taskENTER_CRITICAL();
+                {
+                    pxBus->ulDropped++;
+                }
+                taskEXIT_CRITICAL();
+            }
+        }
+    }
+
+    return xDelivered;
+}
+/*-----------------------------------------------------------*/
+
+const EnergySample_t * pxEnergyBusReceive( EnergyBusSubscriber_t xSubscriber,
+                                           TickType_t xTicksToWait )
+{
+    EnergySample_t * pxSample = NULL;
+
+    if( xQueueReceive( xSubscriber, &pxSample, xTicksToWait ) != pdPASS )
+    {
+        pxSample = NULL;
+    }
+
+    return pxSample;
+}
+/*-----------------------------------------------------------*/
+
+void vEnergyBusRelease( EnergyBus_t * pxBus,
+                        const EnergySample_t * pxSample )
+{
+    UBaseType_t uxSlot = ( UBaseType_t ) ( pxSample - pxBus->xRing );
+
+    configASSERT( uxSlot < busRING_LENGTH );
+
+    taskENTER_CRITICAL();
+    {
+        configASSERT( pxBus->uxReferences[ uxSlot ] > 0 );
+        pxBus->uxReferences[ uxSlot ]--;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulEnergyBusGetDropped( const EnergyBus_t * pxBus )
+{
+    return pxBus->ulDropped;
+}
+/*-----------------------------------------------------------*/
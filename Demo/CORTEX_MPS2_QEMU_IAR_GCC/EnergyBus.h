@@ -0,0 +1,145 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef ENERGY_BUS_H
+#define ENERGY_BUS_H
+
+/*
+ * Publish/subscribe transport for energy samples.
+ *
+ * A published sample is written once, straight into a slot of the bus's
+ * ring, and only a pointer to the slot is queued to each subscriber of the
+ * topic, so the record itself is never copied however many tasks read it.  A
+ * slot returns to the ring when every subscriber that was sent it has called
+ * vEnergyBusRelease().  If no slot is free, or a subscriber's queue is full,
+ * the sample is dropped for that subscriber and counted rather than the
+ * publisher blocking.
+ *
+ * New producers, for example a second array or an EV charger, publish to an
+ * existing topic with their own source ID and need no new queues.
+ *
+ * Each household has a bus of its own, so the samples of one never reach the
+ * subscribers of another.
+ */
+
+#include "queue.h"
+
+/* Most subscribers any one topic can have. */
+#define busMAX_SUBSCRIBERS    ( 4 )
+
+/* Number of samples that can be in flight at once across all topics. */
+#define busRING_LENGTH        ( 16 )
+
+typedef enum EnergyTopic
+{
+    busTOPIC_GENERATION = 0, /* lValue is power produced, in W. */
+    busTOPIC_GRID,           /* lValue is energy in W.h, positive sold and negative bought. */
+    busNUM_TOPICS
+} EnergyTopic_t;
+
+/* Identifies the producer of a sample.  Add new producers to the end. */
+typedef enum EnergySource
+{
+    busSOURCE_SOLAR_ARRAY = 0,
+    busSOURCE_BATTERY,
+    busSOURCE_LOAD
+} EnergySource_t;
+
+typedef struct EnergySample
+{
+    TickType_t xTimestamp; /* Tick at which the value applies. */
+    int32_t lValue;        /* Units depend on the topic. */
+    uint32_t ulPublished;  /* ulLoopStatsTimestamp() when it was published. */
+    uint8_t ucTopic;       /* EnergyTopic_t */
+    uint8_t ucSource;      /* EnergySource_t */
+} EnergySample_t;
+
+/* A subscription is the queue its sample pointers are delivered to. */
+typedef QueueHandle_t EnergyBusSubscriber_t;
+
+/* A bus, its ring of samples and its subscribers.  Only accessed through the
+ * functions below. */
+typedef struct EnergyBus
+{
+    /* The samples themselves, and the number of subscribers yet to release
+     * each one.  A slot with a count of zero is free. */
+    EnergySample_t xRing[ busRING_LENGTH ];
+    UBaseType_t uxReferences[ busRING_LENGTH ];
+
+    /* Where the search for a free slot starts, so slots are reused in order. */
+    UBaseType_t uxNextSlot;
+
+    EnergyBusSubscriber_t xSubscribers[ busNUM_TOPICS ][ busMAX_SUBSCRIBERS ];
+    UBaseType_t uxSubscriberCount[ busNUM_TOPICS ];
+
+    uint32_t ulDropped;
+} EnergyBus_t;
+
+/*
+ * Empty pxBus of samples and subscribers.
+ */
+void vEnergyBusInit( EnergyBus_t * pxBus );
+
+/*
+ * Subscribe to a topic.  uxDepth is the number of samples that can wait for
+ * this subscriber.  Returns NULL if the queue could not be created or the
+ * topic already has busMAX_SUBSCRIBERS subscribers.  Subscriptions must be
+ * made before the scheduler is started.
+ */
+EnergyBusSubscriber_t xEnergyBusSubscribe( EnergyBus_t * pxBus,
+                                           EnergyTopic_t eTopic,
+                                           UBaseType_t uxDepth );
+
+/*
+ * Publish a sample to every subscriber of eTopic without blocking.  Returns
+ * pdPASS if at least one subscriber was sent the sample.
+ */
+BaseType_t xEnergyBusPublish( EnergyBus_t * pxBus,
+                              EnergyTopic_t eTopic,
+                              EnergySource_t eSource,
+                              TickType_t xTimestamp,
+                              int32_t lValue );
+
+/*
+ * Wait up to xTicksToWait for the next sample for a subscriber.  Returns NULL
+ * on timeout.  The sample must be passed to vEnergyBusRelease() once read.
+ */
+const EnergySample_t * pxEnergyBusReceive( EnergyBusSubscriber_t xSubscriber,
+                                           TickType_t xTicksToWait );
+
+/*
+ * Give a received sample back to the ring.
+ */
+void vEnergyBusRelease( EnergyBus_t * pxBus,
+                        const EnergySample_t * pxSample );
+
+/*
+ * Returns the number of deliveries that were dropped because the ring or a
+ * subscriber's queue was full.
+ */
+uint32_t ulEnergyBusGetDropped( const EnergyBus_t * pxBus );
+
+#endif /* ENERGY_BUS_H */
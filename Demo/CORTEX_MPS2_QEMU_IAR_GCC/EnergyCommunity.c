@@ -0,0 +1,167 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Community aggregator, see EnergyCommunity.h.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "EnergyCommunity.h"
+
+struct EnergyCommunity
+{
+    EnergyCommunityTotals_t xTotals;
+
+    /* Sold less bought by each household when the last period was aggregated,
+     * in micro W.h. */
+    int64_t * pllLastNet;
+    EnergyHousehold_t ** pxHouseholds;
+    size_t xCount;
+};
+
+/*
+ * Aggregates the households of the community passed as pvParameters once each
+ * period.
+ */
+static void prvCommunityTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+EnergyCommunity_t * pxEnergyCommunityStart( EnergyHousehold_t * const * pxHouseholds,
+                                            size_t xCount )
+{
+    EnergyCommunity_t * pxCommunity;
+    size_t xSize;
+
+    configASSERT( xCount > 0 );
+
+    /* The community and both of its lists are allocated together, the lists
+     * after the structure, and live as long as the application. */
+    xSize = sizeof( EnergyCommunity_t ) + ( xCount * ( sizeof( int64_t ) + sizeof( EnergyHousehold_t * ) ) );
+    pxCommunity = ( EnergyCommunity_t * ) pvPortMalloc( xSize );
+
+    if( pxCommunity != NULL )
+    {
+        memset( pxCommunity, 0x00, xSize );
+        pxCommunity->pllLastNet = ( int64_t * ) &( pxCommunity[ 1 ] );
+        pxCommunity->pxHouseholds = ( EnergyHousehold_t ** ) &( pxCommunity->pllLastNet[ xCount ] );
+        pxCommunity->xCount = xCount;
+        memcpy( pxCommunity->pxHouseholds, pxHouseholds, xCount * sizeof( EnergyHousehold_t * ) );
+
+        if( xTaskCreate( prvCommunityTask, "Community", communityTASK_STACK_SIZE, pxCommunity,
+                         communityTASK_PRIORITY, NULL ) != pdPASS )
+        {
+            vPortFree( pxCommunity );
+            pxCommunity = NULL;
+        }
+    }
+
+    return pxCommunity;
+}
+/*-----------------------------------------------------------*/
+
+void vEnergyCommunityGetTotals( const EnergyCommunity_t * pxCommunity,
+                                EnergyCommunityTotals_t * pxTotals )
+{
+    taskENTER_CRITICAL();
+    {
+        *pxTotals = pxCommunity->xTotals;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static void prvCommunityTask( void * pvParameters )
+{
+    EnergyCommunity_t * const pxCommunity = ( EnergyCommunity_t * ) pvParameters;
+    const TickType_t xPeriod = xEnergyManagementGetPeriod( pxCommunity->pxHouseholds[ 0 ] );
+    EnergyManagementTotals_t xHousehold;
+    const uint64_t * pullEnergy = xHousehold.xAccount.ullEnergy;
+    TickType_t xNextWakeTime;
+    int64_t llNet, llDelta, llSurplus, llDeficit, llShared;
+    uint64_t ullPeak;
+    size_t x;
+
+    /* Run half a period after the households take each sample. */
+    vTaskDelay( xPeriod / 2 );
+    xNextWakeTime = xTaskGetTickCount();
+
+    for( ; ; )
+    {
+        vTaskDelayUntil( &xNextWakeTime, xPeriod );
+
+        /* What the households sold between them, and what they bought. */
+        llSurplus = 0;
+        llDeficit = 0;
+
+        for( x = 0; x < pxCommunity->xCount; x++ )
+        {
+            vEnergyManagementGetTotals( pxCommunity->pxHouseholds[ x ], &xHousehold );
+            llNet = ( int64_t ) ( pullEnergy[ eEnergyExported ] - pullEnergy[ eEnergyImported ] );
+            llDelta = llNet - pxCommunity->pllLastNet[ x ];
+            pxCommunity->pllLastNet[ x ] = llNet;
+
+            if( llDelta > 0 )
+            {
+                llSurplus += llDelta;
+            }
+            else
+            {
+                llDeficit -= llDelta;
+            }
+        }
+
+        llShared = ( llSurplus < llDeficit ) ? llSurplus : llDeficit;
+
+        /* Mean power over the period of what is still bought, in W. */
+        ullPeak = ( ( uint64_t ) ( llDeficit - llShared ) * xEnergyManagementGetHourTicks() ) /
+                  ( ( uint64_t ) xPeriod * ( uint64_t ) accountMICRO );
+
+        taskENTER_CRITICAL();
+        {
+            pxCommunity->xTotals.llNetGrid += llSurplus - llDeficit;
+            pxCommunity->xTotals.ullImported += ( uint64_t ) ( llDeficit - llShared );
+            pxCommunity->xTotals.ullExported += ( uint64_t ) ( llSurplus - llShared );
+            pxCommunity->xTotals.ullShared += ( uint64_t ) llShared;
+
+            if( ullPeak > pxCommunity->xTotals.ulPeakImport )
+            {
+                pxCommunity->xTotals.ulPeakImport = ( ullPeak > UINT32_MAX ) ? UINT32_MAX : ( uint32_t ) ullPeak;
+            }
+
+            pxCommunity->xTotals.ulPeriods++;
+        }
+        taskEXIT_CRITICAL();
+    }
+}
+/*-----------------------------------------------------------*/
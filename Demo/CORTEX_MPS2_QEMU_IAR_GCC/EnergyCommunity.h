@@ -0,0 +1,82 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef ENERGY_COMMUNITY_H
+#define ENERGY_COMMUNITY_H
+
+/*
+ * Aggregates the households simulated in one image into a community behind a
+ * single grid connection.
+ *
+ * Once each period, half way between the samples of the households so all of
+ * them have finished theirs, a task reads what every household sold and
+ * bought since the last period.  Energy one household sells while another
+ * buys is counted as shared between them; only what is left over crosses the
+ * community's grid connection.  The households themselves are billed as
+ * before, each by its own tariff.  The period is that of the first household
+ * when the community starts.
+ */
+
+#include "EnergyManagement.h"
+
+/* Priority and stack size, in words, of the aggregator task. */
+#ifndef communityTASK_PRIORITY
+    #define communityTASK_PRIORITY      ( tskIDLE_PRIORITY + 1 )
+#endif
+
+#ifndef communityTASK_STACK_SIZE
+    #define communityTASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 2 )
+#endif
+
+/* Running totals of the community.  Energy is in micro W.h. */
+typedef struct EnergyCommunityTotals
+{
+    int64_t llNetGrid;       /* Sold by the community less bought, over all periods. */
+    uint64_t ullImported;    /* Bought from the grid once shared energy is netted out. */
+    uint64_t ullExported;    /* Sold to the grid once shared energy is netted out. */
+    uint64_t ullShared;      /* Sold by one household and bought by another in the same period. */
+    uint32_t ulPeakImport;   /* Largest mean power bought from the grid over a period, in W. */
+    uint32_t ulPeriods;      /* Periods aggregated. */
+} EnergyCommunityTotals_t;
+
+/* A running community.  Only accessed through the functions below. */
+typedef struct EnergyCommunity EnergyCommunity_t;
+
+/*
+ * Create the aggregator task for the xCount households in pxHouseholds, which
+ * must all have been started.  The list is copied.  Call before the scheduler
+ * is started.  Returns NULL if the community could not be allocated.
+ */
+EnergyCommunity_t * pxEnergyCommunityStart( EnergyHousehold_t * const * pxHouseholds,
+                                            size_t xCount );
+
+/*
+ * Take a snapshot of the running totals of the community.
+ */
+void vEnergyCommunityGetTotals( const EnergyCommunity_t * pxCommunity,
+                                EnergyCommunityTotals_t * pxTotals );
+
+#endif /* ENERGY_COMMUNITY_H */
@@ -0,0 +1,93 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef ENERGY_CONFIG_H
+#define ENERGY_CONFIG_H
+
+/*
+ * Parameters of the simulated household that are shared between main.c and
+ * the modules that support it.
+ */
+
+#include "EnergyCurve.h"
+
+/* Solar power curve in W, assuming a maximum of 5000 W.  PERIOD is in seconds
+ * of run time, and one second of run time represents one hour.  The panels
+ * produce nothing at night, so the negative half of the wave reads as 0. */
+#define AMPLITUDE             5000
+#define PERIOD                24
+#define PHASE                 curveQUARTER_TURN
+#define SOLAR_POWER_CURVE     curveDEFINE( PERIOD * configTICK_RATE_HZ, PHASE, AMPLITUDE, 0, 0 )
+
+/* Run time between the samples the solar, battery and load tasks take, in ms.
+ * A second is a simulated hour, so 200 is 12 minutes.  It can be changed while
+ * the tasks run with vEnergyManagementSetPeriod(). */
+#define SAMPLE_PERIOD_MS         200
+
+/* Battery capacity and the energy stored in it at start up, in W.h. */
+#define CAPACITY                 10000
+#define INITIAL_BATTERY_LEVEL    0
+
+/* Losses, power limits and wear of the battery, see BatteryModel.h.
+ * modelIDEAL has none, modelLITHIUM_ION is a typical home battery. */
+#define BATTERY_MODEL            modelIDEAL
+
+/* Most power the battery can be charged or discharged with when trading with
+ * the grid, in W. */
+#define BATTERY_MAX_POWER        5000
+
+/* Set to 1 to plan the battery a day ahead against the price curve, buying
+ * cheap energy and selling dear, see BatteryDispatch.h.  Set to 0 to store all
+ * surplus solar energy and only trade what does not fit. */
+#define DISPATCH_OPTIMISED       1
+
+/* Smoothing of the forecasts of solar power and load the plan is made from,
+ * see EnergyForecast.h.  forecastPERSISTENCE expects each hour to be as it was
+ * the day before, forecastHOLT_WINTERS smooths over several days. */
+#define FORECAST_SMOOTHING       forecastHOLT_WINTERS
+
+/* Price of energy at a given time in the day.  It is in miliCents /W.h, which
+ * is the same number as cents/kW.h. */
+#define PRICE_AMPLITUDE       7  /* Represents the maximum price fluctuation (±7 cents) */
+#define BASE_PRICE            22 /* Base price of 22 cents/kW.h */
+#define PRICE_PERIOD          24
+#define PRICE_PHASE           curveQUARTER_TURN
+#define ENERGY_PRICE_CURVE    curveDEFINE( PRICE_PERIOD * configTICK_RATE_HZ, PRICE_PHASE, PRICE_AMPLITUDE, BASE_PRICE, curveNO_MINIMUM )
+
+/* Price paid for energy sold to the grid, in the same units.  By default it is
+ * the price of energy bought.  A flat feed-in price would be, for example,
+ * curveDEFINE( PRICE_PERIOD * configTICK_RATE_HZ, 0, 0, 8, curveNO_MINIMUM ). */
+#define EXPORT_PRICE_CURVE    ENERGY_PRICE_CURVE
+
+/* Fixed charge for each day connected to the grid, in miliCents. */
+#define DAILY_CHARGE          0
+
+/* Set to 1 to report the state of the household as binary frames, which are
+ * far cheaper to produce and send than formatted text, or to 0 for readable
+ * text.  See Telemetry.h. */
+#define TELEMETRY_BINARY      1
+
+#endif /* ENERGY_CONFIG_H */
@@ -0,0 +1,119 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Fixed-point implementation of the periodic curves used by the energy
+ * application.  See EnergyCurve.h for a description of the representation.
+ */
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+
+/* Demo includes. */
+#include "EnergyCurve.h"
+
+/* The sine table is built by the compiler.  Every index is folded into the
+ * first quarter wave, where a degree 11 Taylor polynomial is accurate to well
+ * below one Q15 LSB, and the sign is restored from the half the index falls
+ * in.  All of the arithmetic below is a constant expression, so the floating
+ * point maths never makes it into the image. */
+#define curveHALF_TABLE          ( curveTABLE_SIZE / 2U )
+#define curveQUARTER_TABLE       ( curveTABLE_SIZE / 4U )
+#define curveFOLD( i )           ( ( ( i ) % curveHALF_TABLE ) <= curveQUARTER_TABLE ? ( ( i ) % curveHALF_TABLE ) : curveHALF_TABLE - ( ( i ) % curveHALF_TABLE ) )
+#define curveANGLE( i )          ( ( double ) curveFOLD( i ) * ( 6.283185307179586 / ( double ) curveTABLE_SIZE ) )
+#define curveSQ( x )             ( ( x ) * ( x ) )
+#define curveTAYLOR( x )         ( ( x ) * ( 1.0 - curveSQ( x ) / 6.0 * ( 1.0 - curveSQ( x ) / 20.0 * ( 1.0 - curveSQ( x ) / 42.0 * ( 1.0 - curveSQ( x ) / 72.0 * ( 1.0 - curveSQ( x ) / 110.0 ) ) ) ) ) )
+#define curveSIGN( i )           ( ( ( i ) % curveTABLE_SIZE ) >= curveHALF_TABLE ? -1 : 1 )
+#define curveSINE_ENTRY( i )     ( ( int16_t ) ( curveSIGN( i ) * ( int32_t ) ( 32767.0 * curveTAYLOR( curveANGLE( i ) ) + 0.5 ) ) )
+#define curveSINE_ROW( i )                                                   \
+    curveSINE_ENTRY( ( i ) + 0U ), curveSINE_ENTRY( ( i ) + 1U ),            \
+    curveSINE_ENTRY( ( i ) + 2U ), curveSINE_ENTRY( ( i ) + 3U ),            \
+    curveSINE_ENTRY( ( i ) + 4U ), curveSINE_ENTRY( ( i ) + 5U ),            \
+    curveSINE_ENTRY( ( i ) + 6U ), curveSINE_ENTRY( ( i ) + 7U )
+
+/* Bits of the phase used to interpolate between two table entries. */
+#define curveFRACTION_BITS       ( 16 )
+
+/*-----------------------------------------------------------*/
+
+/* One full turn plus a guard entry so interpolation never has to wrap. */
+static const int16_t sSineTable[ curveTABLE_SIZE + 1U ] =
+{
+    curveSINE_ROW( 0U ),   curveSINE_ROW( 8U ),   curveSINE_ROW( 16U ),  curveSINE_ROW( 24U ),
+    curveSINE_ROW( 32U ),  curveSINE_ROW( 40U ),  curveSINE_ROW( 48U ),  curveSINE_ROW( 56U ),
+    curveSINE_ROW( 64U ),  curveSINE_ROW( 72U ),  curveSINE_ROW( 80U ),  curveSINE_ROW( 88U ),
+    curveSINE_ROW( 96U ),  curveSINE_ROW( 104U ), curveSINE_ROW( 112U ), curveSINE_ROW( 120U ),
+    curveSINE_ROW( 128U ), curveSINE_ROW( 136U ), curveSINE_ROW( 144U ), curveSINE_ROW( 152U ),
+    curveSINE_ROW( 160U ), curveSINE_ROW( 168U ), curveSINE_ROW( 176U ), curveSINE_ROW( 184U ),
+    curveSINE_ROW( 192U ), curveSINE_ROW( 200U ), curveSINE_ROW( 208U ), curveSINE_ROW( 216U ),
+    curveSINE_ROW( 224U ), curveSINE_ROW( 232U ), curveSINE_ROW( 240U ), curveSINE_ROW( 248U ),
+    curveSINE_ENTRY( 256U )
+};
+
+/* The initialiser above is written out for 256 entries. */
+typedef char curveTableSizeCheck_t[ ( curveTABLE_SIZE == 256U ) ? 1 : -1 ];
+
+/*-----------------------------------------------------------*/
+
+int32_t lEnergyCurveSineQ15( uint32_t ulPhase )
+{
+    uint32_t ulIndex;
+    int32_t lFraction, lLow, lHigh;
+
+    /* The top bits of the phase select the segment, the next
+     * curveFRACTION_BITS give the position within it. */
+    ulIndex = ulPhase >> ( 32 - curveTABLE_BITS );
+    lFraction = ( int32_t ) ( ( ulPhase >> ( 32 - curveTABLE_BITS - curveFRACTION_BITS ) ) & ( ( 1UL << curveFRACTION_BITS ) - 1UL ) );
+
+    lLow = sSineTable[ ulIndex ];
+    lHigh = sSineTable[ ulIndex + 1U ];
+
+    /* Adjacent entries differ by at most ~800, so the product fits easily. */
+    return lLow + ( ( ( lHigh - lLow ) * lFraction ) >> curveFRACTION_BITS );
+}
+/*-----------------------------------------------------------*/
+
+int32_t lEnergyCurveEvaluate( const EnergyCurve_t * pxCurve,
+                              TickType_t xTick )
+{
+    uint32_t ulPhase;
+    int32_t lValue;
+
+    /* Reduce the tick to a position within one period before scaling, so the
+     * result does not drift however long the system has been running. */
+    ulPhase = ( ( uint32_t ) ( xTick % pxCurve->xPeriod ) * pxCurve->ulPhaseStep ) + pxCurve->ulPhaseOffset;
+
+    /* lAmplitude is limited to 16 bits so the Q15 product cannot overflow. */
+    lValue = pxCurve->lOffset + ( ( pxCurve->lAmplitude * lEnergyCurveSineQ15( ulPhase ) ) >> 15 );
+
+    if( lValue < pxCurve->lMinimum )
+    {
+        lValue = pxCurve->lMinimum;
+    }
+
+    return lValue;
+}
+/*-----------------------------------------------------------*/
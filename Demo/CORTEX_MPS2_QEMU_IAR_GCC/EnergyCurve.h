@@ -0,0 +1,88 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef ENERGY_CURVE_H
+#define ENERGY_CURVE_H
+
+/*
+ * Fixed-point periodic curve engine used to model the solar generation and
+ * energy price profiles without calling the floating point sin() function.
+ *
+ * A curve is y = lOffset + lAmplitude * sin( 2 * pi * tick / xPeriod - lag ),
+ * clamped so it never falls below lMinimum.
+ * Angles are held as unsigned Q0.32 fractions of a full turn, so wrap around
+ * comes for free, and the sine itself is read from a Q15 table that the
+ * compiler builds from constant expressions - there is no run time
+ * initialisation and no libm dependency.  Each sample costs one modulo, two
+ * multiplies and one interpolated table read, whatever the tick value.
+ */
+
+/* Number of table segments per full turn.  Must be a power of two. */
+#define curveTABLE_BITS      ( 8 )
+#define curveTABLE_SIZE      ( 1U << curveTABLE_BITS )
+
+/* Passed as the minimum of a curve that is never clamped. */
+#define curveNO_MINIMUM      ( INT32_MIN )
+
+/* Common phase lags expressed as Q0.32 fractions of a full turn. */
+#define curveQUARTER_TURN    ( 0x40000000UL )
+#define curveHALF_TURN       ( 0x80000000UL )
+
+/* Build an EnergyCurve_t initialiser.  Everything is evaluated by the
+ * compiler, so curves can be const and live in flash. */
+#define curveDEFINE( xPeriodTicks, ulPhaseLag, lAmp, lOff, lMin )                \
+    {                                                                            \
+        ( TickType_t ) ( xPeriodTicks ),                                         \
+        ( uint32_t ) ( 0x100000000ULL / ( unsigned long long ) ( xPeriodTicks ) ), \
+        ( uint32_t ) ( 0UL - ( uint32_t ) ( ulPhaseLag ) ),                      \
+        ( int32_t ) ( lAmp ),                                                    \
+        ( int32_t ) ( lOff ),                                                    \
+        ( int32_t ) ( lMin )                                                     \
+    }
+
+typedef struct EnergyCurve
+{
+    TickType_t xPeriod;     /* Length of one full cycle in ticks. */
+    uint32_t ulPhaseStep;   /* Q0.32 turn advanced per tick, 2^32 / xPeriod. */
+    uint32_t ulPhaseOffset; /* Q0.32 turn added to every sample. */
+    int32_t lAmplitude;     /* Peak deviation from lOffset. */
+    int32_t lOffset;        /* Mean value of the curve. */
+    int32_t lMinimum;       /* Samples below this value are clamped to it. */
+} EnergyCurve_t;
+
+/*
+ * Returns sin( 2 * pi * ulPhase / 2^32 ) as a Q15 value in the range
+ * -32767 to 32767, linearly interpolated between table entries.
+ */
+int32_t lEnergyCurveSineQ15( uint32_t ulPhase );
+
+/*
+ * Returns the value of the curve at the given tick.
+ */
+int32_t lEnergyCurveEvaluate( const EnergyCurve_t * pxCurve,
+                              TickType_t xTick );
+
+#endif /* ENERGY_CURVE_H */
@@ -0,0 +1,215 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Fixed point Holt-Winters forecast, see EnergyForecast.h.
+ */
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "EnergyForecast.h"
+
+/* Values are held in W in Q8, and limited so that sums of two of them cannot
+ * overflow. */
+#define forecastVALUE_SHIFT    ( 8U )
+#define forecastMAX_VALUE      ( 1UL << 20 )
+
+/* No slot has been smoothed into the forecast yet. */
+#define forecastNO_SLOT        ( UINT32_MAX )
+
+/* Returns lOld moved towards lTarget by the Q15 share usFactor, rounded. */
+static int32_t prvBlend( int32_t lOld,
+                         int32_t lTarget,
+                         uint16_t usFactor );
+
+/* Returns the forecast of slot ulSlot in W in Q8.  Called in a critical
+ * section, or by the task that adds the samples. */
+static int32_t prvForecast( const EnergyForecast_t * pxForecast,
+                            uint32_t ulSlot );
+
+/* Smooth the slot the samples so far were taken in into the forecast. */
+static void prvUpdate( EnergyForecast_t * pxForecast );
+
+/*-----------------------------------------------------------*/
+
+void vEnergyForecastInit( EnergyForecast_t * pxForecast,
+                          const EnergyForecastParams_t * pxParams,
+                          TickType_t xSlotTicks,
+                          const uint32_t pulInitial[ forecastSEASON_SLOTS ] )
+{
+    int64_t llSum = 0;
+    uint32_t ulSlot;
+
+    configASSERT( xSlotTicks > 0 );
+
+    pxForecast->xParams = *pxParams;
+    pxForecast->xSlotTicks = xSlotTicks;
+
+    /* Start with no trend, the mean of the initial forecasts as the level and
+     * their differences from it as the seasonal offsets. */
+    for( ulSlot = 0; ulSlot < forecastSEASON_SLOTS; ulSlot++ )
+    {
+        llSum += ( int64_t ) configMIN( pulInitial[ ulSlot ], forecastMAX_VALUE ) << forecastVALUE_SHIFT;
+    }
+
+    pxForecast->lLevel = ( int32_t ) ( llSum / ( int64_t ) forecastSEASON_SLOTS );
+    pxForecast->lTrend = 0;
+
+    for( ulSlot = 0; ulSlot < forecastSEASON_SLOTS; ulSlot++ )
+    {
+        pxForecast->lSeason[ ulSlot ] = ( int32_t ) ( configMIN( pulInitial[ ulSlot ], forecastMAX_VALUE ) << forecastVALUE_SHIFT ) -
+                                        pxForecast->lLevel;
+    }
+
+    pxForecast->ulSlot = 0;
+    pxForecast->llSum = 0;
+    pxForecast->ulSamples = 0;
+    pxForecast->ulUpdatedSlot = forecastNO_SLOT;
+    pxForecast->ullAbsError = 0;
+    pxForecast->ulErrors = 0;
+}
+/*-----------------------------------------------------------*/
+
+void vEnergyForecastAdd( EnergyForecast_t * pxForecast,
+                         TickType_t xTime,
+                         uint32_t ulValue )
+{
+    uint32_t ulSlot = ( uint32_t ) ( xTime / pxForecast->xSlotTicks );
+
+    if( ( ulSlot != pxForecast->ulSlot ) && ( pxForecast->ulSamples > 0 ) )
+    {
+        taskENTER_CRITICAL();
+        {
+            prvUpdate( pxForecast );
+        }
+        taskEXIT_CRITICAL();
+
+        pxForecast->llSum = 0;
+        pxForecast->ulSamples = 0;
+    }
+
+    pxForecast->ulSlot = ulSlot;
+    pxForecast->llSum += configMIN( ulValue, forecastMAX_VALUE );
+    pxForecast->ulSamples++;
+}
+/*-----------------------------------------------------------*/
+
+void vEnergyForecastGet( const EnergyForecast_t * pxForecast,
+                         uint32_t ulSlot,
+                         uint32_t * pulForecast,
+                         size_t xSlots )
+{
+    int32_t lValue;
+    size_t x;
+
+    taskENTER_CRITICAL();
+    {
+        for( x = 0; x < xSlots; x++ )
+        {
+            lValue = prvForecast( pxForecast, ulSlot + ( uint32_t ) x );
+
+            /* Round to W, and nothing is ever forecast to be negative. */
+            pulForecast[ x ] = ( lValue > 0 ) ? ( uint32_t ) ( ( lValue + ( 1L << ( forecastVALUE_SHIFT - 1U ) ) ) >> forecastVALUE_SHIFT ) : 0;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulEnergyForecastGetError( const EnergyForecast_t * pxForecast )
+{
+    uint32_t ulReturn = 0;
+
+    taskENTER_CRITICAL();
+    {
+        if( pxForecast->ulErrors > 0 )
+        {
+            ulReturn = ( uint32_t ) ( pxForecast->ullAbsError / pxForecast->ulErrors );
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return ulReturn;
+}
+/*-----------------------------------------------------------*/
+
+static int32_t prvBlend( int32_t lOld,
+                         int32_t lTarget,
+                         uint16_t usFactor )
+{
+    /* A factor of 1 gives lTarget exactly and 0 gives lOld. */
+    return lOld + ( int32_t ) ( ( ( ( int64_t ) lTarget - lOld ) * usFactor + 16384 ) >> 15 );
+}
+/*-----------------------------------------------------------*/
+
+static int32_t prvForecast( const EnergyForecast_t * pxForecast,
+                            uint32_t ulSlot )
+{
+    int64_t llValue;
+    uint32_t ulAhead = 0;
+
+    if( ( pxForecast->ulUpdatedSlot != forecastNO_SLOT ) && ( ulSlot > pxForecast->ulUpdatedSlot ) )
+    {
+        ulAhead = ulSlot - pxForecast->ulUpdatedSlot;
+    }
+
+    llValue = ( int64_t ) pxForecast->lLevel + ( ( int64_t ) ulAhead * pxForecast->lTrend ) +
+              pxForecast->lSeason[ ulSlot % forecastSEASON_SLOTS ];
+
+    if( llValue > ( ( int64_t ) forecastMAX_VALUE << forecastVALUE_SHIFT ) )
+    {
+        llValue = ( int64_t ) forecastMAX_VALUE << forecastVALUE_SHIFT;
+    }
+
+    return ( int32_t ) llValue;
+}
+/*-----------------------------------------------------------*/
+
+static void prvUpdate( EnergyForecast_t * pxForecast )
+{
+    const EnergyForecastParams_t * pxParams = &( pxForecast->xParams );
+    int32_t * plSeason = &( pxForecast->lSeason[ pxForecast->ulSlot % forecastSEASON_SLOTS ] );
+    int32_t lMean, lForecast, lLastLevel;
+
+    /* The slot's mean, rounded down like the hourly history. */
+    lMean = ( int32_t ) ( pxForecast->llSum / ( int64_t ) pxForecast->ulSamples ) << forecastVALUE_SHIFT;
+
+    /* How far out the forecast of this slot was. */
+    lForecast = prvForecast( pxForecast, pxForecast->ulSlot );
+    lForecast = ( lForecast > 0 ) ? lForecast : 0;
+    pxForecast->ullAbsError += ( uint32_t ) ( ( lMean > lForecast ) ? ( lMean - lForecast ) : ( lForecast - lMean ) ) >> forecastVALUE_SHIFT;
+    pxForecast->ulErrors++;
+
+    lLastLevel = pxForecast->lLevel;
+    pxForecast->lLevel = prvBlend( pxForecast->lLevel + pxForecast->lTrend, lMean - *plSeason, pxParams->usAlpha );
+    pxForecast->lTrend = prvBlend( pxForecast->lTrend, pxForecast->lLevel - lLastLevel, pxParams->usBeta );
+    *plSeason = prvBlend( *plSeason, lMean - pxForecast->lLevel, pxParams->usGamma );
+    pxForecast->ulUpdatedSlot = pxForecast->ulSlot;
+}
+/*-----------------------------------------------------------*/
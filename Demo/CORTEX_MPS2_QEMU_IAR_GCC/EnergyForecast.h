@@ -0,0 +1,136 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef ENERGY_FORECAST_H
+#define ENERGY_FORECAST_H
+
+/*
+ * Forecast of a quantity with a daily pattern, such as solar power or load,
+ * by additive Holt-Winters smoothing over a season of forecastSEASON_SLOTS
+ * slots.  It keeps a level, a trend and one seasonal offset for each slot of
+ * the day:
+ *
+ *   level   = alpha * ( mean - season ) + ( 1 - alpha ) * ( level + trend )
+ *   trend   = beta * ( level - previous level ) + ( 1 - beta ) * trend
+ *   season  = gamma * ( mean - level ) + ( 1 - gamma ) * season
+ *
+ * where mean is the mean of the samples of the slot just ended.  The forecast
+ * for k slots ahead is level + k * trend + the season of that slot.
+ *
+ * Samples are added as they are taken.  Adding one is a sum, and at the end
+ * of a slot the update is a handful of multiplies, so either is O(1) and cheap
+ * enough for every period of the energy tasks.  Everything is integer: values
+ * are held in W in Q8 and the smoothing factors are Q15.
+ *
+ * With alpha and beta 0 and gamma 1 the forecast of each slot is its value a
+ * day before, see forecastPERSISTENCE.
+ */
+
+/* Slots in a season. */
+#define forecastSEASON_SLOTS    ( 24U )
+
+/* A smoothing factor between 0 and 1 in Q15.  Only for constants, so no
+ * floating point code is generated. */
+#define forecastQ15( x )        ( ( uint16_t ) ( ( ( x ) * 32768.0 ) + 0.5 ) )
+
+typedef struct EnergyForecastParams
+{
+    uint16_t usAlpha; /* Q15 smoothing of the level. */
+    uint16_t usBeta;  /* Q15 smoothing of the trend. */
+    uint16_t usGamma; /* Q15 smoothing of the seasonal offsets. */
+} EnergyForecastParams_t;
+
+/* Each slot as it was the day before. */
+#define forecastPERSISTENCE                                                \
+    {                                                                      \
+        0U, 0U, forecastQ15( 1.0 )                                         \
+    }
+
+/* Smoothed over a few days, for quantities that vary from day to day. */
+#define forecastHOLT_WINTERS                                               \
+    {                                                                      \
+        forecastQ15( 0.05 ), forecastQ15( 0.01 ), forecastQ15( 0.35 )      \
+    }
+
+typedef struct EnergyForecast
+{
+    EnergyForecastParams_t xParams;
+    TickType_t xSlotTicks;
+
+    /* The smoothed state, in W in Q8. */
+    int32_t lLevel;
+    int32_t lTrend;
+    int32_t lSeason[ forecastSEASON_SLOTS ];
+
+    /* The slot samples are being added to, its sum and the number of them,
+     * and the last slot the state was updated with, UINT32_MAX for none. */
+    uint32_t ulSlot;
+    int64_t llSum;
+    uint32_t ulSamples;
+    uint32_t ulUpdatedSlot;
+
+    /* Sum of the absolute errors of the forecasts of each slot made a slot
+     * before, in W, and the number of them. */
+    uint64_t ullAbsError;
+    uint32_t ulErrors;
+} EnergyForecast_t;
+
+/*
+ * Set up pxForecast with the parameters in pxParams, which are copied, slots
+ * of xSlotTicks ticks, and pulInitial as the forecast of each slot of the day
+ * until samples of it have been seen.
+ */
+void vEnergyForecastInit( EnergyForecast_t * pxForecast,
+                          const EnergyForecastParams_t * pxParams,
+                          TickType_t xSlotTicks,
+                          const uint32_t pulInitial[ forecastSEASON_SLOTS ] );
+
+/*
+ * Add the sample ulValue, in W, taken at xTime.  Samples must be added in time
+ * order from a single task.  A slot is smoothed into the forecast when the
+ * first sample of a later one arrives.
+ */
+void vEnergyForecastAdd( EnergyForecast_t * pxForecast,
+                         TickType_t xTime,
+                         uint32_t ulValue );
+
+/*
+ * Write the forecast mean of xSlots slots from slot ulSlot, slot n being the
+ * one starting at tick n * xSlotTicks, to pulForecast, in W.  Can be called
+ * from any task.
+ */
+void vEnergyForecastGet( const EnergyForecast_t * pxForecast,
+                         uint32_t ulSlot,
+                         uint32_t * pulForecast,
+                         size_t xSlots );
+
+/*
+ * Returns the mean absolute error of the forecasts of each slot made a slot
+ * before, in W, 0 before the first.
+ */
+uint32_t ulEnergyForecastGetError( const EnergyForecast_t * pxForecast );
+
+#endif /* ENERGY_FORECAST_H */
@@ -0,0 +1,391 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * In memory history of the household, see EnergyHistory.h.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "EnergyHistory.h"
+
+/* The records as stored, only as big as each tier needs. */
+typedef struct HistorySample
+{
+    TickType_t xTime;
+    int32_t lValue[ historyNUM_CHANNELS ];
+} HistorySample_t;
+
+/* Position of the oldest record of a ring and how many there are. */
+typedef struct HistoryRing
+{
+    size_t xOldest;
+    size_t xCount;
+    size_t xSize;
+} HistoryRing_t;
+
+/* Running sums for the hour or day that has not ended yet. */
+typedef struct HistoryPeriod
+{
+    TickType_t xStart;
+    uint32_t ulSamples;
+    int64_t llSum[ historyNUM_CHANNELS ];
+    int32_t lMin[ historyNUM_CHANNELS ];
+    int32_t lMax[ historyNUM_CHANNELS ];
+} HistoryPeriod_t;
+
+struct EnergyHistory
+{
+    TickType_t xHourTicks;
+    TickType_t xDayTicks;
+    HistoryRing_t xRing[ 3 ]; /* Indexed by eHistoryTier. */
+    HistoryPeriod_t xHour;
+    HistoryPeriod_t xDay;
+    HistorySample_t xRaw[ historyRAW_RECORDS ];
+    HistorySample_t xHourly[ historyHOURLY_RECORDS ];
+    HistoryRecord_t xDaily[ historyDAILY_RECORDS ];
+};
+
+/*
+ * Returns the index at which to write a new record of the ring, dropping the
+ * oldest record if it is full.
+ */
+static size_t prvRingPush( HistoryRing_t * pxRing );
+
+/*
+ * Fold a sample into a period, ending the period first with pxEnd if the
+ * sample belongs to the next one.
+ */
+static void prvPeriodAdd( EnergyHistory_t * pxHistory,
+                          HistoryPeriod_t * pxPeriod,
+                          TickType_t xPeriodTicks,
+                          TickType_t xTime,
+                          const int32_t plValues[ historyNUM_CHANNELS ],
+                          void ( *pxEnd )( EnergyHistory_t *, const HistoryPeriod_t * ) );
+static void prvEndHour( EnergyHistory_t * pxHistory,
+                        const HistoryPeriod_t * pxPeriod );
+static void prvEndDay( EnergyHistory_t * pxHistory,
+                       const HistoryPeriod_t * pxPeriod );
+
+/*
+ * Read record xIndex, counting from the oldest, of a tier as a HistoryRecord_t.
+ */
+static void prvGetRecord( const EnergyHistory_t * pxHistory,
+                          eHistoryTier eTier,
+                          size_t xIndex,
+                          HistoryRecord_t * pxRecord );
+
+/*
+ * Index, counting from the oldest, of the first record of a tier at or after
+ * xSince.
+ */
+static size_t prvFirstSince( const EnergyHistory_t * pxHistory,
+                             eHistoryTier eTier,
+                             TickType_t xSince );
+
+/*-----------------------------------------------------------*/
+
+EnergyHistory_t * pxEnergyHistoryCreate( TickType_t xHourTicks,
+                                         TickType_t xDayTicks )
+{
+    EnergyHistory_t * pxHistory;
+
+    configASSERT( ( xHourTicks > 0 ) && ( xDayTicks > 0 ) );
+
+    pxHistory = ( EnergyHistory_t * ) pvPortMalloc( sizeof( EnergyHistory_t ) );
+
+    if( pxHistory != NULL )
+    {
+        memset( pxHistory, 0x00, sizeof( *pxHistory ) );
+        pxHistory->xHourTicks = xHourTicks;
+        pxHistory->xDayTicks = xDayTicks;
+        pxHistory->xRing[ eHistoryRaw ].xSize = historyRAW_RECORDS;
+        pxHistory->xRing[ eHistoryHourly ].xSize = historyHOURLY_RECORDS;
+        pxHistory->xRing[ eHistoryDaily ].xSize = historyDAILY_RECORDS;
+    }
+
+    return pxHistory;
+}
+/*-----------------------------------------------------------*/
+
+void vEnergyHistoryAdd( EnergyHistory_t * pxHistory,
+                        TickType_t xTime,
+                        const int32_t plValues[ historyNUM_CHANNELS ] )
+{
+    size_t xIndex;
+
+    /* Readers suspend the scheduler, so nothing they look at can change while
+     * this task is switched out. */
+    vTaskSuspendAll();
+    {
+        xIndex = prvRingPush( &( pxHistory->xRing[ eHistoryRaw ] ) );
+        pxHistory->xRaw[ xIndex ].xTime = xTime;
+        memcpy( pxHistory->xRaw[ xIndex ].lValue, plValues, sizeof( pxHistory->xRaw[ xIndex ].lValue ) );
+
+        prvPeriodAdd( pxHistory, &( pxHistory->xHour ), pxHistory->xHourTicks, xTime, plValues, prvEndHour );
+        prvPeriodAdd( pxHistory, &( pxHistory->xDay ), pxHistory->xDayTicks, xTime, plValues, prvEndDay );
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+size_t xEnergyHistoryQuery( EnergyHistory_t * pxHistory,
+                            eHistoryTier eTier,
+                            TickType_t xSince,
+                            HistoryRecord_t * pxRecords,
+                            size_t xMaxRecords )
+{
+    size_t xFirst, xCount, x;
+
+    vTaskSuspendAll();
+    {
+        xFirst = prvFirstSince( pxHistory, eTier, xSince );
+        xCount = pxHistory->xRing[ eTier ].xCount - xFirst;
+
+        if( xCount > xMaxRecords )
+        {
+            xFirst += xCount - xMaxRecords;
+            xCount = xMaxRecords;
+        }
+
+        for( x = 0; x < xCount; x++ )
+        {
+            prvGetRecord( pxHistory, eTier, xFirst + x, &( pxRecords[ x ] ) );
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    return xCount;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xEnergyHistorySummarise( EnergyHistory_t * pxHistory,
+                                    eHistoryTier eTier,
+                                    TickType_t xSince,
+                                    HistoryRecord_t * pxSummary )
+{
+    HistoryRecord_t xRecord;
+    int64_t llSum[ historyNUM_CHANNELS ] = { 0 };
+    size_t xFirst, xCount, x, xChannel;
+
+    vTaskSuspendAll();
+    {
+        xFirst = prvFirstSince( pxHistory, eTier, xSince );
+        xCount = pxHistory->xRing[ eTier ].xCount - xFirst;
+
+        for( x = 0; x < xCount; x++ )
+        {
+            prvGetRecord( pxHistory, eTier, xFirst + x, &xRecord );
+
+            if( x == 0U )
+            {
+                *pxSummary = xRecord;
+            }
+
+            for( xChannel = 0; xChannel < historyNUM_CHANNELS; xChannel++ )
+            {
+                if( xRecord.lMin[ xChannel ] < pxSummary->lMin[ xChannel ] )
+                {
+                    pxSummary->lMin[ xChannel ] = xRecord.lMin[ xChannel ];
+                }
+
+                if( xRecord.lMax[ xChannel ] > pxSummary->lMax[ xChannel ] )
+                {
+                    pxSummary->lMax[ xChannel ] = xRecord.lMax[ xChannel ];
+                }
+
+                llSum[ xChannel ] += xRecord.lMean[ xChannel ];
+            }
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    for( x = 0; ( x < historyNUM_CHANNELS ) && ( xCount > 0U ); x++ )
+    {
+        pxSummary->lMean[ x ] = ( int32_t ) ( llSum[ x ] / ( int64_t ) xCount );
+    }
+
+    return ( xCount > 0U ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvRingPush( HistoryRing_t * pxRing )
+{
+    size_t xIndex;
+
+    if( pxRing->xCount < pxRing->xSize )
+    {
+        xIndex = ( pxRing->xOldest + pxRing->xCount ) % pxRing->xSize;
+        pxRing->xCount++;
+    }
+    else
+    {
+        xIndex = pxRing->xOldest;
+        pxRing->xOldest = ( pxRing->xOldest + 1U ) % pxRing->xSize;
+    }
+
+    return xIndex;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPeriodAdd( EnergyHistory_t * pxHistory,
+                          HistoryPeriod_t * pxPeriod,
+                          TickType_t xPeriodTicks,
+                          TickType_t xTime,
+                          const int32_t plValues[ historyNUM_CHANNELS ],
+                          void ( *pxEnd )( EnergyHistory_t *, const HistoryPeriod_t * ) )
+{
+    TickType_t xStart = xTime - ( xTime % xPeriodTicks );
+    size_t xChannel;
+
+    if( ( pxPeriod->ulSamples > 0U ) && ( xStart != pxPeriod->xStart ) )
+    {
+        pxEnd( pxHistory, pxPeriod );
+        pxPeriod->ulSamples = 0;
+    }
+
+    if( pxPeriod->ulSamples == 0U )
+    {
+        pxPeriod->xStart = xStart;
+
+        for( xChannel = 0; xChannel < historyNUM_CHANNELS; xChannel++ )
+        {
+            pxPeriod->llSum[ xChannel ] = 0;
+            pxPeriod->lMin[ xChannel ] = plValues[ xChannel ];
+            pxPeriod->lMax[ xChannel ] = plValues[ xChannel ];
+        }
+    }
+
+    for( xChannel = 0; xChannel < historyNUM_CHANNELS; xChannel++ )
+    {
+        pxPeriod->llSum[ xChannel ] += plValues[ xChannel ];
+
+        if( plValues[ xChannel ] < pxPeriod->lMin[ xChannel ] )
+        {
+            pxPeriod->lMin[ xChannel ] = plValues[ xChannel ];
+        }
+
+        if( plValues[ xChannel ] > pxPeriod->lMax[ xChannel ] )
+        {
+            pxPeriod->lMax[ xChannel ] = plValues[ xChannel ];
+        }
+    }
+
+    pxPeriod->ulSamples++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvEndHour( EnergyHistory_t * pxHistory,
+                        const HistoryPeriod_t * pxPeriod )
+{
+    size_t xIndex = prvRingPush( &( pxHistory->xRing[ eHistoryHourly ] ) );
+    size_t xChannel;
+
+    pxHistory->xHourly[ xIndex ].xTime = pxPeriod->xStart;
+
+    for( xChannel = 0; xChannel < historyNUM_CHANNELS; xChannel++ )
+    {
+        pxHistory->xHourly[ xIndex ].lValue[ xChannel ] = ( int32_t ) ( pxPeriod->llSum[ xChannel ] / ( int64_t ) pxPeriod->ulSamples );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvEndDay( EnergyHistory_t * pxHistory,
+                       const HistoryPeriod_t * pxPeriod )
+{
+    size_t xIndex = prvRingPush( &( pxHistory->xRing[ eHistoryDaily ] ) );
+    HistoryRecord_t * pxRecord = &( pxHistory->xDaily[ xIndex ] );
+    size_t xChannel;
+
+    pxRecord->xTime = pxPeriod->xStart;
+
+    for( xChannel = 0; xChannel < historyNUM_CHANNELS; xChannel++ )
+    {
+        pxRecord->lMin[ xChannel ] = pxPeriod->lMin[ xChannel ];
+        pxRecord->lMax[ xChannel ] = pxPeriod->lMax[ xChannel ];
+        pxRecord->lMean[ xChannel ] = ( int32_t ) ( pxPeriod->llSum[ xChannel ] / ( int64_t ) pxPeriod->ulSamples );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvGetRecord( const EnergyHistory_t * pxHistory,
+                          eHistoryTier eTier,
+                          size_t xIndex,
+                          HistoryRecord_t * pxRecord )
+{
+    const HistoryRing_t * pxRing = &( pxHistory->xRing[ eTier ] );
+    const HistorySample_t * pxSample;
+    size_t xSlot = ( pxRing->xOldest + xIndex ) % pxRing->xSize;
+
+    if( eTier == eHistoryDaily )
+    {
+        *pxRecord = pxHistory->xDaily[ xSlot ];
+    }
+    else
+    {
+        pxSample = ( eTier == eHistoryRaw ) ? &( pxHistory->xRaw[ xSlot ] ) : &( pxHistory->xHourly[ xSlot ] );
+        pxRecord->xTime = pxSample->xTime;
+        memcpy( pxRecord->lMin, pxSample->lValue, sizeof( pxRecord->lMin ) );
+        memcpy( pxRecord->lMax, pxSample->lValue, sizeof( pxRecord->lMax ) );
+        memcpy( pxRecord->lMean, pxSample->lValue, sizeof( pxRecord->lMean ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvFirstSince( const EnergyHistory_t * pxHistory,
+                             eHistoryTier eTier,
+                             TickType_t xSince )
+{
+    const HistoryRing_t * pxRing = &( pxHistory->xRing[ eTier ] );
+    HistoryRecord_t xRecord;
+    size_t xLow = 0, xHigh = pxRing->xCount, xMiddle;
+
+    /* Records are in time order, so search for the first that is not older
+     * than xSince. */
+    while( xLow < xHigh )
+    {
+        xMiddle = xLow + ( ( xHigh - xLow ) / 2U );
+        prvGetRecord( pxHistory, eTier, xMiddle, &xRecord );
+
+        if( xRecord.xTime < xSince )
+        {
+            xLow = xMiddle + 1U;
+        }
+        else
+        {
+            xHigh = xMiddle;
+        }
+    }
+
+    return xLow;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,128 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef ENERGY_HISTORY_H
+#define ENERGY_HISTORY_H
+
+/*
+ * In memory history of the household: battery level, solar power, load and
+ * grid flow.  It is kept at three resolutions, each a fixed size ring that
+ * overwrites its oldest record once full:
+ *
+ *   raw     every sample, the last historyRAW_RECORDS of them
+ *   hourly  the mean of each hour, the last historyHOURLY_RECORDS hours
+ *   daily   the minimum, maximum and mean of each day, the last
+ *           historyDAILY_RECORDS days
+ *
+ * The store is allocated from the FreeRTOS heap once, by
+ * pxEnergyHistoryCreate(), and never grows.  With the default sizes it takes
+ * under 8K bytes of configTOTAL_HEAP_SIZE.
+ *
+ * Samples are added by one task.  Queries can be made from any task; they copy
+ * or summarise the records with the scheduler suspended, so they never see a
+ * half written record, take time in proportion to the records they look at,
+ * and allocate nothing.
+ */
+
+#ifndef historyRAW_RECORDS
+    #define historyRAW_RECORDS       ( 120U ) /* A day of 12 minute samples. */
+#endif
+
+#ifndef historyHOURLY_RECORDS
+    #define historyHOURLY_RECORDS    ( 168U ) /* A week. */
+#endif
+
+#ifndef historyDAILY_RECORDS
+    #define historyDAILY_RECORDS     ( 31U )
+#endif
+
+/* What is recorded. */
+typedef enum
+{
+    eHistoryBattery = 0, /* Energy in the battery, in W.h. */
+    eHistorySolar,       /* Solar power, in W. */
+    eHistoryLoad,        /* Load, in W. */
+    eHistoryGrid         /* Energy sold in the sample, negative if bought, in W.h. */
+} eHistoryChannel;
+
+#define historyNUM_CHANNELS          ( 4U )
+
+typedef enum
+{
+    eHistoryRaw = 0,
+    eHistoryHourly,
+    eHistoryDaily
+} eHistoryTier;
+
+/* A record as returned by a query.  Raw and hourly records have the same
+ * minimum, maximum and mean. */
+typedef struct HistoryRecord
+{
+    TickType_t xTime; /* When the sample was taken, or the hour or day started. */
+    int32_t lMin[ historyNUM_CHANNELS ];
+    int32_t lMax[ historyNUM_CHANNELS ];
+    int32_t lMean[ historyNUM_CHANNELS ];
+} HistoryRecord_t;
+
+typedef struct EnergyHistory EnergyHistory_t;
+
+/*
+ * Allocate an empty store, with hours of xHourTicks ticks and days of
+ * xDayTicks ticks.  Returns NULL if there is not enough heap.
+ */
+EnergyHistory_t * pxEnergyHistoryCreate( TickType_t xHourTicks,
+                                         TickType_t xDayTicks );
+
+/*
+ * Record the sample taken at xTime.  Samples must be added in time order from
+ * a single task.  An hour or day is written to its tier when the first sample
+ * of the next one arrives.
+ */
+void vEnergyHistoryAdd( EnergyHistory_t * pxHistory,
+                        TickType_t xTime,
+                        const int32_t plValues[ historyNUM_CHANNELS ] );
+
+/*
+ * Copy the records of a tier from xSince onwards, oldest first, into
+ * pxRecords, at most xMaxRecords of them.  If there are more, the newest are
+ * copied.  Returns the number copied.
+ */
+size_t xEnergyHistoryQuery( EnergyHistory_t * pxHistory,
+                            eHistoryTier eTier,
+                            TickType_t xSince,
+                            HistoryRecord_t * pxRecords,
+                            size_t xMaxRecords );
+
+/*
+ * Summarise the records of a tier from xSince onwards into one record, whose
+ * time is that of the oldest one.  Returns pdFALSE if there are none.
+ */
+BaseType_t xEnergyHistorySummarise( EnergyHistory_t * pxHistory,
+                                    eHistoryTier eTier,
+                                    TickType_t xSince,
+                                    HistoryRecord_t * pxSummary );
+
+#endif /* ENERGY_HISTORY_H */
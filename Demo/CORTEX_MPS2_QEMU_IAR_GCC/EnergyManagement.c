@@ -0,0 +1,1082 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*
+ * The household energy application, see EnergyManagement.h.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "EnergyConfig.h"
+#include "EnergyCurve.h"
+#include "Telemetry.h"
+#include "BatteryModel.h"
+#include "EnergyBus.h"
+#include "ApplianceRegistry.h"
+#include "LoadShedding.h"
+#include "EnergyProfile.h"
+#include "BatteryDispatch.h"
+#include "Tariff.h"
+#include "EnergyAccount.h"
+#include "EnergyHistory.h"
+#include "EnergyForecast.h"
+#include "LoopStats.h"
+#include "EnergyManagement.h"
+
+/* The number of samples that can wait for each subscriber at once. */
+#define POWER_QUEUE_LENGTH                   ( 2 )
+#define GRID_QUEUE_LENGTH                   ( 8 )
+
+/* Priorities at which the tasks are created. */
+#define SOLAR_GEN_TASK_PRIORITY    ( tskIDLE_PRIORITY + 1 )
+#define BATTERY_MGMT_TASK_PRIORITY  ( tskIDLE_PRIORITY + 2 )
+#define LOAD_MGMT_TASK_PRIORITY  ( tskIDLE_PRIORITY + 3 )
+#define GRID_INTERACT_TASK_PRIORITY  ( tskIDLE_PRIORITY + 4 )
+#define DISPATCH_TASK_PRIORITY  ( tskIDLE_PRIORITY + 1 )
+
+/* The rate at which the planner is given its budget.  The solar and load
+ * tasks sample at the household's period instead, which is set at run time,
+ * see EnergyManagementConfig_t.  The times are converted from milliseconds
+ * to ticks using the pdMS_TO_TICKS() macro. */
+#define TASK_DISPATCH_FREQUENCY_MS     pdMS_TO_TICKS( 200UL )
+
+/* The battery is planned an hour at a time, which is one second of run time,
+ * and the forecasts are kept for each hour of the day. */
+#define DISPATCH_SLOT_TICKS      pdMS_TO_TICKS( 1000UL )
+#define SLOTS_PER_DAY            ( 24U )
+#define DAY_TICKS                ( SLOTS_PER_DAY * DISPATCH_SLOT_TICKS )
+#define SLOT_OF(tick)            ( ( uint32_t ) ( (tick) / DISPATCH_SLOT_TICKS ) )
+
+/* Most relaxations the dispatch task does each period.  Each is a few integer
+ * operations, so this bounds its share of the CPU; a plan takes as many
+ * periods as it needs. */
+#define DISPATCH_BUDGET          ( 4096U )
+
+#if ( DISPATCH_BUDGET < dispatchMIN_BUDGET )
+    #error DISPATCH_BUDGET must be at least dispatchMIN_BUDGET, see BatteryDispatch.h
+#endif
+
+/* Solar power in W at a given tick.  The curve parameters are passed to pxEnergyManagementStart(). */
+#define SOLAR_POWER(household, tick) ( (TickType_t) lEnergyCurveEvaluate( &( (household)->xSolarPowerCurve ), (tick) ) )
+
+/* The sample of a recorded profile in effect at a tick.  A sample covers the
+ * ticks up to and including the one it is taken at, like a period. */
+#define PROFILE_SAMPLE(household, tick) ( ( (tick) > 0U ) ? ( uint32_t ) ( ( (tick) - 1U ) / (household)->xProfileTicks ) : 0U )
+
+/* Samples are turned into energy over the ticks since the one before without
+ * truncation by an EnergyIntegrator_t, which needs the length of a simulated
+ * hour in ticks. */
+#define TICKS_PER_HOUR   pdMS_TO_TICKS( 1000UL )
+
+/* Number of devices in the default list */
+#define NUM_DEVICES ( sizeof(xDefaultDevices) / sizeof(xDefaultDevices[0]) )
+
+/* Everything one household owns.  The tasks of the household are passed a
+ * pointer to it as their parameter. */
+struct EnergyHousehold
+{
+    /* Carries generated power to the battery task, and energy bought and sold
+     * to the grid task. */
+    EnergyBus_t xBus;
+    EnergyBusSubscriber_t xPowerSubscriber;
+    EnergyBusSubscriber_t xGridSubscriber;
+
+    /* Fixed-point curve used by SOLAR_POWER().  Set before the scheduler
+     * starts and only read after. */
+    EnergyCurve_t xSolarPowerCurve;
+
+    /* Compiled price tables.  Only the grid task settles transactions, the
+     * other tasks just read prices. */
+    Tariff_t xTariff;
+
+    /* Decoders for the recorded profile, if one is replayed, and the ticks
+     * between its samples.  The solar and load tasks each step their own
+     * through the same data, to the sample in effect when they run. */
+    BaseType_t xReplayProfile;
+    EnergyProfile_t xSolarProfile;
+    EnergyProfile_t xLoadProfile;
+    TickType_t xProfileTicks;
+
+    /* Ticks between samples, which can be changed while the tasks run, when
+     * the battery and load tasks last took a sample, and the period the
+     * battery model was last set up for. */
+    volatile TickType_t xPeriod;
+    TickType_t xLastSolarTime;
+    TickType_t xLastLoadTime;
+    TickType_t xModelPeriod;
+
+    /* Largest solar power reading the battery task accepts, in W. */
+    uint32_t ulMaxSolarPower;
+
+    /* The battery, with its losses and limits.  Charged by the battery task and
+     * discharged by the load task, see BatteryModel.h. */
+    BatteryModel_t xBattery;
+
+    /* Expenditure or profit with energy, and the energy generated, consumed,
+     * imported and exported, with daily and monthly settlements. */
+    EnergyAccount_t xAccount;
+
+    /* Turn the solar power seen by the battery task and the load seen by the
+     * load task into W.h without losing the fractions. */
+    EnergyIntegrator_t xSolarEnergy;
+    EnergyIntegrator_t xLoadEnergy;
+
+    /* Battery dispatch planner, and whether the battery task follows its plan. */
+    BatteryDispatch_t xDispatch;
+    BaseType_t xOptimisedDispatch;
+    uint32_t ulMaxPower;
+    TickType_t xLastPlanTime;
+
+    /* Inputs of the next plan, the mean solar power and load in W forecast
+     * for each hour of it, and the slot it was made for.  Only used by the
+     * dispatch task. */
+    BatteryDispatchInputs_t xInputs;
+    uint32_t ulSolarForecast[ dispatchHORIZON_SLOTS ];
+    uint32_t ulLoadForecast[ dispatchHORIZON_SLOTS ];
+    uint32_t ulPlannedSlot;
+
+    /* Forecasts of the solar power and load for each hour of the day,
+     * updated by the battery task with every sample, see EnergyForecast.h. */
+    EnergyForecast_t xSolarForecast;
+    EnergyForecast_t xLoadForecast;
+
+    /* The slot the battery task is following the plan through, the levels it
+     * moves between and whether the plan covers it. */
+    uint32_t ulFollowSlot;
+    uint32_t ulFollowStart;
+    uint32_t ulFollowTarget;
+    BaseType_t xHaveTarget;
+
+    /* Record of the household, added to by the battery task at the end of
+     * each sample, the load it last saw, written by the load task, and the
+     * energy sold less bought when it last recorded, in micro W.h. */
+    EnergyHistory_t * pxHistory;
+    volatile uint32_t ulLoadPower;
+    int64_t llLastTraded;
+
+    /* Registry of the devices in the household, which keeps the total load as they are switched */
+    ApplianceRegistry_t xAppliances;
+
+    /* Switches the least important devices off when energy is scarce or expensive */
+    LoadShedder_t xLoadShedder;
+
+    /* Whether this household emits the telemetry frames, and whether it has
+     * no tasks of its own but is stepped by vEnergyManagementStep(). */
+    BaseType_t xTelemetry;
+    BaseType_t xPooled;
+
+    /* Energy traded in the price slot ulNetSlot so far, sold less bought, in
+     * W.h, when the first of it was traded and whether there was any.  Settled
+     * as one transaction once the slot's trades are in.  Only used by the grid
+     * task, or the worker stepping a pooled household. */
+    int32_t lNetTrade;
+    uint32_t ulNetSlot;
+    TickType_t xNetTime;
+    BaseType_t xNetPending;
+    uint32_t ulTrades;
+    uint32_t ulSettlements;
+
+    /* The household's tasks, NULL for those it does not have, how long they
+     * run and how late they wake, and how long samples wait on its bus, see
+     * LoopStats.h. */
+    TaskHandle_t xTasks[ energyNUM_TASKS ];
+    LoopTaskStats_t xTaskStats[ energyNUM_TASKS ];
+    LoopHistogram_t xResidency[ busNUM_TOPICS ];
+};
+
+/* Tasks */
+void vTaskSolarPowerGeneration( void * pvParameters );
+void vTaskBatteryManagement( void * pvParameters );
+void vTaskLoadManagement( void * pvParameters );
+void vTaskGridInteraction( void * pvParameters );
+void vTaskBatteryDispatch( void * pvParameters );
+
+/* Create one of the household's tasks and start timing it. */
+static BaseType_t prvCreateTask( EnergyHousehold_t * pxHousehold,
+                                 EnergyLoopTask_t eTask,
+                                 TaskFunction_t pxTaskCode,
+                                 const char * pcName,
+                                 UBaseType_t uxPriority );
+
+/* Block a periodic task until its next wake time, and record how late it
+ * woke. */
+static void prvDelayUntil( EnergyHousehold_t * pxHousehold,
+                           EnergyLoopTask_t eTask,
+                           TickType_t * pxNextWakeTime,
+                           TickType_t xPeriod );
+
+/* One period of each part of the household, run by its tasks or, for a pooled
+ * household, in turn by vEnergyManagementStep().  prvSampleSolar() returns
+ * the solar power for the battery task, and prvStoreSolar() stores it and
+ * records the sample.  prvSampleLoad() runs the devices from the battery.
+ * prvPlanDispatch() gives the planner its share of the period. */
+static uint16_t prvSampleSolar( EnergyHousehold_t * pxHousehold,
+                                TickType_t xTime );
+static void prvStoreSolar( EnergyHousehold_t * pxHousehold,
+                           TickType_t xSampleTime,
+                           uint16_t usReceivedValue );
+static void prvSampleLoad( EnergyHousehold_t * pxHousehold,
+                           TickType_t xTime );
+static void prvPlanDispatch( EnergyHousehold_t * pxHousehold,
+                             TickType_t xNow );
+
+/* Energy lValue W.h was sold, or bought if negative, at xTime.  It is
+ * published for the grid task, or netted at once by prvNetTrade() for a
+ * pooled household.  prvNetTrade() adds it to the net of its price slot,
+ * settling the slot before if it is a later one, and prvSettle() settles
+ * the net of the slot. */
+static void prvTrade( EnergyHousehold_t * pxHousehold,
+                      TickType_t xTime,
+                      EnergySource_t eSource,
+                      int32_t lValue );
+static void prvNetTrade( EnergyHousehold_t * pxHousehold,
+                         TickType_t xTime,
+                         int32_t lValue );
+static void prvSettle( EnergyHousehold_t * pxHousehold );
+
+/* Settle the net of the price slot being netted if the next sample, at
+ * xNextSample, is in a later one, so everything traded in it is in. */
+static void prvSettleSlot( EnergyHousehold_t * pxHousehold,
+                           TickType_t xNextSample );
+
+/* Follow the dispatch plan for the slot holding xSampleTime: buy or sell so the
+ * battery moves steadily from its level at the start of the slot to the
+ * planned level at the end.  Called by the battery task once solar energy has
+ * been stored, with the ticks since the last sample. */
+static void prvFollowDispatch( EnergyHousehold_t * pxHousehold,
+                               TickType_t xSampleTime,
+                               TickType_t xElapsed,
+                               uint32_t ulLevel );
+
+/* List of devices registered at start up */
+static const Appliance xDefaultDevices[] = {
+
+    {"Lighting", 100, false, 1}, // 10 LEDs consuming 10W each
+    {"Refrigerator", 300, true, 1},
+    {"Wahsing Machine", 1000, false, shedDEFERRABLE_PRIORITY}
+};
+/*-----------------------------------------------------------*/
+
+void vEnergyManagementGetDefaultConfig( EnergyManagementConfig_t * pxConfig )
+{
+    const EnergyCurve_t xSolar = SOLAR_POWER_CURVE;
+    const EnergyCurve_t xPrice = ENERGY_PRICE_CURVE;
+    const EnergyCurve_t xExportPrice = EXPORT_PRICE_CURVE;
+    const BatteryModelParams_t xBatteryModel = BATTERY_MODEL;
+    const EnergyForecastParams_t xForecast = FORECAST_SMOOTHING;
+
+    pxConfig->ulCapacity = CAPACITY;
+    pxConfig->ulInitialBatteryLevel = INITIAL_BATTERY_LEVEL;
+    pxConfig->xSolarCurve = xSolar;
+    pxConfig->xTariff.xImportCurve = xPrice;
+    pxConfig->xTariff.xExportCurve = xExportPrice;
+    pxConfig->xTariff.pxPeriods = NULL;
+    pxConfig->xTariff.xNumPeriods = 0;
+    pxConfig->xTariff.pxTiers = NULL;
+    pxConfig->xTariff.xNumTiers = 0;
+    pxConfig->xTariff.ulDailyCharge = DAILY_CHARGE;
+    pxConfig->pxDevices = xDefaultDevices;
+    pxConfig->xNumDevices = NUM_DEVICES;
+    pxConfig->pucProfile = NULL;
+    pxConfig->xProfileLength = 0;
+    pxConfig->ulMaxPower = BATTERY_MAX_POWER;
+    pxConfig->xOptimisedDispatch = ( DISPATCH_OPTIMISED == 1 ) ? pdTRUE : pdFALSE;
+    pxConfig->xTelemetry = pdTRUE;
+    pxConfig->xPooled = pdFALSE;
+    pxConfig->xBatteryModel = xBatteryModel;
+    pxConfig->xForecast = xForecast;
+    pxConfig->xPeriod = pdMS_TO_TICKS( SAMPLE_PERIOD_MS );
+}
+/*-----------------------------------------------------------*/
+
+EnergyHousehold_t * pxEnergyManagementStart( const EnergyManagementConfig_t * pxConfig )
+{
+    EnergyHousehold_t * pxHousehold;
+    BaseType_t xReturn = pdFAIL;
+    BaseType_t xProfileValid = pdPASS;
+    uint32_t ulSolarInitial[ forecastSEASON_SLOTS ], ulLoadInitial[ forecastSEASON_SLOTS ];
+
+    configASSERT( pxConfig->ulInitialBatteryLevel <= pxConfig->ulCapacity );
+    configASSERT( pxConfig->xPeriod > 0U );
+
+    vLoopStatsInit();
+
+    /* A household lives as long as the application, so is never freed. */
+    pxHousehold = ( EnergyHousehold_t * ) pvPortMalloc( sizeof( EnergyHousehold_t ) );
+
+    if( pxHousehold != NULL )
+    {
+        memset( pxHousehold, 0x00, sizeof( EnergyHousehold_t ) );
+
+        pxHousehold->xSolarPowerCurve = pxConfig->xSolarCurve;
+        vTariffCompile( &( pxHousehold->xTariff ), &( pxConfig->xTariff ), DAY_TICKS );
+        vBatteryModelInit( &( pxHousehold->xBattery ), &( pxConfig->xBatteryModel ), pxConfig->ulCapacity,
+                           pxConfig->ulInitialBatteryLevel, pxConfig->xPeriod, TICKS_PER_HOUR );
+
+        /* The first samples are a period after start up. */
+        pxHousehold->xPeriod = pxConfig->xPeriod;
+        pxHousehold->xModelPeriod = pxConfig->xPeriod;
+        pxHousehold->xLastSolarTime = xTaskGetTickCount();
+        pxHousehold->xLastLoadTime = pxHousehold->xLastSolarTime;
+        pxHousehold->xLastPlanTime = pxHousehold->xLastSolarTime;
+        pxHousehold->ulMaxSolarPower = ( uint32_t ) ( pxConfig->xSolarCurve.lOffset + pxConfig->xSolarCurve.lAmplitude );
+        pxHousehold->xTelemetry = pxConfig->xTelemetry;
+        pxHousehold->xPooled = pxConfig->xPooled;
+
+        if( pxConfig->pucProfile != NULL )
+        {
+            pxHousehold->xReplayProfile = pdTRUE;
+            pxHousehold->ulMaxSolarPower = UINT16_MAX;
+
+            if( ( xEnergyProfileInit( &( pxHousehold->xSolarProfile ), pxConfig->pucProfile, pxConfig->xProfileLength ) != pdPASS ) ||
+                ( xEnergyProfileInit( &( pxHousehold->xLoadProfile ), pxConfig->pucProfile, pxConfig->xProfileLength ) != pdPASS ) )
+            {
+                xProfileValid = pdFAIL;
+            }
+
+            pxHousehold->xProfileTicks = ( TickType_t ) ( ( pxHousehold->xSolarProfile.usMinutes * TICKS_PER_HOUR ) / 60U );
+
+            if( pxHousehold->xProfileTicks == 0U )
+            {
+                xProfileValid = pdFAIL;
+            }
+        }
+
+        /* Subscribe the battery and grid tasks to the household's energy bus.
+         * A pooled household passes nothing between tasks. */
+        vEnergyBusInit( &( pxHousehold->xBus ) );
+
+        if( pxHousehold->xPooled == pdFALSE )
+        {
+            pxHousehold->xPowerSubscriber = xEnergyBusSubscribe( &( pxHousehold->xBus ), busTOPIC_GENERATION, POWER_QUEUE_LENGTH );
+            pxHousehold->xGridSubscriber = xEnergyBusSubscribe( &( pxHousehold->xBus ), busTOPIC_GRID, GRID_QUEUE_LENGTH );
+        }
+
+        /* Register the household's devices. */
+        vApplianceRegistryInit( &( pxHousehold->xAppliances ) );
+
+        for (size_t i=0; i < pxConfig->xNumDevices; i++){
+            usApplianceRegister( &( pxHousehold->xAppliances ), pxConfig->pxDevices[i].pcName, pxConfig->pxDevices[i].usPower,
+                                 pxConfig->pxDevices[i].ucPriority, pxConfig->pxDevices[i].bStatus );
+        }
+        vLoadShedderInit( &( pxHousehold->xLoadShedder ), &( pxHousehold->xAppliances ) );
+
+        /* Until a day has been seen, expect the solar curve and today's devices. */
+        for( uint32_t ulHour = 0; ulHour < forecastSEASON_SLOTS; ulHour++ )
+        {
+            ulSolarInitial[ ulHour ] = SOLAR_POWER( pxHousehold, ( ulHour * DISPATCH_SLOT_TICKS ) + ( DISPATCH_SLOT_TICKS / 2 ) );
+            ulLoadInitial[ ulHour ] = ulApplianceGetTotalLoad( &( pxHousehold->xAppliances ) );
+        }
+
+        vEnergyForecastInit( &( pxHousehold->xSolarForecast ), &( pxConfig->xForecast ), DISPATCH_SLOT_TICKS, ulSolarInitial );
+        vEnergyForecastInit( &( pxHousehold->xLoadForecast ), &( pxConfig->xForecast ), DISPATCH_SLOT_TICKS, ulLoadInitial );
+
+        pxHousehold->xOptimisedDispatch = pxConfig->xOptimisedDispatch;
+        pxHousehold->ulMaxPower = pxConfig->ulMaxPower;
+        pxHousehold->ulFollowSlot = UINT32_MAX;
+        pxHousehold->ulPlannedSlot = UINT32_MAX;
+        vBatteryDispatchInit( &( pxHousehold->xDispatch ), pxConfig->ulCapacity, pxConfig->ulMaxPower );
+
+        vEnergyAccountInit( &( pxHousehold->xAccount ), DAY_TICKS );
+        vEnergyIntegratorInit( &( pxHousehold->xSolarEnergy ), TICKS_PER_HOUR );
+        vEnergyIntegratorInit( &( pxHousehold->xLoadEnergy ), TICKS_PER_HOUR );
+
+        pxHousehold->pxHistory = pxEnergyHistoryCreate( TICKS_PER_HOUR, DAY_TICKS );
+
+        if( ( pxHousehold->pxHistory == NULL ) || ( xProfileValid != pdPASS ) )
+        {
+            xReturn = pdFAIL;
+        }
+        else if( pxHousehold->xPooled != pdFALSE )
+        {
+            xReturn = pdPASS;
+        }
+        else if( ( pxHousehold->xPowerSubscriber != NULL ) && ( pxHousehold->xGridSubscriber != NULL ) )
+        {
+            xReturn = prvCreateTask( pxHousehold, energyTASK_SOLAR, vTaskSolarPowerGeneration, "SolarGen", SOLAR_GEN_TASK_PRIORITY );
+
+            if( xReturn == pdPASS )
+            {
+                xReturn = prvCreateTask( pxHousehold, energyTASK_BATTERY, vTaskBatteryManagement, "BatteryMgmt", BATTERY_MGMT_TASK_PRIORITY );
+            }
+
+            if( xReturn == pdPASS )
+            {
+                xReturn = prvCreateTask( pxHousehold, energyTASK_LOAD, vTaskLoadManagement, "LoadMgmt", LOAD_MGMT_TASK_PRIORITY );
+            }
+
+            if( xReturn == pdPASS )
+            {
+                xReturn = prvCreateTask( pxHousehold, energyTASK_GRID, vTaskGridInteraction, "GridInteract", GRID_INTERACT_TASK_PRIORITY );
+            }
+
+            if( ( xReturn == pdPASS ) && ( pxHousehold->xOptimisedDispatch != pdFALSE ) )
+            {
+                xReturn = prvCreateTask( pxHousehold, energyTASK_DISPATCH, vTaskBatteryDispatch, "Dispatch", DISPATCH_TASK_PRIORITY );
+            }
+        }
+        else
+        {
+            /* A subscription could not be made. */
+        }
+    }
+
+    /* Whatever was allocated is not given back, as the application cannot
+     * run without the household. */
+    return ( xReturn == pdPASS ) ? pxHousehold : NULL;
+}
+/*-----------------------------------------------------------*/
+
+void vEnergyManagementGetTotals( const EnergyHousehold_t * pxHousehold,
+                                 EnergyManagementTotals_t * pxTotals )
+{
+    vEnergyAccountGetTotals( &( pxHousehold->xAccount ), &( pxTotals->xAccount ) );
+    pxTotals->ulBatteryLevel = ulBatteryModelGetLevel( &( pxHousehold->xBattery ) );
+    vBatteryModelGetStats( &( pxHousehold->xBattery ), &( pxTotals->xBattery ) );
+    pxTotals->ulPlans = pxHousehold->xDispatch.ulSolves;
+    pxTotals->ulTrades = pxHousehold->ulTrades;
+    pxTotals->ulSettlements = pxHousehold->ulSettlements;
+    pxTotals->ulSolarForecastError = ulEnergyForecastGetError( &( pxHousehold->xSolarForecast ) );
+    pxTotals->ulLoadForecastError = ulEnergyForecastGetError( &( pxHousehold->xLoadForecast ) );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xEnergyManagementGetSettlement( const EnergyHousehold_t * pxHousehold,
+                                           eAccountPeriod ePeriod,
+                                           EnergyAccountSettlement_t * pxSettlement )
+{
+    return xEnergyAccountGetSettlement( &( pxHousehold->xAccount ), ePeriod, pxSettlement );
+}
+/*-----------------------------------------------------------*/
+
+EnergyHistory_t * pxEnergyManagementGetHistory( const EnergyHousehold_t * pxHousehold )
+{
+    return pxHousehold->pxHistory;
+}
+/*-----------------------------------------------------------*/
+
+TickType_t xEnergyManagementGetPeriod( const EnergyHousehold_t * pxHousehold )
+{
+    return pxHousehold->xPeriod;
+}
+/*-----------------------------------------------------------*/
+
+void vEnergyManagementSetPeriod( EnergyHousehold_t * pxHousehold,
+                                 TickType_t xPeriod )
+{
+    configASSERT( xPeriod > 0U );
+
+    pxHousehold->xPeriod = xPeriod;
+}
+/*-----------------------------------------------------------*/
+
+TickType_t xEnergyManagementGetHourTicks( void )
+{
+    return TICKS_PER_HOUR;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xEnergyManagementGetLoopStats( const EnergyHousehold_t * pxHousehold,
+                                          EnergyLoopTask_t eTask,
+                                          LoopTaskStats_t * pxStats )
+{
+    BaseType_t xReturn = pdFALSE;
+
+    configASSERT( eTask < energyNUM_TASKS );
+
+    if( pxHousehold->xTasks[ eTask ] != NULL )
+    {
+        vLoopStatsGetTask( &( pxHousehold->xTaskStats[ eTask ] ), pxStats );
+        xReturn = pdTRUE;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vEnergyManagementGetResidency( const EnergyHousehold_t * pxHousehold,
+                                    EnergyTopic_t eTopic,
+                                    LoopHistogram_t * pxHistogram )
+{
+    configASSERT( eTopic < busNUM_TOPICS );
+
+    vLoopStatsGetHistogram( &( pxHousehold->xResidency[ eTopic ] ), pxHistogram );
+}
+/*-----------------------------------------------------------*/
+
+void vEnergyManagementStep( EnergyHousehold_t * pxHousehold,
+                            TickType_t xTime )
+{
+    uint16_t usSolarPower;
+
+    configASSERT( pxHousehold->xPooled != pdFALSE );
+
+    /* The same order the tasks run in, by priority, when they wake together:
+     * the load first, then the solar sample stored by the battery task, and
+     * the planner last. */
+    prvSampleLoad( pxHousehold, xTime );
+    usSolarPower = prvSampleSolar( pxHousehold, xTime );
+    prvStoreSolar( pxHousehold, xTime, usSolarPower );
+
+    /* The planner keeps to its own pace whatever the period, as the dispatch
+     * task would, so gets a budget for each of its periods since the last. */
+    while( ( xTime - pxHousehold->xLastPlanTime ) >= TASK_DISPATCH_FREQUENCY_MS )
+    {
+        pxHousehold->xLastPlanTime += TASK_DISPATCH_FREQUENCY_MS;
+
+        if( pxHousehold->xOptimisedDispatch != pdFALSE )
+        {
+            prvPlanDispatch( pxHousehold, pxHousehold->xLastPlanTime );
+        }
+    }
+
+    prvSettleSlot( pxHousehold, xTime + pxHousehold->xPeriod );
+}
+/*-----------------------------------------------------------*/
+
+void vTaskSolarPowerGeneration( void * pvParameters )
+{
+    EnergyHousehold_t * const pxHousehold = ( EnergyHousehold_t * ) pvParameters;
+    TickType_t xNextWakeTime;
+
+    /* Initialise xNextWakeTime - this only needs to be done once. */
+    xNextWakeTime = xTaskGetTickCount();
+
+    for( ; ; )
+    {
+        /* Place this task in the blocked state until it is time to run again.
+         * The period is read each time, so a change takes effect from the
+         * next sample without drifting. */
+        prvDelayUntil( pxHousehold, energyTASK_SOLAR, &xNextWakeTime, pxHousehold->xPeriod );
+
+        uint16_t usValueToSend = prvSampleSolar( pxHousehold, xNextWakeTime );
+
+        /* Publish on the bus - causing the battery task to unblock and
+         * charge the battery.  Publishing never blocks - it shouldn't need to
+         * as the subscriber should always have at least one space at this point in the code. */
+        xEnergyBusPublish( &( pxHousehold->xBus ), busTOPIC_GENERATION, busSOURCE_SOLAR_ARRAY, xNextWakeTime, usValueToSend );
+    }   
+}
+/*-----------------------------------------------------------*/
+
+void vTaskBatteryManagement( void * pvParameters )
+{
+    EnergyHousehold_t * const pxHousehold = ( EnergyHousehold_t * ) pvParameters;
+    const EnergySample_t * pxSample;
+
+    for( ; ; )
+    {
+        /* Wait until a sample is published - this task will block
+         * indefinitely provided INCLUDE_vTaskSuspend is set to 1 in
+         * FreeRTOSConfig.h. */
+        pxSample = pxEnergyBusReceive( pxHousehold->xPowerSubscriber, portMAX_DELAY );
+
+        if( pxSample == NULL )
+        {
+            continue;
+        }
+
+        vLoopStatsAddSince( &( pxHousehold->xResidency[ busTOPIC_GENERATION ] ), pxSample->ulPublished );
+
+        uint16_t usReceivedValue = ( uint16_t ) pxSample->lValue;
+        TickType_t xSampleTime = pxSample->xTimestamp;
+        vEnergyBusRelease( &( pxHousehold->xBus ), pxSample );
+
+        prvStoreSolar( pxHousehold, xSampleTime, usReceivedValue );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vTaskLoadManagement( void * pvParameters )
+{
+    EnergyHousehold_t * const pxHousehold = ( EnergyHousehold_t * ) pvParameters;
+    TickType_t xNextWakeTime;
+
+    /* Initialise xNextWakeTime - this only needs to be done once. */
+    xNextWakeTime = xTaskGetTickCount();
+
+    for( ; ; )
+    {
+        /* Place this task in the blocked state until it is time to run again */
+        prvDelayUntil( pxHousehold, energyTASK_LOAD, &xNextWakeTime, pxHousehold->xPeriod );
+
+        prvSampleLoad( pxHousehold, xNextWakeTime );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vTaskGridInteraction( void * pvParameters )
+{
+    EnergyHousehold_t * const pxHousehold = ( EnergyHousehold_t * ) pvParameters;
+    const EnergySample_t * pxSample;
+    TickType_t xNextWakeTime, xPeriod;
+
+    /* Run half way between samples, once everything traded at the last one
+     * has been published. */
+    vTaskDelay( pxHousehold->xPeriod / 2 );
+    xNextWakeTime = xTaskGetTickCount();
+
+    for( ; ; )
+    {
+        xPeriod = pxHousehold->xPeriod;
+        prvDelayUntil( pxHousehold, energyTASK_GRID, &xNextWakeTime, xPeriod );
+
+        /* Take everything bought and sold since the last time, netting the
+         * energy traded in each price slot, and settle the slot once the
+         * next sample is in a later one. */
+        while( ( pxSample = pxEnergyBusReceive( pxHousehold->xGridSubscriber, 0 ) ) != NULL )
+        {
+            vLoopStatsAddSince( &( pxHousehold->xResidency[ busTOPIC_GRID ] ), pxSample->ulPublished );
+            prvNetTrade( pxHousehold, pxSample->xTimestamp, pxSample->lValue );
+            vEnergyBusRelease( &( pxHousehold->xBus ), pxSample );
+        }
+
+        prvSettleSlot( pxHousehold, xNextWakeTime + ( xPeriod - ( xPeriod / 2 ) ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vTaskBatteryDispatch( void * pvParameters )
+{
+    EnergyHousehold_t * const pxHousehold = ( EnergyHousehold_t * ) pvParameters;
+    TickType_t xNextWakeTime;
+    const TickType_t xBlockTime = TASK_DISPATCH_FREQUENCY_MS;
+
+    /* Initialise xNextWakeTime - this only needs to be done once. */
+    xNextWakeTime = xTaskGetTickCount();
+
+    for( ; ; )
+    {
+        /* Place this task in the blocked state until it is time to run again */
+        prvDelayUntil( pxHousehold, energyTASK_DISPATCH, &xNextWakeTime, xBlockTime );
+
+        prvPlanDispatch( pxHousehold, xNextWakeTime );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCreateTask( EnergyHousehold_t * pxHousehold,
+                                 EnergyLoopTask_t eTask,
+                                 TaskFunction_t pxTaskCode,
+                                 const char * pcName,
+                                 UBaseType_t uxPriority )
+{
+    static const configSTACK_DEPTH_TYPE uxStackSizes[ energyNUM_TASKS ] =
+    {
+        energySOLAR_STACK_SIZE,
+        energyBATTERY_STACK_SIZE,
+        energyLOAD_STACK_SIZE,
+        energyGRID_STACK_SIZE,
+        energyDISPATCH_STACK_SIZE
+    };
+    BaseType_t xReturn;
+
+    xReturn = xTaskCreate( pxTaskCode,                         /* The function that implements the task. */
+                           pcName,                             /* The text name assigned to the task - for debug only as it is not used by the kernel. */
+                           uxStackSizes[ eTask ],              /* The size of the stack to allocate to the task. */
+                           pxHousehold,                        /* The parameter passed to the task - the household it belongs to. */
+                           uxPriority,                         /* The priority assigned to the task. */
+                           &( pxHousehold->xTasks[ eTask ] ) ); /* Kept to time the task. */
+
+    if( xReturn == pdPASS )
+    {
+        vLoopStatsRegisterTask( pxHousehold->xTasks[ eTask ], &( pxHousehold->xTaskStats[ eTask ] ) );
+    }
+    else
+    {
+        pxHousehold->xTasks[ eTask ] = NULL;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvDelayUntil( EnergyHousehold_t * pxHousehold,
+                           EnergyLoopTask_t eTask,
+                           TickType_t * pxNextWakeTime,
+                           TickType_t xPeriod )
+{
+    BaseType_t xWasDelayed;
+
+    xWasDelayed = xTaskDelayUntil( pxNextWakeTime, xPeriod );
+    vLoopStatsDelayed( &( pxHousehold->xTaskStats[ eTask ] ), xWasDelayed, *pxNextWakeTime );
+}
+/*-----------------------------------------------------------*/
+
+static uint16_t prvSampleSolar( EnergyHousehold_t * pxHousehold,
+                                TickType_t xTime )
+{
+    /* Calculate the Solar Power delivered to the cell in this time, or
+     * read it from the recorded profile */
+    uint32_t ulSolarPower = SOLAR_POWER( pxHousehold, xTime );
+
+    if( pxHousehold->xReplayProfile != pdFALSE )
+    {
+        uint32_t ulUnused;
+        vEnergyProfileSeek( &( pxHousehold->xSolarProfile ), PROFILE_SAMPLE( pxHousehold, xTime ), &ulSolarPower, &ulUnused );
+    }
+
+    uint16_t usValueToSend = ( ulSolarPower > UINT16_MAX ) ? UINT16_MAX : ( uint16_t ) ulSolarPower;
+
+    if( pxHousehold->xTelemetry != pdFALSE )
+    {
+        vTelemetrySetSolarPower( usValueToSend );
+    }
+
+    return usValueToSend;
+}
+/*-----------------------------------------------------------*/
+
+static void prvStoreSolar( EnergyHousehold_t * pxHousehold,
+                           TickType_t xSampleTime,
+                           uint16_t usReceivedValue )
+{
+    EnergyAccountTotals_t xTotals;
+    int64_t llTraded;
+    int32_t lRecord[ historyNUM_CHANNELS ];
+    const TickType_t xElapsed = xSampleTime - pxHousehold->xLastSolarTime;
+
+    /* The sample stands for the ticks since the last one, and the battery's
+     * limits for each period follow its length. */
+    pxHousehold->xLastSolarTime = xSampleTime;
+
+    if( xElapsed != pxHousehold->xModelPeriod )
+    {
+        vBatteryModelSetPeriod( &( pxHousehold->xBattery ), xElapsed, TICKS_PER_HOUR );
+        pxHousehold->xModelPeriod = xElapsed;
+    }
+
+    /*  Check if received value is an expected value, and charge the battery with it.
+     * Whatever does not fit in the battery is sold */
+    uint32_t ulLocalBatteryLevel = ulBatteryModelGetLevel( &( pxHousehold->xBattery ) );
+    uint32_t ulOverflow = 0;
+    uint64_t ullMicroWh;
+
+    if( usReceivedValue <= pxHousehold->ulMaxSolarPower )
+    {
+        uint32_t ulEnergy = ulEnergyIntegrate( &( pxHousehold->xSolarEnergy ), usReceivedValue, xElapsed, &ullMicroWh );
+        ulLocalBatteryLevel = ulBatteryModelCharge( &( pxHousehold->xBattery ), ulEnergy, &ulOverflow );
+        vEnergyAccountAddEnergy( &( pxHousehold->xAccount ), eEnergyGenerated, ullMicroWh );
+        vEnergyAccountAddEnergy( &( pxHousehold->xAccount ), eEnergyExported, ( uint64_t ) ulOverflow * accountMICRO );
+        vEnergyAccountAddEnergy( &( pxHousehold->xAccount ), eEnergySolarExported, ( uint64_t ) ulOverflow * accountMICRO );
+
+        if( ulOverflow > 0 )
+        {
+            // Signal to the Grid Interaction Task we are selling solar energy
+            prvTrade( pxHousehold, xSampleTime, busSOURCE_SOLAR_ARRAY, ( int32_t ) ulOverflow );
+        }
+
+        if( pxHousehold->xOptimisedDispatch != pdFALSE )
+        {
+            prvFollowDispatch( pxHousehold, xSampleTime, xElapsed, ulLocalBatteryLevel );
+        }
+    }
+    else
+    {
+        printf( "Unexpected message\r\n" );
+    }
+
+    /* Nothing else goes in or out of the battery this period. */
+    vBatteryModelUpdate( &( pxHousehold->xBattery ) );
+    ulLocalBatteryLevel = ulBatteryModelGetLevel( &( pxHousehold->xBattery ) );
+
+    /* Report the battery level returned by the update made by this task.
+     * This is the last step of each sample, so the snapshot of the household is sent from here. */
+    if( pxHousehold->xTelemetry != pdFALSE )
+    {
+        vTelemetrySetBatteryLevel( ( int32_t ) ulLocalBatteryLevel );
+        vTelemetryEmit( xTaskGetTickCount() );
+    }
+
+    /* Settle the day, and the month, once the first sample of the next arrives. */
+    vEnergyAccountUpdate( &( pxHousehold->xAccount ), xSampleTime );
+
+    /* Record the sample.  The load has been sampled for this period already,
+     * so its load and trades are included. */
+    vEnergyAccountGetTotals( &( pxHousehold->xAccount ), &xTotals );
+    llTraded = ( int64_t ) ( xTotals.ullEnergy[ eEnergyExported ] - xTotals.ullEnergy[ eEnergyImported ] );
+    lRecord[ eHistoryBattery ] = ( int32_t ) ulLocalBatteryLevel;
+    lRecord[ eHistorySolar ] = ( int32_t ) usReceivedValue;
+    lRecord[ eHistoryLoad ] = ( int32_t ) pxHousehold->ulLoadPower;
+    lRecord[ eHistoryGrid ] = ( int32_t ) ( ( llTraded - pxHousehold->llLastTraded ) / accountMICRO );
+    pxHousehold->llLastTraded = llTraded;
+    vEnergyHistoryAdd( pxHousehold->pxHistory, xSampleTime, lRecord );
+    vEnergyForecastAdd( &( pxHousehold->xSolarForecast ), xSampleTime, usReceivedValue );
+    vEnergyForecastAdd( &( pxHousehold->xLoadForecast ), xSampleTime, pxHousehold->ulLoadPower );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSampleLoad( EnergyHousehold_t * pxHousehold,
+                           TickType_t xTime )
+{
+    const TickType_t xElapsed = xTime - pxHousehold->xLastLoadTime;
+
+    /* The solar curve is known ahead of time, so its value for the next
+     * period stands in as the forecast.  A recorded profile gives this
+     * period's solar power along with the measured base load. */
+    uint32_t ulForecastSolar = SOLAR_POWER( pxHousehold, xTime + pxHousehold->xPeriod );
+    uint32_t ulBaseLoad = 0;
+
+    pxHousehold->xLastLoadTime = xTime;
+
+    if( pxHousehold->xReplayProfile != pdFALSE )
+    {
+        vEnergyProfileSeek( &( pxHousehold->xLoadProfile ), PROFILE_SAMPLE( pxHousehold, xTime ), &ulForecastSolar, &ulBaseLoad );
+    }
+
+    /* Decide which devices may run this period, with whatever solar power
+     * the base load leaves over. */
+    vLoadShedderUpdate( &( pxHousehold->xLoadShedder ),
+                        ulBatteryModelGetLevel( &( pxHousehold->xBattery ) ), ulBatteryModelGetCapacity( &( pxHousehold->xBattery ) ),
+                        ( ulForecastSolar > ulBaseLoad ) ? ( ulForecastSolar - ulBaseLoad ) : 0,
+                        lTariffImportPrice( &( pxHousehold->xTariff ), xTime ) );
+
+    /* Read the total power consumption of the devices that are active, which the registry keeps up to date as they switch.*/
+    uint32_t ulConsumedPower = ulApplianceGetTotalLoad( &( pxHousehold->xAppliances ) ) + ulBaseLoad;
+
+    uint64_t ullMicroWh;
+    uint32_t ulEnergy = ulEnergyIntegrate( &( pxHousehold->xLoadEnergy ), ulConsumedPower, xElapsed, &ullMicroWh );
+
+    if( pxHousehold->xTelemetry != pdFALSE )
+    {
+        vTelemetrySetLoadPower( ulConsumedPower );
+    }
+
+    pxHousehold->ulLoadPower = ulConsumedPower;
+    
+    /*  Take the energy from the battery, and buy whatever it cannot supply */
+    uint32_t ulShortfall = 0;
+    ( void ) ulBatteryModelDischarge( &( pxHousehold->xBattery ), ulEnergy, &ulShortfall );
+    vEnergyAccountAddEnergy( &( pxHousehold->xAccount ), eEnergyConsumed, ullMicroWh );
+    vEnergyAccountAddEnergy( &( pxHousehold->xAccount ), eEnergyImported, ( uint64_t ) ulShortfall * accountMICRO );
+
+    if( ulShortfall > 0 )
+    {
+        // Signal to the Grid Interaction Task we are buying energy
+        prvTrade( pxHousehold, xTime, busSOURCE_LOAD, -( int32_t ) ulShortfall );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvTrade( EnergyHousehold_t * pxHousehold,
+                      TickType_t xTime,
+                      EnergySource_t eSource,
+                      int32_t lValue )
+{
+    if( pxHousehold->xPooled != pdFALSE )
+    {
+        prvNetTrade( pxHousehold, xTime, lValue );
+    }
+    else
+    {
+        xEnergyBusPublish( &( pxHousehold->xBus ), busTOPIC_GRID, eSource, xTime, lValue );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvNetTrade( EnergyHousehold_t * pxHousehold,
+                         TickType_t xTime,
+                         int32_t lValue )
+{
+    uint32_t ulSlot = ulTariffGetSlot( &( pxHousehold->xTariff ), xTime );
+
+    if( ( pxHousehold->xNetPending != pdFALSE ) && ( ulSlot != pxHousehold->ulNetSlot ) )
+    {
+        prvSettle( pxHousehold );
+    }
+
+    if( pxHousehold->xNetPending == pdFALSE )
+    {
+        pxHousehold->ulNetSlot = ulSlot;
+        pxHousehold->xNetTime = xTime;
+        pxHousehold->xNetPending = pdTRUE;
+    }
+
+    pxHousehold->lNetTrade += lValue;
+    pxHousehold->ulTrades++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSettle( EnergyHousehold_t * pxHousehold )
+{
+    EnergyAccountTotals_t xTotals;
+
+    if( pxHousehold->xNetPending != pdFALSE )
+    {
+        /* Add to the bill, at the price when the energy was traded rather
+         * than when this task ran.  Energy bought and sold in the same slot
+         * cancels, as on the meter.  A net of nothing is still settled, so
+         * any fixed charge of the day is made on time. */
+        vEnergyAccountAddBill( &( pxHousehold->xAccount ),
+                               ( int64_t ) lTariffSettle( &( pxHousehold->xTariff ), pxHousehold->xNetTime, pxHousehold->lNetTrade ) * accountMICRO_PER_MILI );
+        pxHousehold->lNetTrade = 0;
+        pxHousehold->xNetPending = pdFALSE;
+        pxHousehold->ulSettlements++;
+
+        /* Telemetry carries the bill in miliCents. */
+        if( pxHousehold->xTelemetry != pdFALSE )
+        {
+            vEnergyAccountGetTotals( &( pxHousehold->xAccount ), &xTotals );
+            vTelemetrySetBill( xTotals.llBill / accountMICRO_PER_MILI );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSettleSlot( EnergyHousehold_t * pxHousehold,
+                           TickType_t xNextSample )
+{
+    if( ( pxHousehold->xNetPending != pdFALSE ) &&
+        ( ulTariffGetSlot( &( pxHousehold->xTariff ), xNextSample ) != pxHousehold->ulNetSlot ) )
+    {
+        prvSettle( pxHousehold );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvPlanDispatch( EnergyHousehold_t * pxHousehold,
+                             TickType_t xNow )
+{
+    BatteryDispatchInputs_t * const pxInputs = &( pxHousehold->xInputs );
+    const TickType_t xPriceTicks = pxHousehold->xTariff.xSlotTicks;
+    uint32_t ulSlot, ulPrices;
+    TickType_t xTime, xStart;
+
+    /* Once the last plan is done, start a new one from the current slot
+     * with the latest forecasts and the mean prices of each hour.  A slot
+     * is an hour, so its mean power in W is also its energy in W.h. */
+    ulSlot = SLOT_OF( xNow );
+
+    if( ( xBatteryDispatchIsSolving( &( pxHousehold->xDispatch ) ) == pdFALSE ) && ( ulSlot != pxHousehold->ulPlannedSlot ) )
+    {
+        vEnergyForecastGet( &( pxHousehold->xSolarForecast ), ulSlot, pxHousehold->ulSolarForecast, dispatchHORIZON_SLOTS );
+        vEnergyForecastGet( &( pxHousehold->xLoadForecast ), ulSlot, pxHousehold->ulLoadForecast, dispatchHORIZON_SLOTS );
+
+        for( uint32_t ulRow = 0; ulRow < dispatchHORIZON_SLOTS; ulRow++ )
+        {
+            pxInputs->lNet[ ulRow ] = ( int32_t ) pxHousehold->ulSolarForecast[ ulRow ] - ( int32_t ) pxHousehold->ulLoadForecast[ ulRow ];
+            pxInputs->lImport[ ulRow ] = 0;
+            pxInputs->lExport[ ulRow ] = 0;
+
+            /* The mean of the prices of the tariff's slots in the hour. */
+            xStart = ( TickType_t ) ( ulSlot + ulRow ) * DISPATCH_SLOT_TICKS;
+            ulPrices = 0;
+
+            for( xTime = xStart; xTime < ( xStart + DISPATCH_SLOT_TICKS ); xTime += xPriceTicks )
+            {
+                pxInputs->lImport[ ulRow ] += lTariffImportPrice( &( pxHousehold->xTariff ), xTime );
+                pxInputs->lExport[ ulRow ] += lTariffExportPrice( &( pxHousehold->xTariff ), xTime );
+                ulPrices++;
+            }
+
+            pxInputs->lImport[ ulRow ] /= ( int32_t ) ulPrices;
+            pxInputs->lExport[ ulRow ] /= ( int32_t ) ulPrices;
+        }
+
+        vBatteryDispatchStartSolve( &( pxHousehold->xDispatch ), ulSlot, pxInputs );
+        pxHousehold->ulPlannedSlot = ulSlot;
+    }
+
+    ( void ) xBatteryDispatchStep( &( pxHousehold->xDispatch ), DISPATCH_BUDGET );
+}
+/*-----------------------------------------------------------*/
+
+static void prvFollowDispatch( EnergyHousehold_t * pxHousehold,
+                               TickType_t xSampleTime,
+                               TickType_t xElapsed,
+                               uint32_t ulLevel )
+{
+    int32_t lWanted, lDeadband, lStart, lTarget;
+    uint32_t ulTraded, ulUnused, ulMaxEnergy;
+    TickType_t xIntoSlot;
+
+    /* Look the target up once per slot, from where the battery starts it. */
+    if( SLOT_OF( xSampleTime ) != pxHousehold->ulFollowSlot )
+    {
+        pxHousehold->ulFollowSlot = SLOT_OF( xSampleTime );
+        pxHousehold->ulFollowStart = ulLevel;
+        pxHousehold->xHaveTarget = xBatteryDispatchGetTarget( &( pxHousehold->xDispatch ), pxHousehold->ulFollowSlot,
+                                                              ulLevel, &( pxHousehold->ulFollowTarget ) );
+    }
+
+    if( pxHousehold->xHaveTarget != pdFALSE )
+    {
+        /* Where the battery should be at the end of this period, and the
+         * most that can be traded over the ticks it stands for. */
+        xIntoSlot = ( xSampleTime % DISPATCH_SLOT_TICKS ) + pxHousehold->xPeriod;
+        xIntoSlot = ( xIntoSlot > DISPATCH_SLOT_TICKS ) ? DISPATCH_SLOT_TICKS : xIntoSlot;
+        lStart = ( int32_t ) pxHousehold->ulFollowStart;
+        lTarget = ( int32_t ) pxHousehold->ulFollowTarget;
+        lWanted = lStart + ( int32_t ) ( ( ( int64_t ) ( lTarget - lStart ) * ( int64_t ) xIntoSlot ) / ( int64_t ) DISPATCH_SLOT_TICKS );
+        ulMaxEnergy = ( uint32_t ) ( ( ( uint64_t ) pxHousehold->ulMaxPower * xElapsed ) / TICKS_PER_HOUR );
+
+        /* The plan only knows the level to the nearest step, so leave drifts
+         * smaller than half a step to the solar and load tasks rather than
+         * trading to correct them. */
+        lDeadband = ( int32_t ) ( ulBatteryDispatchGetResolution( &( pxHousehold->xDispatch ) ) / 2U );
+
+        if( ( int32_t ) ulLevel > ( lWanted + lDeadband ) )
+        {
+            ulTraded = ( uint32_t ) ( ( int32_t ) ulLevel - ( lWanted + lDeadband ) );
+            ulTraded = ( ulTraded > ulMaxEnergy ) ? ulMaxEnergy : ulTraded;
+            ( void ) ulBatteryModelDischarge( &( pxHousehold->xBattery ), ulTraded, &ulUnused );
+            ulTraded -= ulUnused;
+            vEnergyAccountAddEnergy( &( pxHousehold->xAccount ), eEnergyExported, ( uint64_t ) ulTraded * accountMICRO );
+
+            if( ulTraded > 0 )
+            {
+                // Signal to the Grid Interaction Task we are selling stored energy
+                prvTrade( pxHousehold, xSampleTime, busSOURCE_BATTERY, ( int32_t ) ulTraded );
+            }
+        }
+        else if( ( int32_t ) ulLevel < ( lWanted - lDeadband ) )
+        {
+            ulTraded = ( uint32_t ) ( ( lWanted - lDeadband ) - ( int32_t ) ulLevel );
+            ulTraded = ( ulTraded > ulMaxEnergy ) ? ulMaxEnergy : ulTraded;
+            ( void ) ulBatteryModelCharge( &( pxHousehold->xBattery ), ulTraded, &ulUnused );
+            ulTraded -= ulUnused;
+            vEnergyAccountAddEnergy( &( pxHousehold->xAccount ), eEnergyImported, ( uint64_t ) ulTraded * accountMICRO );
+
+            if( ulTraded > 0 )
+            {
+                // Signal to the Grid Interaction Task we are buying energy to store
+                prvTrade( pxHousehold, xSampleTime, busSOURCE_BATTERY, -( int32_t ) ulTraded );
+            }
+        }
+        else
+        {
+            /* On track. */
+        }
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,212 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef ENERGY_MANAGEMENT_H
+#define ENERGY_MANAGEMENT_H
+
+/*
+ * The household energy application: solar generation, battery, load and grid
+ * tasks exchanging samples over the energy bus.  Solar power follows the
+ * configured curve, or a recorded profile which also adds a measured base
+ * load to the load of the registered devices.  Optionally a dispatch task
+ * plans the battery against the price curve and the battery task buys or sells
+ * to follow the plan.  The application does not touch the hardware, so the
+ * same code runs on the MPS2 target and in the Posix host build.
+ *
+ * Everything a household owns, including its bus and its tasks, is kept in
+ * an EnergyHousehold_t, so one image can simulate as many households as the
+ * heap holds by starting each in turn.  EnergyCommunity.h adds them up.
+ */
+
+#include "EnergyCurve.h"
+#include "ApplianceRegistry.h"
+#include "EnergyProfile.h"
+#include "Tariff.h"
+#include "EnergyAccount.h"
+#include "EnergyHistory.h"
+#include "BatteryModel.h"
+#include "EnergyForecast.h"
+#include "EnergyBus.h"
+#include "LoopStats.h"
+
+/* Parameters of the simulated household. */
+typedef struct EnergyManagementConfig
+{
+    uint32_t ulCapacity;            /* Battery capacity in W.h. */
+    uint32_t ulInitialBatteryLevel; /* Energy in the battery at start up, in W.h. */
+    BatteryModelParams_t xBatteryModel; /* Losses, limits and wear of the battery, see BatteryModel.h. */
+    EnergyCurve_t xSolarCurve;      /* Solar power in W.  Must not exceed UINT16_MAX. */
+    TariffDefinition_t xTariff;     /* Prices of energy bought and sold, see Tariff.h. */
+    const Appliance * pxDevices;    /* Devices registered at start up. */
+    size_t xNumDevices;
+    const uint8_t * pucProfile;     /* Recorded profile to replay, see EnergyProfile.h, or NULL. */
+    size_t xProfileLength;
+    uint32_t ulMaxPower;            /* Most power the battery trades with the grid, in W. */
+    BaseType_t xOptimisedDispatch;  /* pdTRUE to follow the plan made by BatteryDispatch.c. */
+    EnergyForecastParams_t xForecast; /* Smoothing of the solar and load forecasts the plan is
+                                       * made from, see EnergyForecast.h. */
+    BaseType_t xTelemetry;          /* pdTRUE to emit the telemetry frames, see Telemetry.h.  Only
+                                     * one household may, as a frame describes a single household. */
+    BaseType_t xPooled;             /* pdTRUE to create no tasks for the household, which is then
+                                     * stepped by vEnergyManagementStep(), see EnergyPool.h. */
+    TickType_t xPeriod;             /* Ticks between the samples the solar and load tasks take. */
+} EnergyManagementConfig_t;
+
+/* Stack of each of the tasks of a household, in words.  Run
+ * tools/stack_usage.py for sizes based on what the tasks use. */
+#ifndef energySOLAR_STACK_SIZE
+    #define energySOLAR_STACK_SIZE       ( 1048 )
+#endif
+
+#ifndef energyBATTERY_STACK_SIZE
+    #define energyBATTERY_STACK_SIZE     ( 1048 )
+#endif
+
+#ifndef energyLOAD_STACK_SIZE
+    #define energyLOAD_STACK_SIZE        ( 1048 )
+#endif
+
+#ifndef energyGRID_STACK_SIZE
+    #define energyGRID_STACK_SIZE        ( 1048 )
+#endif
+
+#ifndef energyDISPATCH_STACK_SIZE
+    #define energyDISPATCH_STACK_SIZE    ( 1048 )
+#endif
+
+/* The tasks of a household, for xEnergyManagementGetLoopStats(). */
+typedef enum EnergyLoopTask
+{
+    energyTASK_SOLAR = 0,
+    energyTASK_BATTERY,
+    energyTASK_LOAD,
+    energyTASK_GRID,
+    energyTASK_DISPATCH,
+    energyNUM_TASKS
+} EnergyLoopTask_t;
+
+/* A running household.  Only accessed through the functions below. */
+typedef struct EnergyHousehold EnergyHousehold_t;
+
+/* Running totals of the simulation. */
+typedef struct EnergyManagementTotals
+{
+    EnergyAccountTotals_t xAccount; /* Bill in micro cents and energy flows in micro W.h. */
+    uint32_t ulBatteryLevel;        /* Energy stored in the battery, in W.h. */
+    BatteryModelStats_t xBattery;   /* Losses and wear of the battery. */
+    uint32_t ulPlans;               /* Dispatch plans completed. */
+    uint32_t ulTrades;              /* Energy bought or sold by the household's tasks, and the */
+    uint32_t ulSettlements;         /* transactions that settled it, netted by price slot. */
+    uint32_t ulSolarForecastError;  /* Mean absolute error of the hourly forecasts, in W. */
+    uint32_t ulLoadForecastError;
+} EnergyManagementTotals_t;
+
+/*
+ * Fill pxConfig with the household described in EnergyConfig.h.
+ */
+void vEnergyManagementGetDefaultConfig( EnergyManagementConfig_t * pxConfig );
+
+/*
+ * Allocate a household, subscribe its tasks to its energy bus, register its
+ * devices and create its tasks.  Call once for each household before the
+ * scheduler is started.  pxConfig is copied, but the device names and the
+ * profile it points to must remain valid.  The tariff is compiled, so its
+ * schedule and tiers need not.  Returns the household, or NULL if anything
+ * could not be allocated.
+ */
+EnergyHousehold_t * pxEnergyManagementStart( const EnergyManagementConfig_t * pxConfig );
+
+/*
+ * Run one period of a household started with xPooled set: sample the load and
+ * the solar power, settle what is bought and sold, and give the planner its
+ * budget if it is due.  xTime is the tick the period starts at, and the energy
+ * is for the ticks since the last step.  The household's tasks would do the
+ * same work in the same order, so the results are identical.  A household
+ * must only be stepped by one task at a time, but different households can be
+ * stepped at once.
+ */
+void vEnergyManagementStep( EnergyHousehold_t * pxHousehold,
+                            TickType_t xTime );
+
+/*
+ * Take a snapshot of the running totals of a household.  The account is read
+ * atomically; the battery level and the account agree once the tasks are idle.
+ */
+void vEnergyManagementGetTotals( const EnergyHousehold_t * pxHousehold,
+                                 EnergyManagementTotals_t * pxTotals );
+
+/*
+ * Copy what the last day or month to end added to the account of a household.
+ * Returns pdFALSE if none has ended yet.
+ */
+BaseType_t xEnergyManagementGetSettlement( const EnergyHousehold_t * pxHousehold,
+                                           eAccountPeriod ePeriod,
+                                           EnergyAccountSettlement_t * pxSettlement );
+
+/*
+ * Returns the history of a household, for queries with EnergyHistory.h.
+ */
+EnergyHistory_t * pxEnergyManagementGetHistory( const EnergyHousehold_t * pxHousehold );
+
+/*
+ * Returns the ticks between the samples a household takes, and the ticks in a
+ * simulated hour.
+ */
+TickType_t xEnergyManagementGetPeriod( const EnergyHousehold_t * pxHousehold );
+TickType_t xEnergyManagementGetHourTicks( void );
+
+/*
+ * Change the ticks between the samples a household takes.  Its tasks take the
+ * next sample a period of the new length after the last, and the energy of
+ * each sample is worked out from the ticks since the one before, so nothing
+ * is lost or counted twice.  A pooled household is stepped at the period of
+ * the first household of its pool.
+ */
+void vEnergyManagementSetPeriod( EnergyHousehold_t * pxHousehold,
+                                 TickType_t xPeriod );
+
+/*
+ * Copy the timing of one of a household's tasks, see LoopStats.h: the CPU
+ * time it has used, and for the solar, load, grid and dispatch tasks, which
+ * run at fixed times, how late they woke.  The battery task runs when a
+ * sample arrives, so its latency is the residency of busTOPIC_GENERATION.
+ * Returns pdFALSE if the household has no such task, as it is pooled or does
+ * not plan its battery.
+ */
+BaseType_t xEnergyManagementGetLoopStats( const EnergyHousehold_t * pxHousehold,
+                                          EnergyLoopTask_t eTask,
+                                          LoopTaskStats_t * pxStats );
+
+/*
+ * Copy the histogram of how long the samples of eTopic waited on a
+ * household's bus to be received.  The grid task collects its samples once a
+ * period, so theirs includes the wait for it.
+ */
+void vEnergyManagementGetResidency( const EnergyHousehold_t * pxHousehold,
+                                    EnergyTopic_t eTopic,
+                                    LoopHistogram_t * pxHistogram );
+
+#endif /* ENERGY_MANAGEMENT_H */
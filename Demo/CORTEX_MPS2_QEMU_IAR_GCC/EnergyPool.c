@@ -0,0 +1,252 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Worker pool for pooled households, see EnergyPool.h.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "EnergyPool.h"
+
+/* Passed to each worker, so it knows its pool and which of its statistics to
+ * count in. */
+typedef struct PoolWorker
+{
+    EnergyPool_t * pxPool;
+    UBaseType_t uxIndex;
+    TaskHandle_t xHandle;
+} PoolWorker_t;
+
+struct EnergyPool
+{
+    EnergyHousehold_t ** pxHouseholds;
+    size_t xCount;
+
+    PoolWorker_t xWorkers[ poolMAX_WORKERS ];
+    UBaseType_t uxWorkers;
+    TaskHandle_t xCoordinator;
+
+    /* The period being stepped, the next household to be taken and the
+     * number finished.  Only accessed in critical sections. */
+    TickType_t xTime;
+    size_t xNext;
+    size_t xDone;
+
+    EnergyPoolStats_t xStats;
+};
+
+/*
+ * Releases the workers once each period and waits for them to finish.
+ */
+static void prvCoordinatorTask( void * pvParameters );
+
+/*
+ * Steps households for as long as any of the period are left.
+ */
+static void prvWorkerTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+EnergyPool_t * pxEnergyPoolStart( EnergyHousehold_t * const * pxHouseholds,
+                                  size_t xCount,
+                                  UBaseType_t uxWorkers )
+{
+    EnergyPool_t * pxPool;
+    BaseType_t xReturn;
+    UBaseType_t uxWorker;
+
+    configASSERT( xCount > 0 );
+    configASSERT( ( uxWorkers > 0 ) && ( uxWorkers <= poolMAX_WORKERS ) );
+
+    /* The pool and its list of households are allocated together, the list
+     * after the structure, and live as long as the application.  Nor are
+     * the tasks of a pool that could not be completed deleted, as the
+     * application cannot run without it. */
+    pxPool = ( EnergyPool_t * ) pvPortMalloc( sizeof( EnergyPool_t ) + ( xCount * sizeof( EnergyHousehold_t * ) ) );
+
+    if( pxPool != NULL )
+    {
+        memset( pxPool, 0x00, sizeof( EnergyPool_t ) );
+        pxPool->pxHouseholds = ( EnergyHousehold_t ** ) &( pxPool[ 1 ] );
+        pxPool->xCount = xCount;
+        pxPool->uxWorkers = uxWorkers;
+        pxPool->xNext = xCount;
+        memcpy( pxPool->pxHouseholds, pxHouseholds, xCount * sizeof( EnergyHousehold_t * ) );
+
+        xReturn = xTaskCreate( prvCoordinatorTask, "PoolCoord", configMINIMAL_STACK_SIZE * 2, pxPool,
+                               poolCOORDINATOR_PRIORITY, &( pxPool->xCoordinator ) );
+
+        for( uxWorker = 0; ( uxWorker < uxWorkers ) && ( xReturn == pdPASS ); uxWorker++ )
+        {
+            pxPool->xWorkers[ uxWorker ].pxPool = pxPool;
+            pxPool->xWorkers[ uxWorker ].uxIndex = uxWorker;
+            xReturn = xTaskCreate( prvWorkerTask, "PoolWorker", poolWORKER_STACK_SIZE, &( pxPool->xWorkers[ uxWorker ] ),
+                                   poolWORKER_PRIORITY, &( pxPool->xWorkers[ uxWorker ].xHandle ) );
+
+            #if ( ( configNUMBER_OF_CORES > 1 ) && ( configUSE_CORE_AFFINITY == 1 ) )
+            {
+                /* Spread the workers over the cores, one to each in turn. */
+                if( xReturn == pdPASS )
+                {
+                    vTaskCoreAffinitySet( pxPool->xWorkers[ uxWorker ].xHandle,
+                                          ( UBaseType_t ) 1U << ( uxWorker % ( UBaseType_t ) configNUMBER_OF_CORES ) );
+                }
+            }
+            #endif /* configNUMBER_OF_CORES */
+        }
+
+        if( xReturn != pdPASS )
+        {
+            pxPool = NULL;
+        }
+    }
+
+    return pxPool;
+}
+/*-----------------------------------------------------------*/
+
+void vEnergyPoolGetStats( const EnergyPool_t * pxPool,
+                          EnergyPoolStats_t * pxStats )
+{
+    taskENTER_CRITICAL();
+    {
+        *pxStats = pxPool->xStats;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static void prvCoordinatorTask( void * pvParameters )
+{
+    EnergyPool_t * const pxPool = ( EnergyPool_t * ) pvParameters;
+    TickType_t xPeriod;
+    TickType_t xNextWakeTime;
+    UBaseType_t uxWorker;
+
+    /* Step the households at the same ticks their own tasks would run. */
+    xNextWakeTime = xTaskGetTickCount();
+
+    for( ; ; )
+    {
+        /* Every household is stepped at the period of the first. */
+        xPeriod = xEnergyManagementGetPeriod( pxPool->pxHouseholds[ 0 ] );
+        vTaskDelayUntil( &xNextWakeTime, xPeriod );
+
+        /* Open the period, then release every worker.  On one core none runs
+         * until this task blocks, as they have a lower priority, but on an SMP
+         * build a worker on another core starts as soon as it is notified.
+         * So the period is opened first, and the workers only take the
+         * households it hands out. */
+        taskENTER_CRITICAL();
+        {
+            pxPool->xTime = xNextWakeTime;
+            pxPool->xNext = 0;
+            pxPool->xDone = 0;
+        }
+        taskEXIT_CRITICAL();
+
+        for( uxWorker = 0; uxWorker < pxPool->uxWorkers; uxWorker++ )
+        {
+            xTaskNotifyGive( pxPool->xWorkers[ uxWorker ].xHandle );
+        }
+
+        /* The barrier: wait for the worker that finishes the last household.
+         * If the workers on other cores finished before this task got here
+         * the notification is already pending, and this returns at once. */
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        taskENTER_CRITICAL();
+        {
+            pxPool->xStats.ulPeriods++;
+
+            if( ( xTaskGetTickCount() - xNextWakeTime ) >= xPeriod )
+            {
+                pxPool->xStats.ulOverruns++;
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvWorkerTask( void * pvParameters )
+{
+    PoolWorker_t * const pxWorker = ( PoolWorker_t * ) pvParameters;
+    EnergyPool_t * const pxPool = pxWorker->pxPool;
+    EnergyHousehold_t * pxHousehold;
+    TickType_t xTime = 0;
+    BaseType_t xLast;
+
+    for( ; ; )
+    {
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        do
+        {
+            /* Take the next household of the period, if there is one.  A
+             * worker released late may find the period already finished, or
+             * the next one started, which it then helps with. */
+            pxHousehold = NULL;
+
+            taskENTER_CRITICAL();
+            {
+                if( pxPool->xNext < pxPool->xCount )
+                {
+                    pxHousehold = pxPool->pxHouseholds[ pxPool->xNext ];
+                    pxPool->xNext++;
+                    xTime = pxPool->xTime;
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            if( pxHousehold != NULL )
+            {
+                vEnergyManagementStep( pxHousehold, xTime );
+
+                taskENTER_CRITICAL();
+                {
+                    pxPool->xDone++;
+                    pxPool->xStats.ulSteps[ pxWorker->uxIndex ]++;
+                    xLast = ( pxPool->xDone == pxPool->xCount ) ? pdTRUE : pdFALSE;
+                }
+                taskEXIT_CRITICAL();
+
+                if( xLast != pdFALSE )
+                {
+                    xTaskNotifyGive( pxPool->xCoordinator );
+                }
+            }
+        } while( pxHousehold != NULL );
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,104 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef ENERGY_POOL_H
+#define ENERGY_POOL_H
+
+/*
+ * Runs many households on a fixed pool of worker tasks, instead of the five
+ * tasks each household creates for itself.
+ *
+ * Each period a coordinator task releases the workers, which take the
+ * households one at a time and call vEnergyManagementStep() on them until
+ * none are left.  The worker that finishes the last household wakes the
+ * coordinator, so every household has finished a period before any starts the
+ * next: a barrier per simulated sample.  The results are the same however
+ * many workers there are and in whatever order they take the households.
+ *
+ * On an SMP build of the kernel (configNUMBER_OF_CORES > 1 with
+ * configUSE_CORE_AFFINITY set to 1) the workers are pinned to the cores in
+ * turn with vTaskCoreAffinitySet(), so the households of a period are stepped
+ * on all cores at once.  On a single core the workers share it, and one worker
+ * is as fast as many.
+ *
+ * The RP2040 port in Source/portable/ThirdParty/GCC/RP2040 gives such a
+ * kernel when built with configNUMBER_OF_CORES set to 2 and
+ * configUSE_CORE_AFFINITY set to 1.  There is no demo for it in this tree:
+ * it is built with the Pico SDK, and the serial port and timers the energy
+ * application uses are the MPS2's.
+ */
+
+#include "EnergyManagement.h"
+
+/* Most workers a pool can have. */
+#ifndef poolMAX_WORKERS
+    #define poolMAX_WORKERS             ( 16U )
+#endif
+
+/* The coordinator runs above the workers.  On one core it releases all of
+ * them before any starts; on several a worker may start as soon as it is
+ * released, which the pool allows for. */
+#ifndef poolWORKER_PRIORITY
+    #define poolWORKER_PRIORITY         ( tskIDLE_PRIORITY + 2 )
+#endif
+
+#ifndef poolCOORDINATOR_PRIORITY
+    #define poolCOORDINATOR_PRIORITY    ( tskIDLE_PRIORITY + 3 )
+#endif
+
+/* Stack of each worker in words.  A worker does the work of every task of a
+ * household, so needs as much as the largest of them. */
+#ifndef poolWORKER_STACK_SIZE
+    #define poolWORKER_STACK_SIZE       ( 1048 )
+#endif
+
+typedef struct EnergyPoolStats
+{
+    uint32_t ulPeriods;                   /* Periods every household has finished. */
+    uint32_t ulOverruns;                  /* Periods that took longer than a period to finish. */
+    uint32_t ulSteps[ poolMAX_WORKERS ];  /* Households stepped by each worker. */
+} EnergyPoolStats_t;
+
+/* A running pool.  Only accessed through the functions below. */
+typedef struct EnergyPool EnergyPool_t;
+
+/*
+ * Create uxWorkers workers and their coordinator to step the xCount
+ * households in pxHouseholds, which must all have been started with xPooled
+ * set.  The list is copied.  Call before the scheduler is started.  Returns
+ * NULL if anything could not be allocated.
+ */
+EnergyPool_t * pxEnergyPoolStart( EnergyHousehold_t * const * pxHouseholds,
+                                  size_t xCount,
+                                  UBaseType_t uxWorkers );
+
+/*
+ * Take a snapshot of the statistics of a pool.
+ */
+void vEnergyPoolGetStats( const EnergyPool_t * pxPool,
+                          EnergyPoolStats_t * pxStats );
+
+#endif /* ENERGY_POOL_H */
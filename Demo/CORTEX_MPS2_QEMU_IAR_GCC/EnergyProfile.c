@@ -0,0 +1,171 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Replay of recorded solar and load profiles, see EnergyProfile.h.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+
+/* Demo includes. */
+#include "EnergyProfile.h"
+
+#define profileMAX_VARINT_BYTES    ( 5U )
+
+/* Decode one zigzag varint, returning pdFAIL if the data runs out first. */
+static BaseType_t prvDecodeDelta( EnergyProfile_t * pxProfile,
+                                  int32_t * plDelta );
+
+static void prvRewind( EnergyProfile_t * pxProfile );
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xEnergyProfileInit( EnergyProfile_t * pxProfile,
+                               const uint8_t * pucData,
+                               size_t xLength )
+{
+    BaseType_t xReturn = pdFAIL;
+
+    memset( pxProfile, 0x00, sizeof( *pxProfile ) );
+
+    if( ( pucData != NULL ) &&
+        ( xLength > profileHEADER_SIZE ) &&
+        ( memcmp( pucData, "EPRF", 4 ) == 0 ) &&
+        ( pucData[ 4 ] == profileVERSION ) )
+    {
+        pxProfile->pucData = pucData;
+        pxProfile->xLength = xLength;
+        pxProfile->ulCount = ( uint32_t ) pucData[ 8 ] |
+                             ( ( uint32_t ) pucData[ 9 ] << 8 ) |
+                             ( ( uint32_t ) pucData[ 10 ] << 16 ) |
+                             ( ( uint32_t ) pucData[ 11 ] << 24 );
+        pxProfile->usMinutes = ( uint16_t ) ( ( uint16_t ) pucData[ 6 ] | ( ( uint16_t ) pucData[ 7 ] << 8 ) );
+
+        if( pxProfile->ulCount > 0UL )
+        {
+            prvRewind( pxProfile );
+            xReturn = pdPASS;
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vEnergyProfileNext( EnergyProfile_t * pxProfile,
+                         uint32_t * pulSolar,
+                         uint32_t * pulLoad )
+{
+    int32_t lSolarDelta, lLoadDelta;
+
+    configASSERT( pxProfile->pucData != NULL );
+
+    if( pxProfile->ulIndex >= pxProfile->ulCount )
+    {
+        prvRewind( pxProfile );
+    }
+
+    if( ( prvDecodeDelta( pxProfile, &lSolarDelta ) == pdFAIL ) ||
+        ( prvDecodeDelta( pxProfile, &lLoadDelta ) == pdFAIL ) )
+    {
+        /* Truncated.  Replay the part that is there. */
+        prvRewind( pxProfile );
+
+        if( ( prvDecodeDelta( pxProfile, &lSolarDelta ) == pdFAIL ) ||
+            ( prvDecodeDelta( pxProfile, &lLoadDelta ) == pdFAIL ) )
+        {
+            lSolarDelta = 0;
+            lLoadDelta = 0;
+        }
+    }
+
+    pxProfile->lSolar += lSolarDelta;
+    pxProfile->lLoad += lLoadDelta;
+    pxProfile->ulIndex++;
+    pxProfile->ulPlayed++;
+
+    *pulSolar = ( pxProfile->lSolar > 0 ) ? ( uint32_t ) pxProfile->lSolar : 0UL;
+    *pulLoad = ( pxProfile->lLoad > 0 ) ? ( uint32_t ) pxProfile->lLoad : 0UL;
+}
+/*-----------------------------------------------------------*/
+
+void vEnergyProfileSeek( EnergyProfile_t * pxProfile,
+                         uint32_t ulSample,
+                         uint32_t * pulSolar,
+                         uint32_t * pulLoad )
+{
+    configASSERT( pxProfile->pucData != NULL );
+
+    while( pxProfile->ulPlayed <= ulSample )
+    {
+        vEnergyProfileNext( pxProfile, pulSolar, pulLoad );
+    }
+
+    *pulSolar = ( pxProfile->lSolar > 0 ) ? ( uint32_t ) pxProfile->lSolar : 0UL;
+    *pulLoad = ( pxProfile->lLoad > 0 ) ? ( uint32_t ) pxProfile->lLoad : 0UL;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvDecodeDelta( EnergyProfile_t * pxProfile,
+                                  int32_t * plDelta )
+{
+    uint32_t ulValue = 0UL;
+    uint32_t ulByte;
+    UBaseType_t uxShift = 0U;
+    BaseType_t xReturn = pdFAIL;
+
+    while( ( pxProfile->xOffset < pxProfile->xLength ) && ( uxShift < ( profileMAX_VARINT_BYTES * 7U ) ) )
+    {
+        ulByte = pxProfile->pucData[ pxProfile->xOffset ];
+        pxProfile->xOffset++;
+        ulValue |= ( ulByte & 0x7FUL ) << uxShift;
+        uxShift += 7U;
+
+        if( ( ulByte & 0x80UL ) == 0UL )
+        {
+            /* Undo the zigzag encoding, which maps 0, -1, 1, -2... to 0, 1, 2, 3... */
+            *plDelta = ( int32_t ) ( ulValue >> 1 ) ^ -( int32_t ) ( ulValue & 1UL );
+            xReturn = pdPASS;
+            break;
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRewind( EnergyProfile_t * pxProfile )
+{
+    pxProfile->xOffset = profileHEADER_SIZE;
+    pxProfile->ulIndex = 0UL;
+    pxProfile->lSolar = 0;
+    pxProfile->lLoad = 0;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,99 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef ENERGY_PROFILE_H
+#define ENERGY_PROFILE_H
+
+/*
+ * Replay of recorded solar and load profiles.
+ *
+ * A profile is a series of (solar W, load W) samples, one per sample period of
+ * the energy tasks, compressed as:
+ *
+ *   'E' 'P' 'R' 'F'  version  reserved  minutes[ 2 ]  count[ 4 ]  samples...
+ *
+ * Multi byte header fields are little endian.  minutes is the simulated time
+ * between samples, and count the number of samples.  Each sample is the change
+ * in solar power followed by the change in load from the previous sample
+ * (which starts at 0), each zigzag encoded and written as a base 128 varint,
+ * least significant group first.  Slowly changing profiles mostly take one
+ * byte per value.
+ *
+ * The samples are decoded one at a time straight from the compressed data,
+ * so replaying a profile takes an EnergyProfile_t of RAM however long it is.
+ * The data can be a blob linked into the image, or a memory mapped file on
+ * the host.  tools/profile_encode.py makes profiles from CSV files.
+ */
+
+#include <stddef.h>
+
+#define profileVERSION         ( 1U )
+#define profileHEADER_SIZE     ( 12U )
+
+typedef struct EnergyProfile
+{
+    const uint8_t * pucData;
+    size_t xLength;
+    size_t xOffset;       /* Next byte to decode. */
+    uint32_t ulCount;     /* Samples in the profile. */
+    uint16_t usMinutes;   /* Simulated minutes between samples. */
+    uint32_t ulIndex;     /* Samples decoded since the last rewind. */
+    uint32_t ulPlayed;    /* Samples decoded since the start of the replay. */
+    int32_t lSolar;       /* Last sample decoded. */
+    int32_t lLoad;
+} EnergyProfile_t;
+
+/*
+ * Check the header of the profile in pucData and prepare to decode it from
+ * the start.  The data is not copied.  Returns pdFAIL if it is not a profile
+ * or holds no samples.
+ */
+BaseType_t xEnergyProfileInit( EnergyProfile_t * pxProfile,
+                               const uint8_t * pucData,
+                               size_t xLength );
+
+/*
+ * Decode the next sample.  At the end of the profile, or if the data turns
+ * out to be truncated, the profile starts again from the beginning, so it can
+ * be replayed for as long as a simulation runs.  Negative values in the data
+ * read as 0.
+ */
+void vEnergyProfileNext( EnergyProfile_t * pxProfile,
+                         uint32_t * pulSolar,
+                         uint32_t * pulLoad );
+
+/*
+ * Decode forward to sample ulSample of the replay, counting the first as 0
+ * and carrying on through the rewinds, and return it.  The samples before it
+ * are decoded and dropped, so a replay can be sampled more or less often than
+ * it was recorded.  ulSample must not go back.
+ */
+void vEnergyProfileSeek( EnergyProfile_t * pxProfile,
+                         uint32_t ulSample,
+                         uint32_t * pulSolar,
+                         uint32_t * pulLoad );
+
+#endif /* ENERGY_PROFILE_H */
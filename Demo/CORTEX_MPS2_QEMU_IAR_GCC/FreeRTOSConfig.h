@@ -39,8 +39,12 @@
 * See http://www.freertos.org/a00110.html
 *----------------------------------------------------------*/
 
-#define configUSE_TRACE_FACILITY                 0
-#define configGENERATE_RUN_TIME_STATS            0
+/* Run time stats are counted on the CPU clock by CMSDK timer 1, see
+ * RunTimeClock.h.  The kernel's counter is 32 bits so its percentages are only
+ * good for the first wrap, under three minutes; LoopStats.h keeps 64 bit
+ * totals of the energy tasks. */
+#define configUSE_TRACE_FACILITY                 1
+#define configGENERATE_RUN_TIME_STATS            1
 
 #define configUSE_PREEMPTION                     1
 #define configUSE_IDLE_HOOK                      0
@@ -50,13 +54,13 @@
 #define configMINIMAL_STACK_SIZE                 ( ( unsigned short ) 80 )
 #define configTOTAL_HEAP_SIZE                    ( ( size_t ) ( 60 * 1024 ) )
 #define configMAX_TASK_NAME_LEN                  ( 12 )
-#define configUSE_TRACE_FACILITY                 0
 #define configUSE_16_BIT_TICKS                   0
 #define configIDLE_SHOULD_YIELD                  0
 #define configUSE_CO_ROUTINES                    0
 #define configUSE_MUTEXES                        1
 #define configUSE_RECURSIVE_MUTEXES              1
 #define configCHECK_FOR_STACK_OVERFLOW           2
+#define configRECORD_STACK_HIGH_ADDRESS          1 /* So StackProfile.c can tell the size of each stack. */
 #define configUSE_MALLOC_FAILED_HOOK             1
 #define configUSE_QUEUE_SETS                     1
 #define configUSE_COUNTING_SEMAPHORES            1
@@ -75,6 +79,9 @@
 #define configUSE_TASK_NOTIFICATIONS             1
 #define configTASK_NOTIFICATION_ARRAY_ENTRIES    3
 
+/* Pointer 0 is the task's LoopStats.h record. */
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS  1
+
 /* Set the following definitions to 1 to include the API function, or zero
  * to exclude the API function. */
 
@@ -125,6 +132,16 @@
     void vAssertCalled( const char * pcFileName,
                         uint32_t ulLine );
     #define configASSERT( x )    if( ( x ) == 0 ) vAssertCalled( __FILE__, __LINE__ );
+
+    /* Run time stats on the clock of RunTimeClock.h. */
+    void vRunTimeClockInit( void );
+    uint32_t ulRunTimeClockGet( void );
+    #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()    vRunTimeClockInit()
+    #define portGET_RUN_TIME_COUNTER_VALUE()            ulRunTimeClockGet()
+
+    /* Time the energy tasks and record what the kernel does, see LoopStats.h
+     * and TraceRecorder.h. */
+    #include "TraceHooks.h"
 #endif
 
 #define intqHIGHER_PRIORITY      ( configMAX_PRIORITIES - 5 )
@@ -0,0 +1,592 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Kernel microbenchmarks, see KernelBenchmark.h.
+ *
+ * Every operation is run benchOPS times between two readings of the clock,
+ * and that is repeated benchBATCHES times.  Where an operation needs another
+ * to undo it, a queue send and receive say, the batch of one is followed by
+ * a batch of the other, and both are timed, so the queues and buffers never
+ * need to hold more than benchOPS items.  The cost of reading the clock is
+ * measured first and taken off every batch.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "stream_buffer.h"
+
+/* Demo includes. */
+#include "RunTimeClock.h"
+#include "KernelBenchmark.h"
+
+/* Operations timed together, and the number of times each batch is run. */
+#define benchOPS                     ( 16U )
+#define benchBATCHES                 ( 32U )
+
+/* Largest item sent through a queue or stream buffer. */
+#define benchMAX_ITEM_SIZE           ( 256U )
+
+/* Most tasks left delayed while the tick is timed. */
+#define benchMAX_SLEEPERS            ( 32U )
+
+/* The delayed tasks are woken this many ticks after they block, which leaves
+ * room for a batch of ticks that wake none of them before the tick that
+ * wakes all of them. */
+#define benchSLEEP_TICKS             ( ( TickType_t ) ( benchOPS * 4U ) )
+#define benchSLEEPER_PRIORITY        ( tskIDLE_PRIORITY + 1 )
+
+/* The results are printed a line at a time, with a pause after each so the
+ * serial log can send it before the next. */
+#define benchLINE_DELAY              pdMS_TO_TICKS( 10UL )
+
+/* Times, in clock counts, of all the batches of one operation. */
+typedef struct BenchResult
+{
+    uint32_t ulMin;
+    uint32_t ulMax;
+    uint64_t ullTotal;
+    uint32_t ulBatches;
+} BenchResult_t;
+
+/* The benchmarks.  Each prints its own results. */
+static void prvBenchQueue( size_t xItemSize );
+static void prvBenchSemaphore( void );
+static void prvBenchNotify( void );
+static void prvBenchStreamBuffer( size_t xItemSize );
+static void prvBenchContextSwitch( void );
+static void prvBenchTick( uint32_t ulSleepers );
+
+/* The other side of the context switches, and the tasks left delayed while
+ * the tick is timed. */
+static void prvYieldTask( void * pvParameters );
+static void prvSleeperTask( void * pvParameters );
+
+/* Start a result, and add a batch timed from ulStart to ulEnd to it. */
+static void prvResultInit( BenchResult_t * pxResult );
+static void prvRecord( BenchResult_t * pxResult,
+                       uint32_t ulStart,
+                       uint32_t ulEnd );
+
+/* Print a result, with pcParameter = ulParameter if pcParameter is not NULL. */
+static void prvPrint( const char * pcName,
+                      const char * pcParameter,
+                      uint32_t ulParameter,
+                      uint32_t ulOps,
+                      const BenchResult_t * pxResult );
+
+/* Tenths of a ns taken by one of ulOps operations that took ullCounts. */
+static uint32_t prvTenthsOfNs( uint64_t ullCounts,
+                               uint32_t ulOps );
+
+/* Items are copied from and to here. */
+static uint8_t ucItem[ benchMAX_ITEM_SIZE ];
+
+/* Counts taken by back to back reads of the clock. */
+static uint32_t ulOverhead;
+
+/* Whether a result has been printed, so the next needs a comma. */
+static BaseType_t xPrinted;
+
+/* Set while prvYieldTask() should keep yielding. */
+static volatile BaseType_t xYielding;
+
+/* The tick the sleepers wake on, whether they should delete themselves
+ * instead of sleeping again, and how many are asleep or deleted. */
+static volatile TickType_t xSleepUntil;
+static volatile BaseType_t xSleepersStop;
+static volatile uint32_t ulSleeping;
+static volatile uint32_t ulSleepersDone;
+
+/*-----------------------------------------------------------*/
+
+void vKernelBenchmarkRun( const char * pcTarget )
+{
+    static const size_t xQueueSizes[] = { 4U, 16U, 64U, 256U };
+    static const size_t xStreamSizes[] = { 4U, 64U };
+    static const uint32_t ulSleepers[] = { 0U, 8U, benchMAX_SLEEPERS };
+    uint32_t ulStart, ulEnd, ulTry;
+    size_t x;
+
+    configASSERT( uxTaskPriorityGet( NULL ) == kernelbenchPRIORITY );
+
+    vRunTimeClockInit();
+
+    ulOverhead = UINT32_MAX;
+
+    for( ulTry = 0; ulTry < benchBATCHES; ulTry++ )
+    {
+        ulStart = ulRunTimeClockGet();
+        ulEnd = ulRunTimeClockGet();
+
+        if( ( ulEnd - ulStart ) < ulOverhead )
+        {
+            ulOverhead = ulEnd - ulStart;
+        }
+    }
+
+    printf( "{\"benchmark\":\"kernel\",\"target\":\"%s\",\"clock_hz\":%lu,\"batches\":%u,\"results\":[",
+            pcTarget, ( unsigned long ) ulRunTimeClockGetHz(), ( unsigned ) benchBATCHES );
+    xPrinted = pdFALSE;
+
+    for( x = 0; x < ( sizeof( xQueueSizes ) / sizeof( xQueueSizes[ 0 ] ) ); x++ )
+    {
+        prvBenchQueue( xQueueSizes[ x ] );
+    }
+
+    prvBenchSemaphore();
+    prvBenchNotify();
+
+    for( x = 0; x < ( sizeof( xStreamSizes ) / sizeof( xStreamSizes[ 0 ] ) ); x++ )
+    {
+        prvBenchStreamBuffer( xStreamSizes[ x ] );
+    }
+
+    prvBenchContextSwitch();
+
+    for( x = 0; x < ( sizeof( ulSleepers ) / sizeof( ulSleepers[ 0 ] ) ); x++ )
+    {
+        prvBenchTick( ulSleepers[ x ] );
+    }
+
+    printf( "\r\n]}\r\n" );
+    vTaskDelay( benchLINE_DELAY );
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchQueue( size_t xItemSize )
+{
+    BenchResult_t xSend, xReceive;
+    QueueHandle_t xQueue;
+    uint32_t ulBatch, ulStart, ulMid, ulEnd, ulOp;
+
+    xQueue = xQueueCreate( benchOPS, xItemSize );
+    configASSERT( xQueue != NULL );
+
+    prvResultInit( &xSend );
+    prvResultInit( &xReceive );
+
+    for( ulBatch = 0; ulBatch < benchBATCHES; ulBatch++ )
+    {
+        ulStart = ulRunTimeClockGet();
+
+        for( ulOp = 0; ulOp < benchOPS; ulOp++ )
+        {
+            ( void ) xQueueSend( xQueue, ucItem, 0 );
+        }
+
+        ulMid = ulRunTimeClockGet();
+
+        for( ulOp = 0; ulOp < benchOPS; ulOp++ )
+        {
+            ( void ) xQueueReceive( xQueue, ucItem, 0 );
+        }
+
+        ulEnd = ulRunTimeClockGet();
+
+        prvRecord( &xSend, ulStart, ulMid );
+        prvRecord( &xReceive, ulMid, ulEnd );
+    }
+
+    configASSERT( uxQueueMessagesWaiting( xQueue ) == 0U );
+    vQueueDelete( xQueue );
+
+    prvPrint( "queue_send", "item_size", ( uint32_t ) xItemSize, benchOPS, &xSend );
+    prvPrint( "queue_receive", "item_size", ( uint32_t ) xItemSize, benchOPS, &xReceive );
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchSemaphore( void )
+{
+    BenchResult_t xGive, xTake;
+    SemaphoreHandle_t xSemaphore;
+    uint32_t ulBatch, ulStart, ulMid, ulEnd, ulOp;
+
+    xSemaphore = xSemaphoreCreateCounting( benchOPS, 0 );
+    configASSERT( xSemaphore != NULL );
+
+    prvResultInit( &xGive );
+    prvResultInit( &xTake );
+
+    for( ulBatch = 0; ulBatch < benchBATCHES; ulBatch++ )
+    {
+        ulStart = ulRunTimeClockGet();
+
+        for( ulOp = 0; ulOp < benchOPS; ulOp++ )
+        {
+            ( void ) xSemaphoreGive( xSemaphore );
+        }
+
+        ulMid = ulRunTimeClockGet();
+
+        for( ulOp = 0; ulOp < benchOPS; ulOp++ )
+        {
+            ( void ) xSemaphoreTake( xSemaphore, 0 );
+        }
+
+        ulEnd = ulRunTimeClockGet();
+
+        prvRecord( &xGive, ulStart, ulMid );
+        prvRecord( &xTake, ulMid, ulEnd );
+    }
+
+    configASSERT( uxSemaphoreGetCount( xSemaphore ) == 0U );
+    vSemaphoreDelete( xSemaphore );
+
+    prvPrint( "semaphore_give", NULL, 0, benchOPS, &xGive );
+    prvPrint( "semaphore_take", NULL, 0, benchOPS, &xTake );
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchNotify( void )
+{
+    const TaskHandle_t xSelf = xTaskGetCurrentTaskHandle();
+    BenchResult_t xGive, xTake;
+    uint32_t ulBatch, ulStart, ulMid, ulEnd, ulOp;
+
+    prvResultInit( &xGive );
+    prvResultInit( &xTake );
+
+    /* The task notifies itself, which costs the same as notifying a task
+     * that is not waiting. */
+    for( ulBatch = 0; ulBatch < benchBATCHES; ulBatch++ )
+    {
+        ulStart = ulRunTimeClockGet();
+
+        for( ulOp = 0; ulOp < benchOPS; ulOp++ )
+        {
+            ( void ) xTaskNotifyGive( xSelf );
+        }
+
+        ulMid = ulRunTimeClockGet();
+
+        for( ulOp = 0; ulOp < benchOPS; ulOp++ )
+        {
+            ( void ) ulTaskNotifyTake( pdFALSE, 0 );
+        }
+
+        ulEnd = ulRunTimeClockGet();
+
+        prvRecord( &xGive, ulStart, ulMid );
+        prvRecord( &xTake, ulMid, ulEnd );
+    }
+
+    configASSERT( ulTaskNotifyTake( pdTRUE, 0 ) == 0U );
+
+    prvPrint( "notify_give", NULL, 0, benchOPS, &xGive );
+    prvPrint( "notify_take", NULL, 0, benchOPS, &xTake );
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchStreamBuffer( size_t xItemSize )
+{
+    BenchResult_t xSend, xReceive;
+    StreamBufferHandle_t xStream;
+    uint32_t ulBatch, ulStart, ulMid, ulEnd, ulOp;
+
+    xStream = xStreamBufferCreate( benchOPS * xItemSize, 1 );
+    configASSERT( xStream != NULL );
+
+    prvResultInit( &xSend );
+    prvResultInit( &xReceive );
+
+    for( ulBatch = 0; ulBatch < benchBATCHES; ulBatch++ )
+    {
+        ulStart = ulRunTimeClockGet();
+
+        for( ulOp = 0; ulOp < benchOPS; ulOp++ )
+        {
+            ( void ) xStreamBufferSend( xStream, ucItem, xItemSize, 0 );
+        }
+
+        ulMid = ulRunTimeClockGet();
+
+        for( ulOp = 0; ulOp < benchOPS; ulOp++ )
+        {
+            ( void ) xStreamBufferReceive( xStream, ucItem, xItemSize, 0 );
+        }
+
+        ulEnd = ulRunTimeClockGet();
+
+        prvRecord( &xSend, ulStart, ulMid );
+        prvRecord( &xReceive, ulMid, ulEnd );
+    }
+
+    configASSERT( xStreamBufferIsEmpty( xStream ) != pdFALSE );
+    vStreamBufferDelete( xStream );
+
+    prvPrint( "stream_buffer_send", "item_size", ( uint32_t ) xItemSize, benchOPS, &xSend );
+    prvPrint( "stream_buffer_receive", "item_size", ( uint32_t ) xItemSize, benchOPS, &xReceive );
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchContextSwitch( void )
+{
+    BenchResult_t xSwitch;
+    uint32_t ulBatch, ulStart, ulEnd, ulOp;
+    BaseType_t xCreated;
+
+    prvResultInit( &xSwitch );
+
+    /* Each yield switches to the other task at this priority, which yields
+     * straight back, so is two context switches. */
+    xYielding = pdTRUE;
+    xCreated = xTaskCreate( prvYieldTask, "BenchYield", configMINIMAL_STACK_SIZE, NULL, kernelbenchPRIORITY, NULL );
+    configASSERT( xCreated == pdPASS );
+    ( void ) xCreated;
+
+    /* Let it start. */
+    taskYIELD();
+
+    for( ulBatch = 0; ulBatch < benchBATCHES; ulBatch++ )
+    {
+        ulStart = ulRunTimeClockGet();
+
+        for( ulOp = 0; ulOp < benchOPS; ulOp++ )
+        {
+            taskYIELD();
+        }
+
+        ulEnd = ulRunTimeClockGet();
+
+        prvRecord( &xSwitch, ulStart, ulEnd );
+    }
+
+    /* It deletes itself once it sees xYielding is clear, and the idle task
+     * frees it while this task is delayed. */
+    xYielding = pdFALSE;
+    taskYIELD();
+    vTaskDelay( 1 );
+
+    prvPrint( "context_switch", NULL, 0, benchOPS * 2U, &xSwitch );
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchTick( uint32_t ulSleepers )
+{
+    BenchResult_t xTick, xWake;
+    uint32_t ulBatch, ulStart, ulMid, ulEnd, ulOp, ulSleeper;
+    BaseType_t xCreated;
+
+    configASSERT( ulSleepers <= benchMAX_SLEEPERS );
+
+    prvResultInit( &xTick );
+    prvResultInit( &xWake );
+
+    xSleepersStop = pdFALSE;
+    ulSleepersDone = 0;
+
+    for( ulSleeper = 0; ulSleeper < ulSleepers; ulSleeper++ )
+    {
+        xCreated = xTaskCreate( prvSleeperTask, "BenchSleep", configMINIMAL_STACK_SIZE, NULL, benchSLEEPER_PRIORITY, NULL );
+        configASSERT( xCreated == pdPASS );
+        ( void ) xCreated;
+    }
+
+    for( ulBatch = 0; ulBatch < benchBATCHES; ulBatch++ )
+    {
+        /* Let the sleepers delay themselves until xSleepUntil.  They run
+         * below this task, so only while it is delayed. */
+        ulSleeping = 0;
+        xSleepUntil = xTaskGetTickCount() + benchSLEEP_TICKS;
+
+        while( ulSleeping < ulSleepers )
+        {
+            vTaskDelay( 1 );
+        }
+
+        /* Step the tick as the tick interrupt would, which it cannot do
+         * meanwhile as interrupts are masked.  First ticks on which none of
+         * the sleepers wake, then the one on which they all do. */
+        taskENTER_CRITICAL();
+        {
+            configASSERT( ( xSleepUntil - xTaskGetTickCount() ) > ( TickType_t ) benchOPS );
+
+            ulStart = ulRunTimeClockGet();
+
+            for( ulOp = 0; ulOp < benchOPS; ulOp++ )
+            {
+                ( void ) xTaskIncrementTick();
+            }
+
+            ulEnd = ulRunTimeClockGet();
+
+            prvRecord( &xTick, ulStart, ulEnd );
+
+            while( ( xSleepUntil - xTaskGetTickCount() ) > ( TickType_t ) 1 )
+            {
+                ( void ) xTaskIncrementTick();
+            }
+
+            ulMid = ulRunTimeClockGet();
+            ( void ) xTaskIncrementTick();
+            ulEnd = ulRunTimeClockGet();
+
+            prvRecord( &xWake, ulMid, ulEnd );
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    /* The sleepers were woken by the last tick, and delete themselves the
+     * next time they run. */
+    xSleepersStop = pdTRUE;
+
+    while( ulSleepersDone < ulSleepers )
+    {
+        vTaskDelay( 1 );
+    }
+
+    vTaskDelay( 1 );
+
+    prvPrint( "tick_increment", "delayed_tasks", ulSleepers, benchOPS, &xTick );
+    prvPrint( "tick_increment_wake", "delayed_tasks", ulSleepers, 1U, &xWake );
+}
+/*-----------------------------------------------------------*/
+
+static void prvYieldTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    while( xYielding != pdFALSE )
+    {
+        taskYIELD();
+    }
+
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSleeperTask( void * pvParameters )
+{
+    TickType_t xUntil;
+
+    ( void ) pvParameters;
+
+    while( xSleepersStop == pdFALSE )
+    {
+        xUntil = xSleepUntil;
+
+        taskENTER_CRITICAL();
+        {
+            ulSleeping++;
+        }
+        taskEXIT_CRITICAL();
+
+        vTaskDelay( xUntil - xTaskGetTickCount() );
+    }
+
+    taskENTER_CRITICAL();
+    {
+        ulSleepersDone++;
+    }
+    taskEXIT_CRITICAL();
+
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvResultInit( BenchResult_t * pxResult )
+{
+    pxResult->ulMin = UINT32_MAX;
+    pxResult->ulMax = 0;
+    pxResult->ullTotal = 0;
+    pxResult->ulBatches = 0;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRecord( BenchResult_t * pxResult,
+                       uint32_t ulStart,
+                       uint32_t ulEnd )
+{
+    uint32_t ulCounts = ulEnd - ulStart;
+
+    ulCounts = ( ulCounts > ulOverhead ) ? ( ulCounts - ulOverhead ) : 0U;
+
+    if( ulCounts < pxResult->ulMin )
+    {
+        pxResult->ulMin = ulCounts;
+    }
+
+    if( ulCounts > pxResult->ulMax )
+    {
+        pxResult->ulMax = ulCounts;
+    }
+
+    pxResult->ullTotal += ulCounts;
+    pxResult->ulBatches++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPrint( const char * pcName,
+                      const char * pcParameter,
+                      uint32_t ulParameter,
+                      uint32_t ulOps,
+                      const BenchResult_t * pxResult )
+{
+    const uint32_t ulMin = prvTenthsOfNs( pxResult->ulMin, ulOps );
+    const uint32_t ulMean = prvTenthsOfNs( pxResult->ullTotal, ulOps * pxResult->ulBatches );
+    const uint32_t ulMax = prvTenthsOfNs( pxResult->ulMax, ulOps );
+
+    printf( "%s\r\n{\"name\":\"%s\",", ( xPrinted != pdFALSE ) ? "," : "", pcName );
+
+    if( pcParameter != NULL )
+    {
+        printf( "\"%s\":%lu,", pcParameter, ( unsigned long ) ulParameter );
+    }
+
+    printf( "\"ops\":%lu,\"min_ns\":%lu.%lu,\"mean_ns\":%lu.%lu,\"max_ns\":%lu.%lu}",
+            ( unsigned long ) ulOps,
+            ( unsigned long ) ( ulMin / 10U ), ( unsigned long ) ( ulMin % 10U ),
+            ( unsigned long ) ( ulMean / 10U ), ( unsigned long ) ( ulMean % 10U ),
+            ( unsigned long ) ( ulMax / 10U ), ( unsigned long ) ( ulMax % 10U ) );
+
+    xPrinted = pdTRUE;
+    vTaskDelay( benchLINE_DELAY );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvTenthsOfNs( uint64_t ullCounts,
+                               uint32_t ulOps )
+{
+    const uint64_t ullHz = ulRunTimeClockGetHz();
+    uint64_t ullTenths;
+
+    /* In two parts, as in ullLoopStatsToMicroseconds(), so a large count
+     * does not overflow.  The remainder does not either, for any clock
+     * slower than 1.8 GHz. */
+    ullTenths = ( ( ullCounts / ullHz ) * 10000000000ULL ) + ( ( ( ullCounts % ullHz ) * 10000000000ULL ) / ullHz );
+    ullTenths /= ulOps;
+
+    return ( ullTenths > UINT32_MAX ) ? UINT32_MAX : ( uint32_t ) ullTenths;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,66 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef KERNEL_BENCHMARK_H
+#define KERNEL_BENCHMARK_H
+
+/*
+ * Times the kernel primitives the energy application is built on - queues,
+ * semaphores, task notifications, stream buffers, context switches and the
+ * tick - and prints the time each operation takes as JSON, for tracking from
+ * one kernel or compiler version to the next:
+ *
+ *   {"benchmark":"kernel","target":"mps2","clock_hz":25000000,"batches":32,
+ *    "results":[
+ *     {"name":"queue_send","item_size":4,"ops":16,"min_ns":..,"mean_ns":..,"max_ns":..},
+ *     ...]}
+ *
+ * Each result is the time of one operation, from batches of "ops" of them
+ * timed together on the clock of RunTimeClock.h.  min_ns is from the fastest
+ * batch, and the most repeatable.  On the MPS2 the clock counts CPU cycles,
+ * so cycles are ns * clock_hz / 10^9.
+ *
+ * Set RUN_KERNEL_BENCHMARK to 1 in main.c to run it on the MPS2 instead of
+ * the energy application, adding "-icount shift=0" to the QEMU command line
+ * to make the figures repeatable, or build the host version with
+ * "make benchmark" in Demo/Posix_GCC.
+ */
+
+/* The benchmark must run above every other task, so nothing else runs while
+ * an operation is timed. */
+#define kernelbenchPRIORITY      ( configMAX_PRIORITIES - 1 )
+#define kernelbenchSTACK_SIZE    ( configMINIMAL_STACK_SIZE * 8 )
+
+/*
+ * Run the benchmarks and print the results.  Must be called from a task of
+ * priority kernelbenchPRIORITY, created with a stack of at least
+ * kernelbenchSTACK_SIZE, once the scheduler is running.  The tasks and
+ * objects it creates are deleted before it returns.  pcTarget is the name
+ * printed for the target.
+ */
+void vKernelBenchmarkRun( const char * pcTarget );
+
+#endif /* KERNEL_BENCHMARK_H */
@@ -0,0 +1,230 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Priority based load shedding, see LoadShedding.h.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+
+/* Demo includes. */
+#include "EnergyConfig.h"
+#include "LoadShedding.h"
+
+#define shedWORD( usId )    ( ( usId ) / applianceBITS_PER_WORD )
+#define shedBIT( usId )     ( 1UL << ( ( usId ) % applianceBITS_PER_WORD ) )
+
+/* Work out the level the inputs call for, applying the release thresholds
+ * to any tier that is already in force. */
+static uint8_t prvTargetLevel( const LoadShedder_t * pxShedder,
+                               uint32_t ulSocPercent,
+                               BaseType_t xDeficit,
+                               uint32_t ulPrice );
+
+/* Power, in W, of the appliances that are off because they were shed. */
+static uint32_t prvShedLoad( const LoadShedder_t * pxShedder );
+
+/* Switch off running appliances at or below the level, and back on shed
+ * appliances above it, making no more than *puxBudget switches. */
+static void prvShed( LoadShedder_t * pxShedder,
+                     UBaseType_t * puxBudget );
+static void prvRestore( LoadShedder_t * pxShedder,
+                        UBaseType_t * puxBudget );
+
+/*-----------------------------------------------------------*/
+
+void vLoadShedderInit( LoadShedder_t * pxShedder,
+                       ApplianceRegistry_t * pxRegistry )
+{
+    memset( pxShedder, 0x00, sizeof( *pxShedder ) );
+    pxShedder->pxRegistry = pxRegistry;
+    pxShedder->ucLevel = shedNONE;
+}
+/*-----------------------------------------------------------*/
+
+void vLoadShedderUpdate( LoadShedder_t * pxShedder,
+                         uint32_t ulBatteryLevel,
+                         uint32_t ulCapacity,
+                         uint32_t ulForecastSolar,
+                         uint32_t ulPrice )
+{
+    uint32_t ulSocPercent;
+    BaseType_t xDeficit;
+    UBaseType_t uxBudget = shedMAX_SWITCHES;
+    uint8_t ucTarget;
+
+    ulSocPercent = ( ulCapacity > 0UL ) ? ( uint32_t ) ( ( ( uint64_t ) ulBatteryLevel * 100ULL ) / ulCapacity ) : 0UL;
+    /* Judged on the load that would run with nothing shed.  The load left
+     * once shedding has worked would clear the deficit, and the appliances
+     * would be restored only to be shed again a few periods later. */
+    xDeficit = ( ( ulApplianceGetTotalLoad( pxShedder->pxRegistry ) + prvShedLoad( pxShedder ) ) > ulForecastSolar ) ? pdTRUE : pdFALSE;
+
+    ucTarget = prvTargetLevel( pxShedder, ulSocPercent, xDeficit, ulPrice );
+
+    if( pxShedder->ucHold > 0U )
+    {
+        pxShedder->ucHold--;
+    }
+    else if( ucTarget != pxShedder->ucLevel )
+    {
+        pxShedder->ucLevel = ucTarget;
+        pxShedder->ucHold = shedHOLD_PERIODS;
+    }
+    else
+    {
+        /* Level unchanged. */
+    }
+
+    /* Both are run every update, not only when the level changes, so work
+     * left over by the switch budget, and appliances switched on while their
+     * priority is being shed, are picked up. */
+    prvRestore( pxShedder, &uxBudget );
+    prvShed( pxShedder, &uxBudget );
+}
+/*-----------------------------------------------------------*/
+
+uint8_t ucLoadShedderGetLevel( const LoadShedder_t * pxShedder )
+{
+    return pxShedder->ucLevel;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t prvTargetLevel( const LoadShedder_t * pxShedder,
+                               uint32_t ulSocPercent,
+                               BaseType_t xDeficit,
+                               uint32_t ulPrice )
+{
+    uint32_t ulCritical = shedSOC_CRITICAL_PERCENT;
+    uint32_t ulLow = shedSOC_LOW_PERCENT;
+    uint32_t ulPeak = shedPEAK_PRICE;
+    uint8_t ucTarget = shedNONE;
+
+    /* A tier that is in force must be cleared by a margin before it is
+     * released. */
+    if( pxShedder->ucLevel <= ( uint8_t ) ( shedPROTECTED_PRIORITY + 1U ) )
+    {
+        ulCritical += shedSOC_HYSTERESIS_PERCENT;
+    }
+
+    if( pxShedder->ucLevel <= ( uint8_t ) shedDEFERRABLE_PRIORITY )
+    {
+        ulLow += shedSOC_HYSTERESIS_PERCENT;
+        ulPeak = ( ulPeak > shedPRICE_HYSTERESIS ) ? ( ulPeak - shedPRICE_HYSTERESIS ) : 0UL;
+    }
+
+    if( xDeficit != pdFALSE )
+    {
+        if( ulSocPercent <= ulCritical )
+        {
+            ucTarget = ( uint8_t ) ( shedPROTECTED_PRIORITY + 1U );
+        }
+        else if( ( ulSocPercent <= ulLow ) || ( ulPrice >= ulPeak ) )
+        {
+            ucTarget = ( uint8_t ) shedDEFERRABLE_PRIORITY;
+        }
+        else
+        {
+            /* The battery can carry the deficit at this price. */
+        }
+    }
+
+    return ucTarget;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvShedLoad( const LoadShedder_t * pxShedder )
+{
+    uint32_t ulIndex, ulWord, ulBit;
+    uint32_t ulLoad = 0UL;
+
+    for( ulIndex = 0; ulIndex < applianceBITSET_WORDS; ulIndex++ )
+    {
+        ulWord = pxShedder->ulShed[ ulIndex ];
+
+        while( ulWord != 0UL )
+        {
+            ulBit = ( uint32_t ) __builtin_ctz( ulWord );
+            ulWord &= ~( 1UL << ulBit );
+            ulLoad += pxApplianceGet( pxShedder->pxRegistry, ( uint16_t ) ( ( ulIndex * applianceBITS_PER_WORD ) + ulBit ) )->usPower;
+        }
+    }
+
+    return ulLoad;
+}
+/*-----------------------------------------------------------*/
+
+static void prvShed( LoadShedder_t * pxShedder,
+                     UBaseType_t * puxBudget )
+{
+    uint32_t ulPriority;
+    uint16_t usId;
+
+    for( ulPriority = pxShedder->ucLevel; ulPriority < applianceNUM_PRIORITIES; ulPriority++ )
+    {
+        usId = usApplianceFindOn( pxShedder->pxRegistry, ( uint8_t ) ulPriority, 0U );
+
+        while( ( usId != applianceINVALID_ID ) && ( *puxBudget > 0U ) )
+        {
+            vApplianceSetStatus( pxShedder->pxRegistry, usId, false );
+            pxShedder->ulShed[ shedWORD( usId ) ] |= shedBIT( usId );
+            ( *puxBudget )--;
+
+            usId = usApplianceFindOn( pxShedder->pxRegistry, ( uint8_t ) ulPriority, ( uint16_t ) ( usId + 1U ) );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvRestore( LoadShedder_t * pxShedder,
+                        UBaseType_t * puxBudget )
+{
+    uint32_t ulIndex, ulWord, ulBit;
+    uint16_t usId;
+
+    for( ulIndex = 0; ulIndex < applianceBITSET_WORDS; ulIndex++ )
+    {
+        ulWord = pxShedder->ulShed[ ulIndex ];
+
+        while( ( ulWord != 0UL ) && ( *puxBudget > 0U ) )
+        {
+            ulBit = ( uint32_t ) __builtin_ctz( ulWord );
+            ulWord &= ~( 1UL << ulBit );
+            usId = ( uint16_t ) ( ( ulIndex * applianceBITS_PER_WORD ) + ulBit );
+
+            if( pxApplianceGet( pxShedder->pxRegistry, usId )->ucPriority < pxShedder->ucLevel )
+            {
+                vApplianceSetStatus( pxShedder->pxRegistry, usId, true );
+                pxShedder->ulShed[ ulIndex ] &= ~( 1UL << ulBit );
+                ( *puxBudget )--;
+            }
+        }
+    }
+}
+/*-----------------------------------------------------------*/
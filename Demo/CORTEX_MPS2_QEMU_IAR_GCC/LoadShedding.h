@@ -0,0 +1,138 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef LOAD_SHEDDING_H
+#define LOAD_SHEDDING_H
+
+/*
+ * Priority based load shedding.
+ *
+ * Once per period vLoadShedderUpdate() decides how far down the priority list
+ * appliances may run, from the battery state of charge, the forecast solar
+ * power and the energy price.  Appliances that are on with a priority number
+ * at or above that level are switched off and remembered as shed, and are
+ * switched back on when the level rises past them again.  Nothing is shed
+ * while the forecast solar power covers the load the appliances demand, which
+ * counts the ones that are off because they were shed, so shedding does not
+ * by itself end the deficit that caused it.
+ *
+ *   - state of charge at or below shedSOC_CRITICAL_PERCENT sheds everything
+ *     less important than shedPROTECTED_PRIORITY.
+ *   - state of charge at or below shedSOC_LOW_PERCENT, or a price at or above
+ *     shedPEAK_PRICE, sheds priorities from shedDEFERRABLE_PRIORITY down.
+ *
+ * shedDEFERRABLE_PRIORITY must be above shedPROTECTED_PRIORITY + 1, so the
+ * critical tier sheds the priorities between the two that the low tier keeps.
+ *
+ * Hysteresis stops the level flapping: a threshold that is already in force is
+ * only released once the state of charge is shedSOC_HYSTERESIS_PERCENT above
+ * it, or the price shedPRICE_HYSTERESIS below it, and the level is held for at
+ * least shedHOLD_PERIODS updates after every change.
+ *
+ * The worst case execution time is bounded: an update scans each priority's
+ * bitset once, the shed appliances twice, and switches at most shedMAX_SWITCHES appliances.  Anything left
+ * over is dealt with on the next update.
+ */
+
+#include "ApplianceRegistry.h"
+
+#ifndef shedPROTECTED_PRIORITY
+    #define shedPROTECTED_PRIORITY        ( 1U )  /* Priorities up to this are never shed. */
+#endif
+
+#ifndef shedDEFERRABLE_PRIORITY
+    #define shedDEFERRABLE_PRIORITY       ( 3U )  /* First priority shed for price or low charge. */
+#endif
+
+#if ( shedDEFERRABLE_PRIORITY <= ( shedPROTECTED_PRIORITY + 1U ) )
+    #error shedDEFERRABLE_PRIORITY must be above shedPROTECTED_PRIORITY + 1, or the critical tier sheds nothing more
+#endif
+
+#ifndef shedSOC_CRITICAL_PERCENT
+    #define shedSOC_CRITICAL_PERCENT      ( 10U )
+#endif
+
+#ifndef shedSOC_LOW_PERCENT
+    #define shedSOC_LOW_PERCENT           ( 30U )
+#endif
+
+#ifndef shedSOC_HYSTERESIS_PERCENT
+    #define shedSOC_HYSTERESIS_PERCENT    ( 10U )
+#endif
+
+#ifndef shedPEAK_PRICE
+    #define shedPEAK_PRICE                ( BASE_PRICE + ( PRICE_AMPLITUDE / 2 ) )
+#endif
+
+#ifndef shedPRICE_HYSTERESIS
+    #define shedPRICE_HYSTERESIS          ( 1U )
+#endif
+
+#ifndef shedHOLD_PERIODS
+    #define shedHOLD_PERIODS              ( 5U )
+#endif
+
+#ifndef shedMAX_SWITCHES
+    #define shedMAX_SWITCHES              ( 16U )
+#endif
+
+/* Level at which nothing is shed. */
+#define shedNONE                          ( ( uint8_t ) applianceNUM_PRIORITIES )
+
+typedef struct LoadShedder
+{
+    ApplianceRegistry_t * pxRegistry;
+
+    /* Bit n is set while appliance n is off because it was shed. */
+    uint32_t ulShed[ applianceBITSET_WORDS ];
+
+    /* Appliances with a priority number at or above this may not run. */
+    uint8_t ucLevel;
+
+    /* Updates left before ucLevel may change again. */
+    uint8_t ucHold;
+} LoadShedder_t;
+
+void vLoadShedderInit( LoadShedder_t * pxShedder,
+                       ApplianceRegistry_t * pxRegistry );
+
+/*
+ * Run once per period.  ulBatteryLevel and ulCapacity are in W.h,
+ * ulForecastSolar in W and ulPrice, the import price, in miliCents/W.h.
+ */
+void vLoadShedderUpdate( LoadShedder_t * pxShedder,
+                         uint32_t ulBatteryLevel,
+                         uint32_t ulCapacity,
+                         uint32_t ulForecastSolar,
+                         uint32_t ulPrice );
+
+/*
+ * Returns the current level - appliances with a priority number at or above
+ * it are being shed, shedNONE means nothing is.
+ */
+uint8_t ucLoadShedderGetLevel( const LoadShedder_t * pxShedder );
+
+#endif /* LOAD_SHEDDING_H */
@@ -0,0 +1,247 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Control loop timing, see LoopStats.h.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "LoopStats.h"
+#include "RunTimeClock.h"
+
+#if ( configNUM_THREAD_LOCAL_STORAGE_POINTERS <= loopstatsTLS_INDEX )
+    #error LoopStats.c needs a thread local storage pointer, set configNUM_THREAD_LOCAL_STORAGE_POINTERS in FreeRTOSConfig.h
+#endif
+
+#define statsMICROSECONDS    ( 1000000ULL )
+
+static void prvAdd( LoopHistogram_t * pxHistogram,
+                    uint32_t ulCounts );
+
+/*-----------------------------------------------------------*/
+
+void vLoopStatsInit( void )
+{
+    vRunTimeClockInit();
+}
+/*-----------------------------------------------------------*/
+
+void vLoopStatsRegisterTask( TaskHandle_t xTask,
+                             LoopTaskStats_t * pxStats )
+{
+    memset( pxStats, 0x00, sizeof( LoopTaskStats_t ) );
+    pxStats->ulSwitchedIn = ulRunTimeClockGet();
+    pxStats->ulReady = pxStats->ulSwitchedIn;
+
+    vTaskSetThreadLocalStoragePointer( xTask, loopstatsTLS_INDEX, pxStats );
+}
+/*-----------------------------------------------------------*/
+
+void vLoopStatsDelayed( LoopTaskStats_t * pxStats,
+                        BaseType_t xWasDelayed,
+                        TickType_t xDeadline )
+{
+    uint32_t ulLatency = ulRunTimeClockGet() - pxStats->ulReady;
+
+    taskENTER_CRITICAL();
+    {
+        pxStats->ulWakes++;
+
+        if( xWasDelayed != pdFALSE )
+        {
+            prvAdd( &( pxStats->xWakeLatency ), ulLatency );
+        }
+
+        if( ( xWasDelayed == pdFALSE ) || ( xTaskGetTickCount() != xDeadline ) )
+        {
+            pxStats->ulMissedDeadlines++;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulLoopStatsTimestamp( void )
+{
+    return ulRunTimeClockGet();
+}
+/*-----------------------------------------------------------*/
+
+void vLoopStatsAddSince( LoopHistogram_t * pxHistogram,
+                         uint32_t ulTimestamp )
+{
+    uint32_t ulCounts = ulRunTimeClockGet() - ulTimestamp;
+
+    taskENTER_CRITICAL();
+    {
+        prvAdd( pxHistogram, ulCounts );
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vLoopStatsGetTask( const LoopTaskStats_t * pxStats,
+                        LoopTaskStats_t * pxCopy )
+{
+    /* The hooks run with interrupts masked, so cannot run part way through
+     * the copy. */
+    taskENTER_CRITICAL();
+    {
+        *pxCopy = *pxStats;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vLoopStatsGetHistogram( const LoopHistogram_t * pxHistogram,
+                             LoopHistogram_t * pxCopy )
+{
+    taskENTER_CRITICAL();
+    {
+        *pxCopy = *pxHistogram;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullLoopStatsToMicroseconds( uint64_t ullCounts )
+{
+    const uint64_t ullHz = ulRunTimeClockGetHz();
+
+    /* In two parts so a long run time does not overflow. */
+    return ( ( ullCounts / ullHz ) * statsMICROSECONDS ) + ( ( ( ullCounts % ullHz ) * statsMICROSECONDS ) / ullHz );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulLoopStatsPercentile( const LoopHistogram_t * pxHistogram,
+                                uint32_t ulPercentile )
+{
+    uint64_t ullWanted, ullSeen = 0;
+    uint32_t ulBucket, ulResult = 0;
+
+    configASSERT( ulPercentile <= 100U );
+
+    if( pxHistogram->ulCount > 0U )
+    {
+        /* The number of times at or under the percentile, rounded up. */
+        ullWanted = ( ( ( uint64_t ) pxHistogram->ulCount * ulPercentile ) + 99U ) / 100U;
+
+        for( ulBucket = 0; ulBucket < loopstatsHISTOGRAM_BUCKETS; ulBucket++ )
+        {
+            ullSeen += pxHistogram->ulBuckets[ ulBucket ];
+
+            if( ullSeen >= ullWanted )
+            {
+                break;
+            }
+        }
+
+        if( ulBucket >= ( loopstatsHISTOGRAM_BUCKETS - 1U ) )
+        {
+            ulResult = UINT32_MAX;
+        }
+        else
+        {
+            /* The longest time the bucket holds. */
+            ulResult = ( 1UL << ulBucket ) - 1UL;
+        }
+
+        /* No more than the longest time recorded, which also bounds the
+         * open last bucket. */
+        ulResult = ( ulResult < pxHistogram->ulMax ) ? ulResult : pxHistogram->ulMax;
+    }
+    else
+    {
+        /* Nothing recorded. */
+    }
+
+    return ulResult;
+}
+/*-----------------------------------------------------------*/
+
+void vLoopStatsSwitchedIn( void * pvStats )
+{
+    LoopTaskStats_t * pxStats = ( LoopTaskStats_t * ) pvStats;
+
+    if( pxStats != NULL )
+    {
+        pxStats->ulSwitchedIn = ulRunTimeClockGet();
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vLoopStatsSwitchedOut( void * pvStats )
+{
+    LoopTaskStats_t * pxStats = ( LoopTaskStats_t * ) pvStats;
+
+    if( pxStats != NULL )
+    {
+        pxStats->ullRunTime += ( uint64_t ) ( ulRunTimeClockGet() - pxStats->ulSwitchedIn );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vLoopStatsReady( void * pvStats )
+{
+    LoopTaskStats_t * pxStats = ( LoopTaskStats_t * ) pvStats;
+
+    if( pxStats != NULL )
+    {
+        pxStats->ulReady = ulRunTimeClockGet();
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvAdd( LoopHistogram_t * pxHistogram,
+                    uint32_t ulCounts )
+{
+    uint32_t ulMicroseconds = ( uint32_t ) ullLoopStatsToMicroseconds( ulCounts );
+    uint32_t ulBucket = 0, ulRemaining = ulMicroseconds;
+
+    /* The bucket is the number of bits the time needs. */
+    while( ( ulRemaining != 0U ) && ( ulBucket < ( loopstatsHISTOGRAM_BUCKETS - 1U ) ) )
+    {
+        ulRemaining >>= 1;
+        ulBucket++;
+    }
+
+    pxHistogram->ulBuckets[ ulBucket ]++;
+    pxHistogram->ulCount++;
+    pxHistogram->ullTotal += ulMicroseconds;
+
+    if( ulMicroseconds > pxHistogram->ulMax )
+    {
+        pxHistogram->ulMax = ulMicroseconds;
+    }
+}
+/*-----------------------------------------------------------*/
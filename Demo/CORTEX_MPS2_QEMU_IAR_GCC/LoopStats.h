@@ -0,0 +1,145 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef LOOP_STATS_H
+#define LOOP_STATS_H
+
+/*
+ * Timing of the energy control loop, measured on the high resolution clock of
+ * RunTimeClock.h:
+ *
+ * - the CPU time of each monitored task, accumulated as the kernel switches
+ *   it in and out;
+ * - a histogram of each periodic task's wake latency, the time from the kernel
+ *   making it ready at the tick of its deadline to it running, and a count of
+ *   the wakes that missed their deadline tick altogether;
+ * - histograms of how long samples wait in a queue before they are received.
+ *
+ * The kernel reports switches and wakes through the traceTASK_SWITCHED_IN,
+ * traceTASK_SWITCHED_OUT and traceMOVED_TASK_TO_READY_STATE hooks in
+ * TraceHooks.h, which find a task's record through its thread local
+ * storage pointer loopstatsTLS_INDEX.  Tasks that are not registered with
+ * vLoopStatsRegisterTask() cost the hooks a NULL check.
+ */
+
+/* Thread local storage pointer of a monitored task that holds its record. */
+#define loopstatsTLS_INDEX            ( 0 )
+
+/* Bucket 0 counts times under 1us, bucket n times from 2^(n-1)us up to 2^n us
+ * and the last bucket everything longer. */
+#define loopstatsHISTOGRAM_BUCKETS    ( 16U )
+
+typedef struct LoopHistogram
+{
+    uint32_t ulBuckets[ loopstatsHISTOGRAM_BUCKETS ];
+    uint32_t ulCount;
+    uint32_t ulMax;    /* Longest, in us. */
+    uint64_t ullTotal; /* Sum, in us. */
+} LoopHistogram_t;
+
+typedef struct LoopTaskStats
+{
+    /* Clock counts the task has run for, and the counts when it was last
+     * switched in and last made ready. */
+    uint64_t ullRunTime;
+    uint32_t ulSwitchedIn;
+    uint32_t ulReady;
+
+    uint32_t ulWakes;
+    uint32_t ulMissedDeadlines;
+    LoopHistogram_t xWakeLatency;
+} LoopTaskStats_t;
+
+/*
+ * Start the clock.  Must be called before the scheduler is started.
+ */
+void vLoopStatsInit( void );
+
+/*
+ * Record the timing of xTask in pxStats, which must remain valid for as long
+ * as the task exists.  Can be called before the scheduler is started.
+ */
+void vLoopStatsRegisterTask( TaskHandle_t xTask,
+                             LoopTaskStats_t * pxStats );
+
+/*
+ * Called by a monitored periodic task when xTaskDelayUntil() returns, with
+ * the value it returned and the tick the task was due at.  If the task blocked
+ * the time since it was made ready is added to its wake latency.  If it ran at
+ * a later tick, or did not block as it was already late, it missed its
+ * deadline.
+ */
+void vLoopStatsDelayed( LoopTaskStats_t * pxStats,
+                        BaseType_t xWasDelayed,
+                        TickType_t xDeadline );
+
+/*
+ * Returns the current clock count, to time a sample from when it is queued.
+ */
+uint32_t ulLoopStatsTimestamp( void );
+
+/*
+ * Add the time since ulTimestamp, from ulLoopStatsTimestamp(), to
+ * pxHistogram.
+ */
+void vLoopStatsAddSince( LoopHistogram_t * pxHistogram,
+                         uint32_t ulTimestamp );
+
+/*
+ * Copy pxStats into pxCopy, consistently with the hooks that update it.
+ */
+void vLoopStatsGetTask( const LoopTaskStats_t * pxStats,
+                        LoopTaskStats_t * pxCopy );
+
+/*
+ * Copy pxHistogram into pxCopy.
+ */
+void vLoopStatsGetHistogram( const LoopHistogram_t * pxHistogram,
+                             LoopHistogram_t * pxCopy );
+
+/*
+ * Returns ullCounts of the clock in us.
+ */
+uint64_t ullLoopStatsToMicroseconds( uint64_t ullCounts );
+
+/*
+ * Returns the latency, in us, that ulPercentile percent of the times in
+ * pxHistogram are at or under, to the resolution of its buckets: the longest
+ * time of the bucket the percentile falls in, or the longest time recorded if
+ * that is less.
+ */
+uint32_t ulLoopStatsPercentile( const LoopHistogram_t * pxHistogram,
+                                uint32_t ulPercentile );
+
+/*
+ * For the trace hooks in TraceHooks.h only.  pvStats is the thread local
+ * storage pointer of the task being switched or made ready.
+ */
+void vLoopStatsSwitchedIn( void * pvStats );
+void vLoopStatsSwitchedOut( void * pvStats );
+void vLoopStatsReady( void * pvStats );
+
+#endif /* LOOP_STATS_H */
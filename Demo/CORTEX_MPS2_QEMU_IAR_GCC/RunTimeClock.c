@@ -0,0 +1,77 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * High resolution clock on CMSDK timer 1, see RunTimeClock.h.
+ *
+ * The timer counts down from its reload value at the CPU clock and reloads
+ * when it reaches zero.  With the largest reload value it never has to be
+ * serviced, so the interrupt is left disabled and the count is just read.
+ */
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+
+/* Demo includes. */
+#include "RunTimeClock.h"
+
+/* Library includes. */
+#include "SMM_MPS2.h"
+
+#define clockCTRL_ENABLE    ( 1UL << 0UL )
+
+/*-----------------------------------------------------------*/
+
+void vRunTimeClockInit( void )
+{
+    /* The kernel starts the clock again for its run time stats, which must
+     * not reset a clock that is already counting. */
+    if( ( CMSDK_TIMER1->CTRL & clockCTRL_ENABLE ) == 0 )
+    {
+        CMSDK_TIMER1->INTCLEAR = ( 1UL << 0UL );
+        CMSDK_TIMER1->RELOAD = UINT32_MAX;
+        CMSDK_TIMER1->VALUE = UINT32_MAX;
+        CMSDK_TIMER1->CTRL = clockCTRL_ENABLE;
+    }
+    else
+    {
+        /* Already running. */
+    }
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulRunTimeClockGet( void )
+{
+    /* Turn the down count into an up count. */
+    return UINT32_MAX - CMSDK_TIMER1->VALUE;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulRunTimeClockGetHz( void )
+{
+    return ( uint32_t ) configCPU_CLOCK_HZ;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,57 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef RUN_TIME_CLOCK_H
+#define RUN_TIME_CLOCK_H
+
+/*
+ * Free running high resolution clock for measuring how long the tasks run and
+ * how late they wake, much finer than the tick.  On the MPS2 it is CMSDK
+ * timer 1 counting the CPU clock, see RunTimeClock.c.  The Posix build has
+ * its own RunTimeClock.c on the host's monotonic clock.
+ *
+ * The count wraps, so only differences between two readings less than a wrap
+ * apart mean anything.  On the MPS2 a wrap is 2^32 cycles, just under three
+ * minutes, and on the host 2^32 nanoseconds, just over four seconds.
+ */
+
+/*
+ * Start the clock.  Must be called before the scheduler is started, and
+ * before anything else reads it.
+ */
+void vRunTimeClockInit( void );
+
+/*
+ * Returns the current count.  Can be called from tasks and interrupts.
+ */
+uint32_t ulRunTimeClockGet( void );
+
+/*
+ * Returns the number of counts in a second.
+ */
+uint32_t ulRunTimeClockGetHz( void );
+
+#endif /* RUN_TIME_CLOCK_H */
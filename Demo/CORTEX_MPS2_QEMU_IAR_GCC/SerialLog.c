@@ -0,0 +1,210 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Interrupt driven console output for the MPS2 UART.  See SerialLog.h.
+ *
+ * The stream buffer has a single writer and a single reader.  Writers are
+ * serialised by suspending the scheduler, which keeps interrupts enabled while
+ * the data is copied, and the UART TX interrupt is the only reader.  When the
+ * transmitter is idle a writer does not touch the UART itself - it pends the TX
+ * interrupt, and the handler sends the first byte.
+ */
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+
+/* Demo includes. */
+#include "SerialLog.h"
+
+/* Library includes. */
+#include "SMM_MPS2.h"
+
+/* Size of the buffer that holds text waiting to be sent. */
+#define serialBUFFER_SIZE       ( 1024 )
+
+#define serialCTRL_TX_ENABLE    ( 1UL << 0UL )
+#define serialCTRL_TX_IRQ       ( 1UL << 2UL )
+#define serialSTATE_TX_FULL     ( 1UL << 0UL )
+#define serialINT_TX            ( 1UL << 0UL )
+
+void UART0TX_Handler( void );
+
+static void prvWritePolled( const uint8_t * pucData,
+                            size_t xLength );
+
+static StreamBufferHandle_t xLogStream = NULL;
+
+/* pdTRUE when the TX interrupt has found the buffer empty and stopped. */
+static volatile BaseType_t xTransmitterIdle = pdTRUE;
+
+/* Once set, output bypasses the buffer - see vSerialLogPanic(). */
+static volatile BaseType_t xPolledOutput = pdFALSE;
+
+static uint32_t ulDroppedBytes = 0;
+
+/*-----------------------------------------------------------*/
+
+void vSerialLogInit( void )
+{
+    static uint8_t ucStorage[ serialBUFFER_SIZE + 1 ];
+    static StaticStreamBuffer_t xStreamBufferStruct;
+
+    xLogStream = xStreamBufferCreateStatic( serialBUFFER_SIZE, 1, ucStorage, &xStreamBufferStruct );
+
+    CMSDK_UART0->BAUDDIV = 16;
+    CMSDK_UART0->CTRL = serialCTRL_TX_ENABLE | serialCTRL_TX_IRQ;
+
+    NVIC_SetPriority( UARTTX0_IRQn, configMAX_SYSCALL_INTERRUPT_PRIORITY );
+    NVIC_EnableIRQ( UARTTX0_IRQn );
+}
+/*-----------------------------------------------------------*/
+
+size_t xSerialLogWrite( const void * pvData,
+                        size_t xLength )
+{
+    size_t xSent = 0;
+    BaseType_t xStart = pdFALSE;
+
+    if( ( xPolledOutput != pdFALSE ) || ( xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED ) )
+    {
+        prvWritePolled( ( const uint8_t * ) pvData, xLength );
+        xSent = xLength;
+    }
+    else
+    {
+        vTaskSuspendAll();
+        {
+            /* Only accept the write if all of it fits, so lines are never
+             * split. */
+            if( xStreamBufferSpacesAvailable( xLogStream ) >= xLength )
+            {
+                xSent = xStreamBufferSend( xLogStream, pvData, xLength, 0 );
+
+                if( xTransmitterIdle != pdFALSE )
+                {
+                    xTransmitterIdle = pdFALSE;
+                    xStart = pdTRUE;
+                }
+            }
+            else
+            {
+                ulDroppedBytes += ( uint32_t ) xLength;
+            }
+        }
+        ( void ) xTaskResumeAll();
+
+        if( xStart != pdFALSE )
+        {
+            NVIC_SetPendingIRQ( UARTTX0_IRQn );
+        }
+    }
+
+    return xSent;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulSerialLogGetDroppedBytes( void )
+{
+    return ulDroppedBytes;
+}
+/*-----------------------------------------------------------*/
+
+void vSerialLogPanic( void )
+{
+    uint8_t ucByte;
+    BaseType_t xUnused = pdFALSE;
+
+    NVIC_DisableIRQ( UARTTX0_IRQn );
+    xPolledOutput = pdTRUE;
+
+    /* The hooks can run from an interrupt or with the scheduler in any state,
+     * and with the TX interrupt disabled this is now the only reader, so the
+     * FromISR version is used as it never touches the scheduler. */
+    while( xStreamBufferReceiveFromISR( xLogStream, &ucByte, sizeof( ucByte ), &xUnused ) != 0 )
+    {
+        prvWritePolled( &ucByte, sizeof( ucByte ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void UART0TX_Handler( void )
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    uint8_t ucByte;
+
+    CMSDK_UART0->INTCLEAR = serialINT_TX;
+
+    /* The handler is also entered when a writer pends it, in which case the
+     * transmitter is already empty. */
+    if( ( CMSDK_UART0->STATE & serialSTATE_TX_FULL ) == 0 )
+    {
+        if( xStreamBufferReceiveFromISR( xLogStream, &ucByte, sizeof( ucByte ), &xHigherPriorityTaskWoken ) != 0 )
+        {
+            CMSDK_UART0->DATA = ucByte;
+        }
+        else
+        {
+            xTransmitterIdle = pdTRUE;
+        }
+    }
+
+    portEND_SWITCHING_ISR( xHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
+
+static void prvWritePolled( const uint8_t * pucData,
+                            size_t xLength )
+{
+    size_t x;
+
+    for( x = 0; x < xLength; x++ )
+    {
+        while( ( CMSDK_UART0->STATE & serialSTATE_TX_FULL ) != 0 )
+        {
+        }
+
+        CMSDK_UART0->DATA = pucData[ x ];
+    }
+}
+/*-----------------------------------------------------------*/
+
+int __write( int iFile,
+             char * pcString,
+             int iStringLength )
+{
+    /* Avoid compiler warnings about unused parameters. */
+    ( void ) iFile;
+
+    /* Dropped text is reported as written so callers do not retry - the loss
+     * is recorded in ulDroppedBytes instead. */
+    ( void ) xSerialLogWrite( pcString, ( size_t ) iStringLength );
+
+    return iStringLength;
+}
+/*-----------------------------------------------------------*/
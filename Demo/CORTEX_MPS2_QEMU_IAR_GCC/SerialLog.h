@@ -0,0 +1,63 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef SERIAL_LOG_H
+#define SERIAL_LOG_H
+
+/*
+ * Non-blocking console output.  Text written by the tasks is copied into a
+ * stream buffer and the UART TX interrupt drains it one byte at a time, so a
+ * task never waits for the serial port.  If the buffer does not have room for
+ * a whole write the write is dropped, rather than blocking or splitting the
+ * line, and the number of bytes lost is counted.
+ */
+
+/*
+ * Initialise the UART and the log buffer.  Must be called before anything is
+ * written.
+ */
+void vSerialLogInit( void );
+
+/*
+ * Queue xLength bytes for transmission.  Returns the number of bytes
+ * accepted, which is either xLength or 0 if the write was dropped.  Output
+ * written before the scheduler starts is sent synchronously.
+ */
+size_t xSerialLogWrite( const void * pvData,
+                        size_t xLength );
+
+/*
+ * Returns the total number of bytes dropped because the buffer was full.
+ */
+uint32_t ulSerialLogGetDroppedBytes( void );
+
+/*
+ * Send anything still buffered and switch to polled output from then on.
+ * For use by the fault hooks, which print and then disable interrupts.
+ */
+void vSerialLogPanic( void );
+
+#endif /* SERIAL_LOG_H */
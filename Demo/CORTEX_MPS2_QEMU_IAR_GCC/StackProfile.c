@@ -0,0 +1,137 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Stack profiler, see StackProfile.h.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "StackProfile.h"
+
+#if ( configUSE_TRACE_FACILITY != 1 ) || ( configRECORD_STACK_HIGH_ADDRESS != 1 )
+    #error StackProfile.c needs configUSE_TRACE_FACILITY and configRECORD_STACK_HIGH_ADDRESS set to 1 in FreeRTOSConfig.h
+#endif
+
+/* The sampler takes no time from the tasks it measures. */
+#define stackPRIORITY      ( tskIDLE_PRIORITY )
+#define stackSTACK_SIZE    ( configMINIMAL_STACK_SIZE * 2 )
+
+/* The most of its stack each task followed has used, by task number. */
+typedef struct StackRecord
+{
+    UBaseType_t uxTaskNumber;
+    configSTACK_DEPTH_TYPE uxLeast; /* Words left free at most. */
+} StackRecord_t;
+
+/* Samples the stacks. */
+static void prvStackProfileTask( void * pvParameters );
+
+/* Check the high water mark of a task, printing it if it is lower than
+ * before. */
+static void prvCheck( const TaskStatus_t * pxStatus );
+
+/* Kept here rather than on the sampler's stack, so it can stay small. */
+static TaskStatus_t xStatus[ stackprofileMAX_TASKS ];
+static StackRecord_t xRecords[ stackprofileMAX_TASKS ];
+static UBaseType_t uxRecords = 0;
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xStackProfileStart( TickType_t xPeriod )
+{
+    static TickType_t xSamplePeriod;
+
+    configASSERT( xPeriod > 0U );
+
+    xSamplePeriod = xPeriod;
+
+    return xTaskCreate( prvStackProfileTask, "StackProf", stackSTACK_SIZE, &xSamplePeriod, stackPRIORITY, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvStackProfileTask( void * pvParameters )
+{
+    const TickType_t xPeriod = *( ( const TickType_t * ) pvParameters );
+    UBaseType_t uxTasks, uxTask;
+
+    for( ; ; )
+    {
+        /* Suspends the scheduler while it walks the task lists. */
+        uxTasks = uxTaskGetSystemState( xStatus, stackprofileMAX_TASKS, NULL );
+
+        for( uxTask = 0; uxTask < uxTasks; uxTask++ )
+        {
+            prvCheck( &( xStatus[ uxTask ] ) );
+        }
+
+        vTaskDelay( xPeriod );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvCheck( const TaskStatus_t * pxStatus )
+{
+    const configSTACK_DEPTH_TYPE uxSize = ( configSTACK_DEPTH_TYPE ) ( pxStatus->pxEndOfStack - pxStatus->pxStackBase + 1 );
+    StackRecord_t * pxRecord = NULL;
+    UBaseType_t uxRecord;
+
+    for( uxRecord = 0; uxRecord < uxRecords; uxRecord++ )
+    {
+        if( xRecords[ uxRecord ].uxTaskNumber == pxStatus->xTaskNumber )
+        {
+            pxRecord = &( xRecords[ uxRecord ] );
+            break;
+        }
+    }
+
+    if( ( pxRecord == NULL ) && ( uxRecords < stackprofileMAX_TASKS ) )
+    {
+        pxRecord = &( xRecords[ uxRecords ] );
+        pxRecord->uxTaskNumber = pxStatus->xTaskNumber;
+        pxRecord->uxLeast = uxSize;
+        uxRecords++;
+    }
+
+    if( ( pxRecord != NULL ) && ( pxStatus->usStackHighWaterMark < pxRecord->uxLeast ) )
+    {
+        pxRecord->uxLeast = pxStatus->usStackHighWaterMark;
+
+        printf( "stack,%s,%u,%u\r\n", pxStatus->pcTaskName, ( unsigned ) uxSize,
+                ( unsigned ) ( uxSize - pxStatus->usStackHighWaterMark ) );
+    }
+    else
+    {
+        /* Not followed, or no more used than before. */
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,60 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef STACK_PROFILE_H
+#define STACK_PROFILE_H
+
+/*
+ * Measures how much of its stack every task uses.  A low priority task asks
+ * the kernel for the high water mark of each task - the least stack it has
+ * ever had free, from the fill pattern left below the stack pointer - every
+ * sample period.  Whenever a task is seen to have used more than before it
+ * prints a line:
+ *
+ *   stack,<task name>,<stack size in words>,<words used>
+ *
+ * so the last line printed for a task is the most it has used.  Tasks that
+ * share a name, those of different households say, are told apart by the
+ * kernel's task numbers but printed alike.  tools/stack_usage.py reads the
+ * lines from a capture of the serial port and combines them with the
+ * compiler's own figures to recommend a size for each task's stack.
+ *
+ * Only the MPS2 build has it.  The Posix port runs each task on a stack of
+ * the host's, so the kernel's high water marks say nothing there.
+ */
+
+/* Most tasks followed.  Tasks beyond are not. */
+#ifndef stackprofileMAX_TASKS
+    #define stackprofileMAX_TASKS    ( 24U )
+#endif
+
+/*
+ * Start sampling the stacks every xPeriod ticks.  Returns pdFAIL if the
+ * sampling task could not be created.
+ */
+BaseType_t xStackProfileStart( TickType_t xPeriod );
+
+#endif /* STACK_PROFILE_H */
@@ -0,0 +1,174 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Energy tariffs, see Tariff.h.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+
+/* Demo includes. */
+#include "Tariff.h"
+
+#define tariffMINUTES_PER_DAY    ( 24U * 60U )
+
+/* Index of the slot holding xTime. */
+#define tariffSLOT( pxTariff, xTime )    ( ( size_t ) ( ( ( xTime ) % ( pxTariff )->xDayTicks ) / ( pxTariff )->xSlotTicks ) )
+
+/*-----------------------------------------------------------*/
+
+void vTariffCompile( Tariff_t * pxTariff,
+                     const TariffDefinition_t * pxDefinition,
+                     TickType_t xDayTicks )
+{
+    size_t xSlot, xPeriod, xTier;
+    uint32_t ulMinute;
+    TickType_t xStart;
+
+    configASSERT( ( xDayTicks >= tariffSLOTS_PER_DAY ) && ( ( xDayTicks % tariffSLOTS_PER_DAY ) == 0 ) );
+    configASSERT( ( pxDefinition->pxPeriods == NULL ) || ( pxDefinition->xNumPeriods > 0 ) );
+
+    memset( pxTariff, 0x00, sizeof( *pxTariff ) );
+    pxTariff->xDayTicks = xDayTicks;
+    pxTariff->xSlotTicks = xDayTicks / tariffSLOTS_PER_DAY;
+    pxTariff->ulDailyCharge = pxDefinition->ulDailyCharge;
+    pxTariff->ulDay = UINT32_MAX;
+
+    for( xSlot = 0; xSlot < tariffSLOTS_PER_DAY; xSlot++ )
+    {
+        xStart = ( TickType_t ) xSlot * pxTariff->xSlotTicks;
+
+        if( pxDefinition->pxPeriods != NULL )
+        {
+            /* The last period to have started, or the last of the day before
+             * if none has yet. */
+            ulMinute = ( uint32_t ) ( ( xSlot * tariffMINUTES_PER_DAY ) / tariffSLOTS_PER_DAY );
+            xPeriod = pxDefinition->xNumPeriods - 1U;
+
+            while( ( xPeriod > 0U ) && ( pxDefinition->pxPeriods[ xPeriod ].usStartMinute > ulMinute ) )
+            {
+                xPeriod--;
+            }
+
+            if( pxDefinition->pxPeriods[ xPeriod ].usStartMinute > ulMinute )
+            {
+                xPeriod = pxDefinition->xNumPeriods - 1U;
+            }
+
+            pxTariff->lImport[ xSlot ] = pxDefinition->pxPeriods[ xPeriod ].lImport;
+            pxTariff->lExport[ xSlot ] = pxDefinition->pxPeriods[ xPeriod ].lExport;
+        }
+        else
+        {
+            pxTariff->lImport[ xSlot ] = lEnergyCurveEvaluate( &( pxDefinition->xImportCurve ), xStart );
+            pxTariff->lExport[ xSlot ] = lEnergyCurveEvaluate( &( pxDefinition->xExportCurve ), xStart );
+        }
+    }
+
+    /* Tiers beyond the supported number are ignored. */
+    for( xTier = 0; ( xTier < pxDefinition->xNumTiers ) && ( xTier < tariffMAX_TIERS ); xTier++ )
+    {
+        configASSERT( ( xTier == 0U ) || ( pxDefinition->pxTiers[ xTier ].ulFrom >= pxDefinition->pxTiers[ xTier - 1U ].ulFrom ) );
+        pxTariff->xTiers[ xTier ] = pxDefinition->pxTiers[ xTier ];
+    }
+
+    pxTariff->xNumTiers = xTier;
+}
+/*-----------------------------------------------------------*/
+
+int32_t lTariffImportPrice( const Tariff_t * pxTariff,
+                            TickType_t xTime )
+{
+    return pxTariff->lImport[ tariffSLOT( pxTariff, xTime ) ];
+}
+/*-----------------------------------------------------------*/
+
+int32_t lTariffExportPrice( const Tariff_t * pxTariff,
+                            TickType_t xTime )
+{
+    return pxTariff->lExport[ tariffSLOT( pxTariff, xTime ) ];
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulTariffGetSlot( const Tariff_t * pxTariff,
+                          TickType_t xTime )
+{
+    return ( uint32_t ) ( xTime / pxTariff->xSlotTicks );
+}
+/*-----------------------------------------------------------*/
+
+int32_t lTariffSettle( Tariff_t * pxTariff,
+                       TickType_t xTime,
+                       int32_t lEnergy )
+{
+    size_t xSlot = tariffSLOT( pxTariff, xTime );
+    uint32_t ulDay = ( uint32_t ) ( xTime / pxTariff->xDayTicks );
+    uint32_t ulBought, ulAbove, ulTiered;
+    int32_t lChange = 0;
+    size_t xTier;
+
+    /* Charge for each day started since the last transaction, and start
+     * counting the tiers again. */
+    if( ulDay != pxTariff->ulDay )
+    {
+        lChange -= ( int32_t ) ( pxTariff->ulDailyCharge * ( ( pxTariff->ulDay == UINT32_MAX ) ? ( ulDay + 1U ) : ( ulDay - pxTariff->ulDay ) ) );
+        pxTariff->ulDay = ulDay;
+        pxTariff->ulImportedToday = 0;
+    }
+
+    if( lEnergy >= 0 )
+    {
+        lChange += lEnergy * pxTariff->lExport[ xSlot ];
+    }
+    else
+    {
+        ulBought = ( uint32_t ) -lEnergy;
+        lChange -= ( int32_t ) ulBought * pxTariff->lImport[ xSlot ];
+
+        /* Add the surcharge of each tier for the part of this energy that
+         * falls above its limit. */
+        for( xTier = 0; xTier < pxTariff->xNumTiers; xTier++ )
+        {
+            ulAbove = pxTariff->ulImportedToday + ulBought;
+
+            if( ulAbove > pxTariff->xTiers[ xTier ].ulFrom )
+            {
+                ulAbove -= pxTariff->xTiers[ xTier ].ulFrom;
+                ulTiered = ( ulAbove < ulBought ) ? ulAbove : ulBought;
+                lChange -= ( int32_t ) ulTiered * pxTariff->xTiers[ xTier ].lSurcharge;
+            }
+        }
+
+        pxTariff->ulImportedToday += ulBought;
+    }
+
+    return lChange;
+}
+/*-----------------------------------------------------------*/
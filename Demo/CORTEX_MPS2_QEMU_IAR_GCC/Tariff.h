@@ -0,0 +1,137 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef TARIFF_H
+#define TARIFF_H
+
+/*
+ * Energy tariffs.
+ *
+ * A tariff has separate prices for energy bought from the grid (import) and
+ * sold to it (export), both in miliCents/W.h.  The prices either follow a pair
+ * of curves, for a dynamic tariff, or a time of use schedule of fixed prices
+ * that change at set times of the day.  On top of that imports can be tiered,
+ * costing more once the energy bought in the day passes each tier's limit,
+ * and there can be a fixed charge for each day.
+ *
+ * The definition is compiled once into a table of import and export prices
+ * for each of tariffSLOTS_PER_DAY slots, so pricing a transaction is a table
+ * read and a multiply instead of evaluating a curve or searching the
+ * schedule.  Each slot takes the price at its start.
+ */
+
+#include "EnergyCurve.h"
+
+#ifndef tariffSLOTS_PER_DAY
+    #define tariffSLOTS_PER_DAY    ( 120U )
+#endif
+
+#ifndef tariffMAX_TIERS
+    #define tariffMAX_TIERS        ( 4U )
+#endif
+
+/* A period of a time of use schedule.  It lasts until the start of the next
+ * period, and the last one runs on into the first one of the next day. */
+typedef struct TariffPeriod
+{
+    uint16_t usStartMinute; /* Minutes after midnight. */
+    int32_t lImport;        /* miliCents/W.h */
+    int32_t lExport;        /* miliCents/W.h */
+} TariffPeriod_t;
+
+/* An import tier.  Energy bought in a day once ulFrom W.h have been bought
+ * costs lSurcharge miliCents/W.h more, on top of the surcharges of the tiers
+ * below. */
+typedef struct TariffTier
+{
+    uint32_t ulFrom;
+    int32_t lSurcharge;
+} TariffTier_t;
+
+typedef struct TariffDefinition
+{
+    EnergyCurve_t xImportCurve;       /* Used unless there is a schedule. */
+    EnergyCurve_t xExportCurve;
+    const TariffPeriod_t * pxPeriods; /* Time of use schedule in order of start, or NULL. */
+    size_t xNumPeriods;
+    const TariffTier_t * pxTiers;     /* Import tiers in order of ulFrom, or NULL. */
+    size_t xNumTiers;
+    uint32_t ulDailyCharge;           /* miliCents charged for each day. */
+} TariffDefinition_t;
+
+/* A compiled tariff, and the running state needed to settle transactions. */
+typedef struct Tariff
+{
+    TickType_t xDayTicks;
+    TickType_t xSlotTicks;
+    int32_t lImport[ tariffSLOTS_PER_DAY ];
+    int32_t lExport[ tariffSLOTS_PER_DAY ];
+    TariffTier_t xTiers[ tariffMAX_TIERS ];
+    size_t xNumTiers;
+    uint32_t ulDailyCharge;
+
+    /* Day of the last transaction settled, and the energy bought in it. */
+    uint32_t ulDay;
+    uint32_t ulImportedToday;
+} Tariff_t;
+
+/*
+ * Build the price tables of pxTariff from pxDefinition, for days of xDayTicks
+ * ticks.  xDayTicks must be a multiple of tariffSLOTS_PER_DAY.  Nothing that
+ * pxDefinition points to is kept.
+ */
+void vTariffCompile( Tariff_t * pxTariff,
+                     const TariffDefinition_t * pxDefinition,
+                     TickType_t xDayTicks );
+
+/*
+ * Price of importing and exporting energy at xTime, in miliCents/W.h, before
+ * any tier surcharge.
+ */
+int32_t lTariffImportPrice( const Tariff_t * pxTariff,
+                            TickType_t xTime );
+int32_t lTariffExportPrice( const Tariff_t * pxTariff,
+                            TickType_t xTime );
+
+/*
+ * Returns the number of the slot holding xTime, counting from the one starting
+ * at tick 0.  Energy traded in the same slot is priced alike, so can be netted
+ * before it is settled.
+ */
+uint32_t ulTariffGetSlot( const Tariff_t * pxTariff,
+                          TickType_t xTime );
+
+/*
+ * Settle lEnergy W.h traded at xTime, positive if sold and negative if bought.
+ * Returns the change to the bill in miliCents, positive for income, including
+ * the fixed charge of any day this is the first transaction of.  Transactions
+ * must be settled in time order, from a single task.
+ */
+int32_t lTariffSettle( Tariff_t * pxTariff,
+                       TickType_t xTime,
+                       int32_t lEnergy );
+
+#endif /* TARIFF_H */
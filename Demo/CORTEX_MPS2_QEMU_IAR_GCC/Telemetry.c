@@ -0,0 +1,160 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Telemetry snapshots, see Telemetry.h for the frame format.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "EnergyConfig.h"
+#include "SerialLog.h"
+#include "Telemetry.h"
+
+#define telemetryHEADER_SIZE     ( 4U )
+#define telemetryCHECKSUM_SIZE   ( 2U )
+#define telemetryFRAME_SIZE      ( telemetryHEADER_SIZE + sizeof( TelemetrySample_t ) + telemetryCHECKSUM_SIZE )
+
+/* Latest value published by each task.  Every field but the bill is a single
+ * aligned word, so it is never torn, and the bill is written and read in a
+ * critical section.  A snapshot can still mix values from neighbouring sample
+ * periods. */
+static volatile TelemetrySample_t xLatest;
+
+/*-----------------------------------------------------------*/
+
+void vTelemetrySetBatteryLevel( int32_t lBatteryLevel )
+{
+    xLatest.lBatteryLevel = lBatteryLevel;
+}
+/*-----------------------------------------------------------*/
+
+void vTelemetrySetBill( int64_t llBill )
+{
+    taskENTER_CRITICAL();
+    {
+        xLatest.llBill = llBill;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vTelemetrySetSolarPower( uint32_t ulSolarPower )
+{
+    xLatest.ulSolarPower = ulSolarPower;
+}
+/*-----------------------------------------------------------*/
+
+void vTelemetrySetLoadPower( uint32_t ulLoadPower )
+{
+    xLatest.ulLoadPower = ulLoadPower;
+}
+/*-----------------------------------------------------------*/
+
+#if ( TELEMETRY_BINARY == 1 )
+
+    void vTelemetryEmit( TickType_t xTick )
+    {
+        uint8_t ucFrame[ telemetryFRAME_SIZE ];
+        TelemetrySample_t xSample;
+        uint16_t usSum1 = 0, usSum2 = 0;
+        size_t x;
+
+        xSample.ulTick = ( uint32_t ) xTick;
+        xSample.lBatteryLevel = xLatest.lBatteryLevel;
+        taskENTER_CRITICAL();
+        {
+            xSample.llBill = xLatest.llBill;
+        }
+        taskEXIT_CRITICAL();
+        xSample.ulSolarPower = xLatest.ulSolarPower;
+        xSample.ulLoadPower = xLatest.ulLoadPower;
+
+        ucFrame[ 0 ] = telemetrySYNC_0;
+        ucFrame[ 1 ] = telemetrySYNC_1;
+        ucFrame[ 2 ] = telemetryVERSION;
+        ucFrame[ 3 ] = ( uint8_t ) sizeof( TelemetrySample_t );
+
+        /* Both supported targets are little endian, so the structure can be
+         * copied as it is. */
+        memcpy( &ucFrame[ telemetryHEADER_SIZE ], &xSample, sizeof( xSample ) );
+
+        for( x = 2; x < ( telemetryHEADER_SIZE + sizeof( xSample ) ); x++ )
+        {
+            usSum1 = ( uint16_t ) ( ( usSum1 + ucFrame[ x ] ) % 255U );
+            usSum2 = ( uint16_t ) ( ( usSum2 + usSum1 ) % 255U );
+        }
+
+        ucFrame[ telemetryFRAME_SIZE - 2U ] = ( uint8_t ) usSum1;
+        ucFrame[ telemetryFRAME_SIZE - 1U ] = ( uint8_t ) usSum2;
+
+        ( void ) xSerialLogWrite( ucFrame, sizeof( ucFrame ) );
+    }
+
+#else /* TELEMETRY_BINARY */
+
+    void vTelemetryEmit( TickType_t xTick )
+    {
+        int64_t llBill;
+
+        taskENTER_CRITICAL();
+        {
+            llBill = xLatest.llBill / 100;
+        }
+        taskEXIT_CRITICAL();
+
+        /* The MPS2's printf has no 64 bit conversions, so the bill in cents
+         * saturates at 32 bits here.  The binary frames carry all of it. */
+        if( llBill > INT32_MAX )
+        {
+            llBill = INT32_MAX;
+        }
+        else if( llBill < INT32_MIN )
+        {
+            llBill = INT32_MIN;
+        }
+        else
+        {
+            /* The bill fits. */
+        }
+
+        printf( "Tick: %u Battery Level: %d Bill: %ld Solar: %u Load: %u\n",
+                ( unsigned ) xTick,
+                ( int ) xLatest.lBatteryLevel,
+                ( long ) llBill,
+                ( unsigned ) xLatest.ulSolarPower,
+                ( unsigned ) xLatest.ulLoadPower );
+    }
+
+#endif /* TELEMETRY_BINARY */
+/*-----------------------------------------------------------*/
@@ -0,0 +1,74 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+/*
+ * Periodic state reports from the energy tasks.  Each task publishes the
+ * values it owns with the vTelemetrySet...() functions, which are single word
+ * writes and so cost almost nothing, and vTelemetryEmit() sends a snapshot of
+ * all of them.
+ *
+ * With TELEMETRY_BINARY set to 1 in EnergyConfig.h the snapshot is sent as a
+ * binary frame rather than formatted text:
+ *
+ *   0xA5 0x5A  version  length  payload[ length ]  checksum[ 2 ]
+ *
+ * The payload is a TelemetrySample_t in little endian byte order and the
+ * checksum is a Fletcher-16 over the version, length and payload bytes, least
+ * significant byte first.  The sync bytes and checksum let a reader find the
+ * frames in a stream that also carries ordinary text.  tools/telemetry_decode.py
+ * converts a capture of the serial port back to CSV.
+ */
+
+#define telemetrySYNC_0          ( 0xA5U )
+#define telemetrySYNC_1          ( 0x5AU )
+
+/* Increment whenever TelemetrySample_t changes.  Version 1 carried the bill
+ * in 32 bits. */
+#define telemetryVERSION         ( 2U )
+
+typedef struct TelemetrySample
+{
+    uint32_t ulTick;         /* Tick count when the frame was emitted. */
+    int32_t lBatteryLevel;   /* W.h */
+    int64_t llBill;          /* miliCents, positive is profit. */
+    uint32_t ulSolarPower;   /* W */
+    uint32_t ulLoadPower;    /* W */
+} TelemetrySample_t;
+
+void vTelemetrySetBatteryLevel( int32_t lBatteryLevel );
+void vTelemetrySetBill( int64_t llBill );
+void vTelemetrySetSolarPower( uint32_t ulSolarPower );
+void vTelemetrySetLoadPower( uint32_t ulLoadPower );
+
+/*
+ * Send the most recently published values, stamped with xTick.
+ */
+void vTelemetryEmit( TickType_t xTick );
+
+#endif /* TELEMETRY_H */
@@ -0,0 +1,131 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef TRACE_HOOKS_H
+#define TRACE_HOOKS_H
+
+/*
+ * The kernel trace hooks of the energy application, included at the end of
+ * FreeRTOSConfig.h by both builds.  With LOOP_STATS set to 1 they feed
+ * LoopStats.h, which times the energy tasks, and with TRACE_RECORDER set to 1
+ * TraceRecorder.h, which records what the kernel does.  The host's kernel
+ * benchmark sets both to 0, so the kernel it times runs no hooks.  Only types
+ * from stdint.h can be used here, as the port's types are not yet defined.
+ *
+ * The hooks expand inside tasks.c and queue.c, so they read the TCB and queue
+ * fields directly.  The recorder needs configUSE_TRACE_FACILITY for the task
+ * and queue numbers, and LoopStats thread local storage pointer 0.
+ */
+
+#ifndef TRACE_RECORDER
+    #define TRACE_RECORDER    1
+#endif
+
+#ifndef LOOP_STATS
+    #define LOOP_STATS    1
+#endif
+
+#if ( TRACE_RECORDER == 1 ) && ( configUSE_TRACE_FACILITY != 1 )
+    #error TRACE_RECORDER needs configUSE_TRACE_FACILITY set to 1 in FreeRTOSConfig.h
+#endif
+
+/* Kinds of event the recorder keeps.  usObject is a task number, or a queue
+ * number for the queue events.  0 is never used, a record being written has
+ * it as its kind. */
+#define traceEVENT_SWITCH_IN              ( 1U )  /* Value is the task's priority. */
+#define traceEVENT_READY                  ( 2U )
+#define traceEVENT_TASK_CREATE            ( 3U )  /* Value is the task's priority. */
+#define traceEVENT_DELAY                  ( 4U )  /* The running task blocked for a time. */
+#define traceEVENT_QUEUE_CREATE           ( 5U )  /* Value is the queueQUEUE_TYPE_... */
+#define traceEVENT_QUEUE_SEND             ( 6U )  /* Value is the number of items waiting before. */
+#define traceEVENT_QUEUE_SEND_FAILED      ( 7U )
+#define traceEVENT_QUEUE_RECEIVE          ( 8U )  /* Value is the number of items waiting before. */
+#define traceEVENT_QUEUE_RECEIVE_FAILED   ( 9U )
+#define traceEVENT_QUEUE_BLOCK_SEND       ( 10U ) /* The running task blocked on a full queue. */
+#define traceEVENT_QUEUE_BLOCK_RECEIVE    ( 11U ) /* The running task blocked on an empty queue. */
+#define traceEVENT_QUEUE_SEND_FROM_ISR    ( 12U )
+#define traceEVENT_QUEUE_RECEIVE_FROM_ISR ( 13U )
+
+#if ( LOOP_STATS == 1 )
+
+    void vLoopStatsSwitchedIn( void * pvStats );
+    void vLoopStatsSwitchedOut( void * pvStats );
+    void vLoopStatsReady( void * pvStats );
+
+    #define traceLOOP_STATS( xFunction, pvStats )    xFunction( pvStats )
+
+#else /* LOOP_STATS */
+
+    #define traceLOOP_STATS( xFunction, pvStats )
+
+#endif /* LOOP_STATS */
+
+#if ( TRACE_RECORDER == 1 )
+
+    void vTraceRecorderEvent( uint32_t ulEvent,
+                              uint32_t ulObject,
+                              uint32_t ulValue );
+    void vTraceRecorderTaskCreate( uint32_t ulTask,
+                                   uint32_t ulPriority,
+                                   const char * pcName );
+    uint32_t ulTraceRecorderQueueCreate( uint32_t ulType );
+
+    #define traceRECORD( ulEvent, uxObject, uxValue )    vTraceRecorderEvent( ( ulEvent ), ( uint32_t ) ( uxObject ), ( uint32_t ) ( uxValue ) )
+
+    #define traceTASK_CREATE( pxNewTCB )                 vTraceRecorderTaskCreate( ( uint32_t ) ( pxNewTCB )->uxTCBNumber, ( uint32_t ) ( pxNewTCB )->uxPriority, ( pxNewTCB )->pcTaskName )
+    #define traceTASK_DELAY_UNTIL( xTimeToWake )         traceRECORD( traceEVENT_DELAY, pxCurrentTCB->uxTCBNumber, 0U )
+    #define traceTASK_DELAY()                            traceRECORD( traceEVENT_DELAY, pxCurrentTCB->uxTCBNumber, 0U )
+    #define traceQUEUE_CREATE( pxNewQueue )              ( pxNewQueue )->uxQueueNumber = ulTraceRecorderQueueCreate( ( pxNewQueue )->ucQueueType )
+    #define traceQUEUE_SEND( pxQueue )                   traceRECORD( traceEVENT_QUEUE_SEND, ( pxQueue )->uxQueueNumber, ( pxQueue )->uxMessagesWaiting )
+    #define traceQUEUE_SEND_FAILED( pxQueue )            traceRECORD( traceEVENT_QUEUE_SEND_FAILED, ( pxQueue )->uxQueueNumber, ( pxQueue )->uxMessagesWaiting )
+    #define traceQUEUE_RECEIVE( pxQueue )                traceRECORD( traceEVENT_QUEUE_RECEIVE, ( pxQueue )->uxQueueNumber, ( pxQueue )->uxMessagesWaiting )
+    #define traceQUEUE_RECEIVE_FAILED( pxQueue )         traceRECORD( traceEVENT_QUEUE_RECEIVE_FAILED, ( pxQueue )->uxQueueNumber, 0U )
+    #define traceBLOCKING_ON_QUEUE_SEND( pxQueue )       traceRECORD( traceEVENT_QUEUE_BLOCK_SEND, ( pxQueue )->uxQueueNumber, ( pxQueue )->uxMessagesWaiting )
+    #define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue )    traceRECORD( traceEVENT_QUEUE_BLOCK_RECEIVE, ( pxQueue )->uxQueueNumber, 0U )
+    #define traceQUEUE_SEND_FROM_ISR( pxQueue )          traceRECORD( traceEVENT_QUEUE_SEND_FROM_ISR, ( pxQueue )->uxQueueNumber, ( pxQueue )->uxMessagesWaiting )
+    #define traceQUEUE_RECEIVE_FROM_ISR( pxQueue )       traceRECORD( traceEVENT_QUEUE_RECEIVE_FROM_ISR, ( pxQueue )->uxQueueNumber, ( pxQueue )->uxMessagesWaiting )
+
+#else /* TRACE_RECORDER */
+
+    #define traceRECORD( ulEvent, uxObject, uxValue )
+
+#endif /* TRACE_RECORDER */
+
+#define traceTASK_SWITCHED_IN()                                                                         \
+    do {                                                                                                \
+        traceLOOP_STATS( vLoopStatsSwitchedIn, pxCurrentTCB->pvThreadLocalStoragePointers[ 0 ] );       \
+        traceRECORD( traceEVENT_SWITCH_IN, pxCurrentTCB->uxTCBNumber, pxCurrentTCB->uxPriority );       \
+    } while( 0 )
+
+#define traceTASK_SWITCHED_OUT()    traceLOOP_STATS( vLoopStatsSwitchedOut, pxCurrentTCB->pvThreadLocalStoragePointers[ 0 ] )
+
+#define traceMOVED_TASK_TO_READY_STATE( pxTCB )                                                         \
+    do {                                                                                                \
+        traceLOOP_STATS( vLoopStatsReady, ( pxTCB )->pvThreadLocalStoragePointers[ 0 ] );               \
+        traceRECORD( traceEVENT_READY, ( pxTCB )->uxTCBNumber, 0U );                                    \
+    } while( 0 )
+
+#endif /* TRACE_HOOKS_H */
@@ -0,0 +1,433 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Kernel trace recorder, see TraceRecorder.h for the modes and the format.
+ *
+ * ulHead counts the events claimed since recording started and ulTail, in
+ * stream mode, the events the stream task has taken.  An event's slot is
+ * ulHead modulo traceRING_LENGTH.  Its kind is written last, with release
+ * ordering, and is 0 until then, so the stream task never sends an event
+ * still being written by a hook it pre-empted.  The compare and swap and
+ * the other atomic operations compile to LDREX/STREX on the Cortex-M3.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "SerialLog.h"
+#include "RunTimeClock.h"
+#include "TraceRecorder.h"
+
+#if ( ( traceRING_LENGTH & ( traceRING_LENGTH - 1U ) ) != 0U )
+    #error traceRING_LENGTH must be a power of two
+#endif
+
+#define traceSYNC_0                 ( 0xA5U )
+#define traceSYNC_1                 ( 0x5AU )
+#define traceHEADER_SIZE            ( 4U )
+#define traceCHECKSUM_SIZE          ( 2U )
+#define traceMAX_PAYLOAD            ( traceEVENTS_PER_FRAME * sizeof( TraceEvent_t ) )
+
+/* The stream task only copies events, so needs little of the CPU or stack. */
+#define traceSTREAM_PRIORITY        ( tskIDLE_PRIORITY + 1 )
+#define traceSTREAM_STACK_SIZE      ( configMINIMAL_STACK_SIZE * 4 )
+
+/* Ticks a frame waits for room in the serial log before it is dropped. */
+#define traceSEND_TICKS             ( 100U )
+
+/* Sends what has been recorded, in stream mode. */
+static void prvStreamTask( void * pvParameters );
+
+/* Claim the next slot of the ring for an event, unless the ring is full in
+ * stream mode. */
+static BaseType_t prvClaim( eTraceMode eMode,
+                            uint32_t * pulClaim );
+
+/* Send the header, the names of the tasks from ulFirst on, and the events
+ * from ulFrom to ulTo.  prvSendTasks() returns the number of tasks named. */
+static void prvSendHeader( void );
+static uint32_t prvSendTasks( uint32_t ulFirst );
+static void prvSendEvents( uint32_t ulFrom,
+                           uint32_t ulTo,
+                           BaseType_t xConsume );
+
+/* Send one frame, waiting for room if the scheduler is running. */
+static void prvSendFrame( uint8_t ucVersion,
+                          const void * pvPayload,
+                          size_t xLength );
+
+static TraceEvent_t xRing[ traceRING_LENGTH ];
+static volatile uint32_t ulHead = 0;
+static volatile uint32_t ulTail = 0;
+static volatile uint32_t ulDropped = 0;
+
+/* The mode being recorded in, eTraceOff when stopped, and the mode it was
+ * last started in. */
+static volatile eTraceMode eRecorderMode = eTraceOff;
+static eTraceMode eStartedMode = eTraceOff;
+
+/* Names of the tasks by number, from 1, and the highest number named. */
+static TraceTask_t xTasks[ traceMAX_TASKS ];
+static volatile uint32_t ulTaskCount = 0;
+
+/* Numbers given to queues as they are created. */
+static uint32_t ulQueueCount = 0;
+
+static TaskHandle_t xStreamTask = NULL;
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xTraceRecorderStart( eTraceMode eMode )
+{
+    BaseType_t xReturn = pdPASS;
+
+    configASSERT( eMode != eTraceOff );
+
+    vRunTimeClockInit();
+
+    if( ( eMode == eTraceStream ) && ( xStreamTask == NULL ) )
+    {
+        xReturn = xTaskCreate( prvStreamTask, "TraceStream", traceSTREAM_STACK_SIZE, NULL, traceSTREAM_PRIORITY, &xStreamTask );
+    }
+    else if( eMode == eTraceStream )
+    {
+        /* Suspended by an earlier dump. */
+        vTaskResume( xStreamTask );
+    }
+    else
+    {
+        /* Snapshot mode needs no task. */
+    }
+
+    if( xReturn == pdPASS )
+    {
+        eStartedMode = eMode;
+        eRecorderMode = eMode;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vTraceRecorderStop( void )
+{
+    eRecorderMode = eTraceOff;
+}
+/*-----------------------------------------------------------*/
+
+void vTraceRecorderDump( void )
+{
+    uint32_t ulEnd, ulStart;
+
+    vTraceRecorderStop();
+
+    ulEnd = ulHead;
+
+    if( eStartedMode == eTraceStream )
+    {
+        /* What the stream task has not sent yet.  It is suspended first, so
+         * it cannot send the same events again.  After a panic it cannot run
+         * anyway. */
+        if( ( xStreamTask != NULL ) &&
+            ( xTaskGetSchedulerState() == taskSCHEDULER_RUNNING ) &&
+            ( xTaskGetCurrentTaskHandle() != xStreamTask ) )
+        {
+            vTaskSuspend( xStreamTask );
+        }
+
+        ulStart = ulTail;
+    }
+    else if( ulEnd > traceRING_LENGTH )
+    {
+        /* The older events have been overwritten. */
+        ulStart = ulEnd - traceRING_LENGTH;
+    }
+    else
+    {
+        ulStart = 0;
+    }
+
+    prvSendHeader();
+    ( void ) prvSendTasks( 0 );
+    prvSendEvents( ulStart, ulEnd, pdFALSE );
+
+    if( eStartedMode == eTraceStream )
+    {
+        /* Sent, so a later dump does not send them again. */
+        __atomic_store_n( &ulTail, ulEnd, __ATOMIC_RELEASE );
+    }
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulTraceRecorderGetDropped( void )
+{
+    return ulDropped;
+}
+/*-----------------------------------------------------------*/
+
+void vTraceRecorderEvent( uint32_t ulEvent,
+                          uint32_t ulObject,
+                          uint32_t ulValue )
+{
+    const eTraceMode eMode = eRecorderMode;
+    TraceEvent_t * pxEvent;
+    uint32_t ulClaim;
+
+    if( ( eMode != eTraceOff ) && ( prvClaim( eMode, &ulClaim ) != pdFALSE ) )
+    {
+        pxEvent = &( xRing[ ulClaim & ( traceRING_LENGTH - 1U ) ] );
+
+        /* In snapshot mode the slot still holds the event it overwrites. */
+        __atomic_store_n( &( pxEvent->ucEvent ), 0U, __ATOMIC_RELAXED );
+
+        pxEvent->ulTime = ulRunTimeClockGet();
+        pxEvent->ucValue = ( ulValue > UINT8_MAX ) ? UINT8_MAX : ( uint8_t ) ulValue;
+        pxEvent->usObject = ( uint16_t ) ulObject;
+
+        __atomic_store_n( &( pxEvent->ucEvent ), ( uint8_t ) ulEvent, __ATOMIC_RELEASE );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vTraceRecorderTaskCreate( uint32_t ulTask,
+                               uint32_t ulPriority,
+                               const char * pcName )
+{
+    TraceTask_t * pxTask;
+
+    /* Names are kept whether recording or not, so tasks created before the
+     * recorder is started are named too.  Called with the kernel's task
+     * lists locked, so by one task at a time. */
+    if( ( ulTask > 0U ) && ( ulTask <= traceMAX_TASKS ) )
+    {
+        pxTask = &( xTasks[ ulTask - 1U ] );
+        pxTask->usTask = ( uint16_t ) ulTask;
+        pxTask->ucPriority = ( ulPriority > UINT8_MAX ) ? UINT8_MAX : ( uint8_t ) ulPriority;
+        strncpy( pxTask->cName, pcName, traceNAME_LENGTH );
+
+        if( ulTask > ulTaskCount )
+        {
+            ulTaskCount = ulTask;
+        }
+    }
+    else
+    {
+        /* Sent without a name. */
+    }
+
+    vTraceRecorderEvent( traceEVENT_TASK_CREATE, ulTask, ulPriority );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulTraceRecorderQueueCreate( uint32_t ulType )
+{
+    uint32_t ulQueue = __atomic_add_fetch( &ulQueueCount, 1U, __ATOMIC_RELAXED );
+
+    vTraceRecorderEvent( traceEVENT_QUEUE_CREATE, ulQueue, ulType );
+
+    return ulQueue;
+}
+/*-----------------------------------------------------------*/
+
+static void prvStreamTask( void * pvParameters )
+{
+    uint32_t ulNamed = 0;
+
+    ( void ) pvParameters;
+
+    prvSendHeader();
+
+    for( ; ; )
+    {
+        vTaskDelay( traceSTREAM_PERIOD );
+
+        /* Name any new tasks before their events.  Only what was recorded
+         * before starting is sent, so the events the sending itself causes
+         * wait for the next time. */
+        ulNamed = prvSendTasks( ulNamed );
+        prvSendEvents( ulTail, ulHead, pdTRUE );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvClaim( eTraceMode eMode,
+                            uint32_t * pulClaim )
+{
+    uint32_t ulClaim = __atomic_load_n( &ulHead, __ATOMIC_RELAXED );
+    BaseType_t xClaimed = pdFALSE, xFull = pdFALSE;
+
+    do
+    {
+        if( ( eMode == eTraceStream ) &&
+            ( ( ulClaim - __atomic_load_n( &ulTail, __ATOMIC_ACQUIRE ) ) >= traceRING_LENGTH ) )
+        {
+            xFull = pdTRUE;
+            ( void ) __atomic_add_fetch( &ulDropped, 1U, __ATOMIC_RELAXED );
+        }
+        else if( __atomic_compare_exchange_n( &ulHead, &ulClaim, ulClaim + 1U, pdFALSE, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED ) )
+        {
+            xClaimed = pdTRUE;
+        }
+        else
+        {
+            /* Another event claimed the slot first, ulClaim is the next. */
+        }
+    } while( ( xClaimed == pdFALSE ) && ( xFull == pdFALSE ) );
+
+    *pulClaim = ulClaim;
+
+    return xClaimed;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendHeader( void )
+{
+    TraceHeader_t xHeader;
+
+    memset( &xHeader, 0x00, sizeof( xHeader ) );
+    xHeader.ulClockHz = ulRunTimeClockGetHz();
+    xHeader.ulEvents = ulHead;
+    xHeader.ulDropped = ulDropped;
+    xHeader.ucMode = ( uint8_t ) eStartedMode;
+
+    prvSendFrame( traceVERSION_HEADER, &xHeader, sizeof( xHeader ) );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvSendTasks( uint32_t ulFirst )
+{
+    const uint32_t ulCount = ulTaskCount;
+    uint32_t ulTask;
+
+    for( ulTask = ulFirst; ulTask < ulCount; ulTask++ )
+    {
+        if( xTasks[ ulTask ].usTask != 0U )
+        {
+            prvSendFrame( traceVERSION_TASK, &( xTasks[ ulTask ] ), sizeof( TraceTask_t ) );
+        }
+    }
+
+    return ulCount;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendEvents( uint32_t ulFrom,
+                           uint32_t ulTo,
+                           BaseType_t xConsume )
+{
+    TraceEvent_t xFrame[ traceEVENTS_PER_FRAME ];
+    TraceEvent_t * pxEvent;
+    size_t xCount = 0;
+    uint32_t ulNext;
+
+    for( ulNext = ulFrom; ulNext != ulTo; ulNext++ )
+    {
+        pxEvent = &( xRing[ ulNext & ( traceRING_LENGTH - 1U ) ] );
+
+        if( __atomic_load_n( &( pxEvent->ucEvent ), __ATOMIC_ACQUIRE ) == 0U )
+        {
+            /* Still being written by the hook this task pre-empted.  When
+             * streaming it and what follows wait for the next time; a dump
+             * skips it. */
+            if( xConsume != pdFALSE )
+            {
+                break;
+            }
+        }
+        else
+        {
+            xFrame[ xCount ] = *pxEvent;
+            xCount++;
+        }
+
+        if( xConsume != pdFALSE )
+        {
+            /* Free the slot for a new event. */
+            pxEvent->ucEvent = 0U;
+            __atomic_store_n( &ulTail, ulNext + 1U, __ATOMIC_RELEASE );
+        }
+
+        if( xCount == traceEVENTS_PER_FRAME )
+        {
+            prvSendFrame( traceVERSION_EVENTS, xFrame, xCount * sizeof( TraceEvent_t ) );
+            xCount = 0;
+        }
+    }
+
+    if( xCount > 0U )
+    {
+        prvSendFrame( traceVERSION_EVENTS, xFrame, xCount * sizeof( TraceEvent_t ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendFrame( uint8_t ucVersion,
+                          const void * pvPayload,
+                          size_t xLength )
+{
+    uint8_t ucFrame[ traceHEADER_SIZE + traceMAX_PAYLOAD + traceCHECKSUM_SIZE ];
+    const size_t xFrameSize = traceHEADER_SIZE + xLength + traceCHECKSUM_SIZE;
+    uint16_t usSum1 = 0, usSum2 = 0;
+    uint32_t ulWaited = 0;
+    size_t x;
+
+    configASSERT( xLength <= traceMAX_PAYLOAD );
+
+    ucFrame[ 0 ] = traceSYNC_0;
+    ucFrame[ 1 ] = traceSYNC_1;
+    ucFrame[ 2 ] = ucVersion;
+    ucFrame[ 3 ] = ( uint8_t ) xLength;
+
+    /* Both supported targets are little endian, so the structures can be
+     * copied as they are. */
+    memcpy( &ucFrame[ traceHEADER_SIZE ], pvPayload, xLength );
+
+    for( x = 2; x < ( traceHEADER_SIZE + xLength ); x++ )
+    {
+        usSum1 = ( uint16_t ) ( ( usSum1 + ucFrame[ x ] ) % 255U );
+        usSum2 = ( uint16_t ) ( ( usSum2 + usSum1 ) % 255U );
+    }
+
+    ucFrame[ xFrameSize - 2U ] = ( uint8_t ) usSum1;
+    ucFrame[ xFrameSize - 1U ] = ( uint8_t ) usSum2;
+
+    /* A frame is written whole or not at all.  The serial log only refuses
+     * one while its buffer is full, so wait for the UART to drain it. */
+    while( ( xSerialLogWrite( ucFrame, xFrameSize ) == 0U ) &&
+           ( xTaskGetSchedulerState() == taskSCHEDULER_RUNNING ) &&
+           ( ulWaited < traceSEND_TICKS ) )
+    {
+        vTaskDelay( 1 );
+        ulWaited++;
+    }
+}
+/*-----------------------------------------------------------*/
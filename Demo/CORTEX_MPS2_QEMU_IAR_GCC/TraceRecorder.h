@@ -0,0 +1,135 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+/*
+ * Records what the kernel does - context switches, tasks made ready or
+ * blocking, and queue and semaphore operations - as 8 byte events stamped
+ * with the clock of RunTimeClock.h.  The kernel's trace hooks, see
+ * TraceHooks.h, add the events to a ring in RAM without taking a lock: each
+ * claims its slot with a compare and swap of the ring's head, so a hook
+ * interrupted by another, or by an interrupt, never waits.
+ *
+ * In snapshot mode the ring keeps the latest traceRING_LENGTH events,
+ * overwriting the oldest, until vTraceRecorderDump() sends them.  In stream
+ * mode a task sends the events over the serial port as they are recorded,
+ * and events that find the ring full are dropped and counted.
+ *
+ * Both send the events in frames with the sync bytes, header and checksum of
+ * Telemetry.h, so they can share the port with the telemetry and text:
+ *
+ *   traceVERSION_HEADER   TraceHeader_t
+ *   traceVERSION_TASK     TraceTask_t, the name of a task
+ *   traceVERSION_EVENTS   up to traceEVENTS_PER_FRAME TraceEvent_t
+ *
+ * A header comes first, then the tasks, then the events.
+ * tools/trace_decode.py turns a capture into Chrome trace JSON, which
+ * Perfetto and chrome://tracing display.
+ */
+
+/* Events kept in the ring, a power of two. */
+#ifndef traceRING_LENGTH
+    #define traceRING_LENGTH         ( 512U )
+#endif
+
+/* Most tasks whose names are kept.  Tasks numbered above are sent without. */
+#ifndef traceMAX_TASKS
+    #define traceMAX_TASKS           ( 32U )
+#endif
+
+/* Ticks between the times the stream task sends what has been recorded. */
+#define traceSTREAM_PERIOD           pdMS_TO_TICKS( 10UL )
+
+#define traceVERSION_HEADER          ( 0x20U )
+#define traceVERSION_TASK            ( 0x21U )
+#define traceVERSION_EVENTS          ( 0x22U )
+
+#define traceNAME_LENGTH             ( 12U )
+#define traceEVENTS_PER_FRAME        ( 31U )
+
+typedef enum
+{
+    eTraceOff = 0,
+    eTraceSnapshot,
+    eTraceStream
+} eTraceMode;
+
+/* An event, traceEVENT_... from TraceHooks.h. */
+typedef struct TraceEvent
+{
+    uint32_t ulTime;   /* ulRunTimeClockGet() */
+    uint8_t ucEvent;
+    uint8_t ucValue;   /* Depends on the event, saturated at 255. */
+    uint16_t usObject; /* The task or queue number. */
+} TraceEvent_t;
+
+typedef struct TraceHeader
+{
+    uint32_t ulClockHz; /* Counts of ulTime in a second. */
+    uint32_t ulEvents;  /* Events recorded since started. */
+    uint32_t ulDropped; /* Events lost as the ring was full. */
+    uint8_t ucMode;     /* eTraceMode */
+    uint8_t ucPadding[ 3 ];
+} TraceHeader_t;
+
+typedef struct TraceTask
+{
+    uint16_t usTask;
+    uint8_t ucPriority;
+    uint8_t ucPadding;
+    char cName[ traceNAME_LENGTH ]; /* Not terminated if it fills the field. */
+} TraceTask_t;
+
+/*
+ * Start recording.  Tasks created before are still named in the trace, so
+ * this can be called before or after the energy tasks are created.  Stream
+ * mode creates the task that sends the events, and returns pdFAIL if it could
+ * not be created.
+ */
+BaseType_t xTraceRecorderStart( eTraceMode eMode );
+
+/*
+ * Stop recording.  Events already recorded are kept.
+ */
+void vTraceRecorderStop( void );
+
+/*
+ * Stop recording and send the header, the tasks and the events still in the
+ * ring.  In stream mode the stream task is suspended first, and only the
+ * events it has not sent are sent; starting again resumes it.  Waits for room
+ * in the serial log if the scheduler is running, so can also be used after
+ * vSerialLogPanic(), when output is polled.
+ */
+void vTraceRecorderDump( void );
+
+/*
+ * Returns the number of events dropped because the ring was full.
+ */
+uint32_t ulTraceRecorderGetDropped( void );
+
+#endif /* TRACE_RECORDER_H */
@@ -205,12 +205,28 @@ static int tiny_print( char **out, const char *format, va_list args, unsigned in
 	return pc;
 }
 
+/* printf() output is formatted into a buffer on the caller's stack and then
+handed to __write() in one go, so the console driver sees whole lines rather
+than single characters.  Longer output is truncated. */
+#define PRINTF_BUFFER_SIZE	128
+
+extern int __write( int iFile, char * pcString, int iStringLength );
+
 int printf(const char *format, ...)
 {
         va_list args;
+        char buf[ PRINTF_BUFFER_SIZE ], *out = buf;
+        int len;
 
         va_start( args, format );
-        return tiny_print( 0, format, args, 0 );
+        len = tiny_print( &out, format, args, sizeof( buf ) );
+
+        /* tiny_print() returns the length before truncation. */
+        if( len > ( int ) sizeof( buf ) - 1 ) {
+            len = ( int ) sizeof( buf ) - 1;
+        }
+
+        return __write( 1, buf, len );
 }
 
 int sprintf(char *out, const char *format, ...)
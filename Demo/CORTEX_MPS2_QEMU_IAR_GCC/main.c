@@ -56,7 +56,6 @@
 /* Standard includes. */
 #include <stdio.h>
 #include <string.h>
-#include <math.h>
 #include <stdbool.h>
 
 /* Demo app includes. */
@@ -85,6 +84,14 @@
 #include "StreamBufferInterrupt.h"
 #include "IntSemTest.h"
 
+/* Energy application includes. */
+#include "CurveBenchmark.h"
+#include "KernelBenchmark.h"
+#include "SerialLog.h"
+#include "EnergyManagement.h"
+#include "TraceRecorder.h"
+#include "StackProfile.h"
+
 /* This project provides two demo applications.  A simple blinky style demo
  * application, and a more comprehensive test and demo application.  The
  * CREATE_SIMPLE_BLINKY_DEMO_ONLY setting is used to select between the two.
@@ -97,54 +104,34 @@
  * implemented and described in main_full.c. */
 #define CREATE_SIMPLE_BLINKY_DEMO_ONLY    1
 
-/* printf() output uses the UART.  These constants define the addresses of the
- * required UART registers. */
-#define UART0_ADDRESS                         ( 0x40004000UL )
-#define UART0_DATA                            ( *( ( ( volatile uint32_t * ) ( UART0_ADDRESS + 0UL ) ) ) )
-#define UART0_STATE                           ( *( ( ( volatile uint32_t * ) ( UART0_ADDRESS + 4UL ) ) ) )
-#define UART0_CTRL                            ( *( ( ( volatile uint32_t * ) ( UART0_ADDRESS + 8UL ) ) ) )
-#define UART0_BAUDDIV                         ( *( ( ( volatile uint32_t * ) ( UART0_ADDRESS + 16UL ) ) ) )
-#define TX_BUFFER_MASK                        ( 1UL )
-
-/* The number of items the queues can hold at once. */
-#define POWER_QUEUE_LENGTH                   ( 2 )
-#define GRID_QUEUE_LENGTH                   ( 4 )
-
-/* Priorities at which the tasks are created. */
-#define SOLAR_GEN_TASK_PRIORITY    ( tskIDLE_PRIORITY + 1 )
-#define BATTERY_MGMT_TASK_PRIORITY  ( tskIDLE_PRIORITY + 2 )
-#define LOAD_MGMT_TASK_PRIORITY  ( tskIDLE_PRIORITY + 3 )
-#define GRID_INTERACT_TASK_PRIORITY  ( tskIDLE_PRIORITY + 4 )
-
-/* The rate at which data is sent to the queue, and the rate at which battery level is checked. 
-The times are converted from milliseconds to ticks using the pdMS_TO_TICKS() macro. */
-#define TASK_SOLAR_GEN_FREQUENCY_MS    pdMS_TO_TICKS( 200UL )
-#define TASK_LOAD_MAN_FREQUENCY_MS     pdMS_TO_TICKS( 200UL )
-
-/* Macro to calculate the solar power in W, assuming a maximum of 5000 W */
-#define AMPLITUDE 5000
-#define PERIOD 24
-#define PHASE M_PI/2
-#define SOLAR_POWER(tick) ( (TickType_t) ( AMPLITUDE * sin(2 * M_PI / PERIOD * (tick) / configTICK_RATE_HZ - PHASE) ) )
-
-/* The rate at which the battery is updated in this simulation is 12 minutes in real life time.
- * We have the power, to get energy we just need to multiply by 0.2 (W.h). Since that is floating point,
- * we will multiply by 20 and divide by 100 */
-#define TIME_DENOMINATOR 100
-#define TIME_NUMERATOR 20
-
-/* Battery max capacity in W.h */
-#define CAPACITY 10000
-
-/* Number of devices being considered */
-#define NUM_DEVICES ( sizeof(xDevices) / sizeof(xDevices[0]) )
-
-/* Macro to calculate price of energy at a given time in the day. It is in miliCents /W */
-#define PRICE_AMPLITUDE 0.07    // Represents the maximum price fluctuation (±7 cents)
-#define BASE_PRICE 0.22         // Base price in €/kWh (22 cents)
-#define PRICE_PERIOD 24         
-#define PRICE_PHASE M_PI/2           
-#define ENERGY_PRICE(tick) ( (TickType_t) (( BASE_PRICE + PRICE_AMPLITUDE * sin(2 * M_PI / PRICE_PERIOD * (tick) / configTICK_RATE_HZ - PRICE_PHASE) )*100) )
+/* Set to 1 to time the fixed-point solar and price curves against the original
+ * floating point versions before the scheduler starts. */
+#define RUN_CURVE_BENCHMARK               0
+
+/* Set to 1 to time the kernel's queues, semaphores, notifications, stream
+ * buffers, context switches and tick, and print the results as JSON, instead
+ * of running the energy application. */
+#define RUN_KERNEL_BENCHMARK              0
+
+/* Set to 1 to record the kernel's events in snapshot mode, the latest of
+ * which are written out if an assertion fails, or to 2 to stream all of them
+ * over the serial port, see TraceRecorder.h. */
+#define TRACE_RECORDER_MODE               0
+
+/* Set to 1 to print how much of its stack each task has used whenever it
+ * uses more, sampled every second, see StackProfile.h. */
+#define STACK_PROFILE                     0
+
+/* Set to 1 by the Makefile when a recorded profile is linked into the image
+ * to be replayed, see EnergyProfile.h. */
+#ifndef ENERGY_PROFILE
+    #define ENERGY_PROFILE                0
+#endif
+
+#if ( ENERGY_PROFILE == 1 )
+    extern const uint8_t ucEnergyProfile[];
+    extern const size_t xEnergyProfileLength;
+#endif
 
 /*
  * Only the comprehensive demo uses application hook (callback) functions.  See
@@ -154,230 +141,88 @@ void vFullDemoTickHookFunction( void ); // PROBABLY CAN DELETE THESEEEEEEEEEEEEE
 void vFullDemoIdleFunction( void );
 
 /*
- * Printf() output is sent to the serial port.  Initialise the serial hardware.
+ * Runs the kernel benchmarks, see KernelBenchmark.h.
  */
-static void prvUARTInit( void );
-
-/* Tasks */
-void vTaskSolarPowerGeneration( void * pvParameters );
-void vTaskBatteryManagement( void * pvParameters );
-void vTaskLoadManagement( void * pvParameters );
-void vTaskGridInteraction( void * pvParameters );
-
-/* Queue for power values. Queue to signal grid interaction. */
-static QueueHandle_t xQueuePower = NULL;
-static QueueHandle_t xQueueGrid = NULL;
-
-/* The binary semaphore used to update the battery level. */
-static SemaphoreHandle_t xSemaphore = NULL;
-
-/* Battery level in W.h */
-static int32_t lBatteryLevel = 0;
-
-/* Expenditure or profit with energy */
-static int32_t lBill = 0;
-
-/* Structure of an appliance */
-typedef struct {
-    char cName[20];
-    uint16_t usPower; // Power consuption in W
-    bool bStatus; // On or Off
-    uint8_t ucPriority; // Lowest number means higher priority
-} Appliance;
-
-/* List of devices */
-Appliance xDevices[] = {
-
-    {"Lighting", 100, false, 1}, // 10 LEDs consuming 10W each
-    {"Refrigerator", 300, true, 1},
-    {"Wahsing Machine", 1000, false, 2}
-};
+#if ( RUN_KERNEL_BENCHMARK == 1 )
+    static void prvKernelBenchmarkTask( void * pvParameters );
+#endif
 /*-----------------------------------------------------------*/
 
 void main( void )
 {
+    static EnergyManagementConfig_t xConfig;
+
     /* See https://www.freertos.org/freertos-on-qemu-mps2-an385-model.html for
      * instructions. */
 
-    /* Hardware initialisation.  printf() output uses the UART for IO. */
-    prvUARTInit();
-
-    /* Create the queue. */
-    xQueuePower = xQueueCreate( POWER_QUEUE_LENGTH, sizeof( uint32_t ) );
-    xQueueGrid = xQueueCreate( GRID_QUEUE_LENGTH, sizeof( uint32_t ) );
-
-    xSemaphore = xSemaphoreCreateMutex();
-
-    if( (xQueuePower != NULL) && (xQueueGrid != NULL) && (xSemaphore != NULL) ){
-
-        xTaskCreate( vTaskSolarPowerGeneration,     /* The function that implements the task. */
-                    "SolarGen",                     /* The text name assigned to the task - for debug only as it is not used by the kernel. */
-                    1048,                           /* The size of the stack to allocate to the task. */
-                    NULL,                           /* The parameter passed to the task - not used in this simple case. */
-                    SOLAR_GEN_TASK_PRIORITY,    /* The priority assigned to the task. */
-                    NULL );                         /* The task handle is not required, so NULL is passed. */
-
-        
-        xTaskCreate( vTaskBatteryManagement, "BatteryMgmt", 1048, NULL, BATTERY_MGMT_TASK_PRIORITY, NULL );
-
-        xTaskCreate( vTaskLoadManagement, "LoadMgmt", 1048, NULL, LOAD_MGMT_TASK_PRIORITY, NULL );
-
-        xTaskCreate( vTaskGridInteraction, "GridInteract", 1048, NULL, GRID_INTERACT_TASK_PRIORITY, NULL );
-
-        // Create tasks and start scheduler
-        vTaskStartScheduler();
-    }
-
-    // The scheduler should never return. If it does, loop indefinitely.
-    for( ; ; ){}
-}
-/*-----------------------------------------------------------*/
-
-void vTaskSolarPowerGeneration( void * pvParameters )
-{
-    TickType_t xNextWakeTime;
-    const TickType_t xBlockTime = TASK_SOLAR_GEN_FREQUENCY_MS;
-
-    /* Prevent the compiler warning about the unused parameter. */
-    ( void ) pvParameters;
-
-    /* Initialise xNextWakeTime - this only needs to be done once. */
-    xNextWakeTime = xTaskGetTickCount();
+    /* Hardware initialisation.  printf() output is buffered and sent by the
+     * UART TX interrupt, see SerialLog.c. */
+    vSerialLogInit();
 
-    for( ; ; )
+    #if ( RUN_CURVE_BENCHMARK == 1 )
     {
-        /* Place this task in the blocked state until it is time to run again */      
-        vTaskDelayUntil( &xNextWakeTime, xBlockTime );
-
-        /* Calculate the Solar Power delivered to the cell in this time */
-        uint16_t usValueToSend = SOLAR_POWER(xNextWakeTime); 
-
-        /* Send to the queue - causing the queue receive task to unblock and
-         * write to the console.  0 is used as the block time so the send operation
-         * will not block - it shouldn't need to block as the queue should always
-         * have at least one space at this point in the code. */
-        xQueueSend( xQueuePower, &usValueToSend, 0U );
-    }   
-}
-/*-----------------------------------------------------------*/
-
-void vTaskBatteryManagement( void * pvParameters )
-{
-    uint16_t usReceivedValue;
-
-    /* Prevent the compiler warning about the unused parameter. */
-    ( void ) pvParameters;
+        vCurveBenchmarkRun();
+    }
+    #endif /* RUN_CURVE_BENCHMARK */
 
-    for( ; ; )
+    #if ( RUN_KERNEL_BENCHMARK == 1 )
     {
-        /* Wait until something arrives in the queue - this task will block
-         * indefinitely provided INCLUDE_vTaskSuspend is set to 1 in
-         * FreeRTOSConfig.h. */
-        xQueueReceive( xQueuePower, &usReceivedValue, portMAX_DELAY );
-
-        /*  Check if received value is an expected value, and if battery is not full. 
-         * Take the mutex and update the battery level */
-        uint16_t usEnergy = usReceivedValue * TIME_NUMERATOR / TIME_DENOMINATOR;
-        uint32_t ulLocalBatteryLevel = 0; 
-       
-        if( (usReceivedValue <= AMPLITUDE) && ((lBatteryLevel + usEnergy) < CAPACITY) ) 
-        {   
-            if( xSemaphoreTake( xSemaphore, ( TickType_t ) pdMS_TO_TICKS(10UL) ) == pdTRUE )
-            {
-                lBatteryLevel += usEnergy;
-                ulLocalBatteryLevel = lBatteryLevel; 
-                xSemaphoreGive( xSemaphore );
-            }
-            else
-            {
-                printf( "Could not update battery\r\n" );
-            }
-        }
-        else if ((usReceivedValue <= AMPLITUDE))
-        {
-            // Signal to the Grid Interaction Task we are selling energy
-            xQueueSend( xQueueGrid, &usEnergy, 0U );
-            ulLocalBatteryLevel = lBatteryLevel; 
-        }
-        else
+        /* Nothing else runs, so nothing else is timed. */
+        if( xTaskCreate( prvKernelBenchmarkTask, "Benchmark", kernelbenchSTACK_SIZE, NULL, kernelbenchPRIORITY, NULL ) == pdPASS )
         {
-            printf( "Unexpected message\r\n" );
+            vTaskStartScheduler();
         }
-
-        /* Print battery level outside the critical region, with a local variable equal to the batteryLevel updated by this task */
-        printf("Battery Level: %u\n", ulLocalBatteryLevel); 
     }
-}
-/*-----------------------------------------------------------*/
+    #endif /* RUN_KERNEL_BENCHMARK */
 
-void vTaskLoadManagement( void * pvParameters )
-{
-    TickType_t xNextWakeTime;
-    const TickType_t xBlockTime = TASK_LOAD_MAN_FREQUENCY_MS;
+    /* Create the energy application's tasks for the household described in
+     * EnergyConfig.h, and start the scheduler. */
+    vEnergyManagementGetDefaultConfig( &xConfig );
 
-    /* Prevent the compiler warning about the unused parameter. */
-    ( void ) pvParameters;
+    #if ( ENERGY_PROFILE == 1 )
+    {
+        xConfig.pucProfile = ucEnergyProfile;
+        xConfig.xProfileLength = xEnergyProfileLength;
+    }
+    #endif /* ENERGY_PROFILE */
 
-    /* Initialise xNextWakeTime - this only needs to be done once. */
-    xNextWakeTime = xTaskGetTickCount();
+    #if ( TRACE_RECORDER_MODE == 1 )
+    {
+        ( void ) xTraceRecorderStart( eTraceSnapshot );
+    }
+    #elif ( TRACE_RECORDER_MODE == 2 )
+    {
+        ( void ) xTraceRecorderStart( eTraceStream );
+    }
+    #endif /* TRACE_RECORDER_MODE */
 
-    for( ; ; )
+    #if ( STACK_PROFILE == 1 )
     {
-        /* Place this task in the blocked state until it is time to run again */      
-        vTaskDelayUntil( &xNextWakeTime, xBlockTime );
-
-        /* Check the state of each appliance and calculate the total power consumption based on which devices are active.*/
-        uint16_t usConsumedPower = 0;
-        for (uint8_t i=0; i < NUM_DEVICES; i++){
-            if (xDevices[i].bStatus == 1){
-                usConsumedPower += xDevices[i].usPower;
-            }
-        }
+        ( void ) xStackProfileStart( pdMS_TO_TICKS( 1000UL ) );
+    }
+    #endif /* STACK_PROFILE */
 
-        uint16_t usEnergy = usConsumedPower * TIME_NUMERATOR / TIME_DENOMINATOR;
-        
-        /*  Update battery level if we have enough battery */
-        if (lBatteryLevel > usEnergy)
-        {
-            if( xSemaphoreTake( xSemaphore, ( TickType_t ) pdMS_TO_TICKS(10UL) ) == pdTRUE )
-            {
-                lBatteryLevel -= usEnergy;
-                xSemaphoreGive( xSemaphore );
-            }
-            else
-            {
-                printf( "Could not update battery\r\n" );
-            }
-        }
-        else
-        {
-            // Signal to the Grid Interaction Task we are buying energy
-            int16_t sValueToSend = -usEnergy; 
-            xQueueSend( xQueueGrid, &sValueToSend, 0U );
-            
-        }
+    if( pxEnergyManagementStart( &xConfig ) != NULL )
+    {
+        vTaskStartScheduler();
     }
+
+    // The scheduler should never return. If it does, loop indefinitely.
+    for( ; ; ){}
 }
 /*-----------------------------------------------------------*/
 
-void vTaskGridInteraction( void * pvParameters )
-{
-    int16_t usReceivedValue;
-
-    /* Prevent the compiler warning about the unused parameter. */
-    ( void ) pvParameters;
+#if ( RUN_KERNEL_BENCHMARK == 1 )
 
-    for( ; ; )
+    static void prvKernelBenchmarkTask( void * pvParameters )
     {
-        /* Wait until something arrives in the queue - this task will block indefinitely */
-        xQueueReceive( xQueueGrid, &usReceivedValue, portMAX_DELAY );
-
-        /* Add to the bill. Divide by 100 to convert from cent/1000 to cent/10 */
-        lBill += usReceivedValue * ENERGY_PRICE(xTaskGetTickCount());
+        ( void ) pvParameters;
 
-        printf("Bill: %d\n", lBill/100); 
+        vKernelBenchmarkRun( "mps2" );
+        vTaskDelete( NULL );
     }
-}
+
+#endif /* RUN_KERNEL_BENCHMARK */
 /*-----------------------------------------------------------*/
 
 void vApplicationMallocFailedHook( void )
@@ -395,6 +240,7 @@ void vApplicationMallocFailedHook( void )
      * (although it does not provide information on how the remaining heap might be
      * fragmented).  See http://www.freertos.org/a00111.html for more
      * information. */
+    vSerialLogPanic();
     printf( "\r\n\r\nMalloc failed\r\n" );
     portDISABLE_INTERRUPTS();
 
@@ -427,6 +273,7 @@ void vApplicationStackOverflowHook( TaskHandle_t pxTask,
     /* Run time stack overflow checking is performed if
      * configCHECK_FOR_STACK_OVERFLOW is defined to 1 or 2.  This hook
      * function is called if a stack overflow is detected. */
+    vSerialLogPanic();
     printf( "\r\n\r\nStack overflow in %s\r\n", pcTaskName );
     portDISABLE_INTERRUPTS();
 
@@ -471,8 +318,16 @@ void vAssertCalled( const char * pcFileName,
     /* Called if an assertion passed to configASSERT() fails.  See
      * http://www.freertos.org/a00110.html#configASSERT for more information. */
 
+    vSerialLogPanic();
     printf( "ASSERT! Line %d, file %s\r\n", ( int ) ulLine, pcFileName );
 
+    #if ( TRACE_RECORDER_MODE != 0 )
+    {
+        /* What led up to the assertion. */
+        vTraceRecorderDump();
+    }
+    #endif /* TRACE_RECORDER_MODE */
+
     taskENTER_CRITICAL();
     {
         /* You can step out of this function to debug the assertion by using
@@ -542,37 +397,6 @@ void vApplicationGetTimerTaskMemory( StaticTask_t ** ppxTimerTaskTCBBuffer,
 }
 /*-----------------------------------------------------------*/
 
-static void prvUARTInit( void )
-{
-    UART0_BAUDDIV = 16;
-    UART0_CTRL = 1;
-}
-/*-----------------------------------------------------------*/
-
-int __write( int iFile,
-             char * pcString,
-             int iStringLength )
-{
-    int iNextChar;
-
-    /* Avoid compiler warnings about unused parameters. */
-    ( void ) iFile;
-
-    /* Output the formatted string to the UART. */
-    for( iNextChar = 0; iNextChar < iStringLength; iNextChar++ )
-    {
-        while( ( UART0_STATE & TX_BUFFER_MASK ) != 0 )
-        {
-        }
-
-        UART0_DATA = *pcString;
-        pcString++;
-    }
-
-    return iStringLength;
-}
-/*-----------------------------------------------------------*/
-
 void * malloc( size_t size )
 {
     ( void ) size;
@@ -580,6 +404,7 @@ void * malloc( size_t size )
     /* This project uses heap_4 so doesn't set up a heap for use by the C
      * library - but something is calling the C library malloc().  See
      * https://freertos.org/a00111.html for more information. */
+    vSerialLogPanic();
     printf( "\r\n\r\nUnexpected call to malloc() - should be usine pvPortMalloc()\r\n" );
     portDISABLE_INTERRUPTS();
 
@@ -0,0 +1,112 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/*-----------------------------------------------------------
+* Application specific definitions.
+*
+* These definitions should be adjusted for your particular hardware and
+* application requirements.
+*
+* THESE PARAMETERS ARE DESCRIBED WITHIN THE 'CONFIGURATION' SECTION OF THE
+* FreeRTOS API DOCUMENTATION AVAILABLE ON THE FreeRTOS.org WEB SITE.
+*
+* See http://www.freertos.org/a00110.html
+*----------------------------------------------------------*/
+
+/* Set to 1 to advance the tick count whenever every task is blocked rather
+ * than against the wall clock, so simulated time passes as fast as the host
+ * can run the application.  The Makefile sets this from VIRTUAL_TIME. */
+#ifndef configPOSIX_VIRTUAL_TIME
+    #define configPOSIX_VIRTUAL_TIME             1
+#endif
+
+/* Virtual time is implemented by the tickless idle hook of the Posix port. */
+#define configUSE_TICKLESS_IDLE                  configPOSIX_VIRTUAL_TIME
+
+/* The port's run time counter is the process's CPU time in clock ticks, too
+ * coarse to be useful.  LoopStats.h times the energy tasks instead.  The trace
+ * facility gives the tasks and queues the numbers TraceRecorder.h uses. */
+#define configUSE_TRACE_FACILITY                 1
+#define configGENERATE_RUN_TIME_STATS            0
+
+#define configUSE_PREEMPTION                     1
+#define configTICK_TYPE_WIDTH_IN_BITS            TICK_TYPE_WIDTH_64_BITS
+#define configUSE_IDLE_HOOK                      1
+#define configUSE_TICK_HOOK                      0
+#define configTICK_RATE_HZ                       ( ( TickType_t ) 1000 )
+#define configMINIMAL_STACK_SIZE                 ( ( unsigned short ) PTHREAD_STACK_MIN )
+#define configTOTAL_HEAP_SIZE                    ( ( size_t ) ( 64 * 1024 ) )
+#define configMAX_TASK_NAME_LEN                  ( 12 )
+#define configIDLE_SHOULD_YIELD                  0
+#define configUSE_CO_ROUTINES                    0
+#define configUSE_MUTEXES                        1
+#define configUSE_RECURSIVE_MUTEXES              1
+#define configCHECK_FOR_STACK_OVERFLOW           0
+#define configUSE_MALLOC_FAILED_HOOK             1
+#define configUSE_COUNTING_SEMAPHORES            1
+
+#define configMAX_PRIORITIES                     ( 7UL )
+#define configQUEUE_REGISTRY_SIZE                0
+#define configSUPPORT_STATIC_ALLOCATION          0
+#define configSUPPORT_DYNAMIC_ALLOCATION         1
+
+/* The energy application does not use software timers. */
+#define configUSE_TIMERS                         0
+
+#define configUSE_TASK_NOTIFICATIONS             1
+
+/* Pointer 0 is the task's LoopStats.h record. */
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS  1
+
+/* Set the following definitions to 1 to include the API function, or zero
+ * to exclude the API function. */
+
+#define INCLUDE_vTaskPrioritySet                  1
+#define INCLUDE_uxTaskPriorityGet                 1
+#define INCLUDE_vTaskDelete                       1
+#define INCLUDE_vTaskSuspend                      1
+#define INCLUDE_vTaskDelayUntil                   1
+#define INCLUDE_vTaskDelay                        1
+#define INCLUDE_uxTaskGetStackHighWaterMark       1
+#define INCLUDE_xTaskGetSchedulerState            1
+#define INCLUDE_xTaskGetIdleTaskHandle            1
+
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION   0
+
+void vAssertCalled( const char * pcFileName,
+                    uint32_t ulLine );
+#define configASSERT( x )    if( ( x ) == 0 ) vAssertCalled( __FILE__, __LINE__ );
+
+/* Time the energy tasks and record what the kernel does, see LoopStats.h and
+ * TraceRecorder.h. */
+#include "TraceHooks.h"
+
+#define configENABLE_BACKWARD_COMPATIBILITY       0
+
+#endif /* FREERTOS_CONFIG_H */
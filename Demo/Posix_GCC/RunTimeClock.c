@@ -0,0 +1,69 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * High resolution clock for the Posix build, see RunTimeClock.h.  Counts
+ * nanoseconds of the host's monotonic clock, so with virtual time it
+ * measures how long the host took rather than simulated time.  Nanoseconds
+ * are fine enough to time single kernel operations, see KernelBenchmark.h,
+ * and the count wraps every four seconds or so.
+ */
+
+/* Standard includes. */
+#include <time.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+
+/* Demo includes. */
+#include "RunTimeClock.h"
+
+#define clockHZ    ( 1000000000UL )
+
+/*-----------------------------------------------------------*/
+
+void vRunTimeClockInit( void )
+{
+    /* The host clock is always running. */
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulRunTimeClockGet( void )
+{
+    struct timespec xNow;
+
+    /* clock_gettime() is safe to call from the port's signal handlers. */
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( uint32_t ) ( ( ( uint64_t ) xNow.tv_sec * clockHZ ) + ( uint64_t ) xNow.tv_nsec );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulRunTimeClockGetHz( void )
+{
+    return clockHZ;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,118 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Console output for the Posix build.  Implements SerialLog.h on top of the
+ * process's standard output, so the telemetry frames written by the energy
+ * application can be redirected to a file and decoded with
+ * tools/telemetry_decode.py.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "SerialLog.h"
+
+/* Bytes lost because standard output could not be written. */
+static uint32_t ulDroppedBytes = 0;
+
+/*-----------------------------------------------------------*/
+
+void vSerialLogInit( void )
+{
+    /* printf() is only used for occasional messages.  Leave it unbuffered so
+     * its output stays in order with the frames written below. */
+    setvbuf( stdout, NULL, _IONBF, 0 );
+}
+/*-----------------------------------------------------------*/
+
+size_t xSerialLogWrite( const void * pvData,
+                        size_t xLength )
+{
+    const uint8_t * pucData = ( const uint8_t * ) pvData;
+    size_t xWritten = 0;
+    ssize_t xResult;
+    BaseType_t xSchedulerRunning;
+
+    /* As on the target, writers are serialised by suspending the scheduler,
+     * so a frame is never interleaved with another task's output. */
+    xSchedulerRunning = ( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED ) ? pdTRUE : pdFALSE;
+
+    if( xSchedulerRunning != pdFALSE )
+    {
+        vTaskSuspendAll();
+    }
+
+    while( xWritten < xLength )
+    {
+        xResult = write( STDOUT_FILENO, &pucData[ xWritten ], xLength - xWritten );
+
+        if( xResult > 0 )
+        {
+            xWritten += ( size_t ) xResult;
+        }
+        else if( ( xResult < 0 ) && ( errno == EINTR ) )
+        {
+            /* Interrupted by the tick signal, try again. */
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if( xWritten < xLength )
+    {
+        ulDroppedBytes += ( uint32_t ) ( xLength - xWritten );
+    }
+
+    if( xSchedulerRunning != pdFALSE )
+    {
+        ( void ) xTaskResumeAll();
+    }
+
+    return xWritten;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulSerialLogGetDroppedBytes( void )
+{
+    return ulDroppedBytes;
+}
+/*-----------------------------------------------------------*/
+
+void vSerialLogPanic( void )
+{
+    /* Nothing is buffered. */
+}
+/*-----------------------------------------------------------*/
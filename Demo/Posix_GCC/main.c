@@ -0,0 +1,911 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/******************************************************************************
+ * Host build of the household energy application, running on the Posix port.
+ *
+ * The application in EnergyManagement.c is the one that runs on the MPS2
+ * target.  One second of run time represents one hour, so on the target a
+ * simulated year takes well over two hours.  Built with VIRTUAL_TIME=1 (the
+ * default) the Posix port advances the tick count whenever every task is
+ * blocked, instead of waiting for the wall clock, and a year runs in seconds.
+ *
+ * Usage:
+ *   ./output/posix_energy [options] > capture.bin
+ *
+ *   -d days          simulated days to run for (365)
+ *   -c capacity      battery capacity in W.h
+ *   -i level         energy in the battery at start up, in W.h
+ *   -a amplitude     peak solar power in W
+ *   -b base_price    mean price of energy in miliCents/W.h
+ *   -p amplitude     swing of the price either side of the mean
+ *   -e price         flat price paid for energy sold, instead of the price
+ *                    of energy bought
+ *   -u schedule      time of use prices instead of the price curve, as
+ *                    HH:MM=import/export,... in order of time
+ *   -t tiers         import tier surcharges, as from_Wh=surcharge,...
+ *   -f charge        fixed charge for each day, in miliCents
+ *   -l name:W:prio:on
+ *                    register a device, replacing the default list.  Repeat
+ *                    for each device, on is 1 or 0.
+ *   -r profile       replay a recorded profile made by tools/profile_encode.py
+ *   -o policy        battery dispatch, greedy to store all surplus solar
+ *                    energy or optimised to plan against the price curve
+ *   -w power         most power the battery trades with the grid, in W
+ *   -m model         battery model, ideal for a lossless battery or li-ion
+ *                    for a typical home battery, see BatteryModel.h
+ *   -F alpha,beta,gamma
+ *                    smoothing of the solar and load forecasts, each between
+ *                    0 and 1, see EnergyForecast.h.  0,0,1 forecasts each hour
+ *                    to be as it was the day before.
+ *   -H               before the summary, print the last day by the hour and
+ *                    the last month by the day from the history, of the
+ *                    first household
+ *   -S               before the summary, print how much CPU time the tasks
+ *                    of the first household used, how late they woke and how
+ *                    long samples waited on its bus, in us of host time, see
+ *                    LoopStats.h
+ *   -R mode          record what the kernel does, see TraceRecorder.h.  In
+ *                    snapshot mode the last events recorded are written at
+ *                    the end, in stream mode all of them as they happen.
+ *                    Decode the capture with tools/trace_decode.py.
+ *   -n households    number of households in the community (1), each as
+ *                    configured by the options above
+ *   -s households    number of the households with solar panels, the first
+ *                    ones (all).  The others have none, unless a profile is
+ *                    replayed, which all of them do.
+ *   -T period        ms of run time between the samples of the households
+ *                    (200, which is 12 simulated minutes), from 1 to 1000
+ *   -P workers       step the households on a pool of this many worker tasks
+ *                    instead of giving each its own tasks, see EnergyPool.h
+ *
+ * Anything not given takes its value from EnergyConfig.h.  The telemetry
+ * frames are written to standard output, see tools/telemetry_decode.py.  After
+ * the requested number of simulated days a summary line of key=value pairs is
+ * printed to standard error and the program exits.  Bills in it are in micro
+ * cents, the bill of the last whole month of 30 days included.  With more than
+ * one household the bills, battery levels and energies are the sums over all of
+ * them, and the community's grid flow once energy shared between households is
+ * netted out follows, see EnergyCommunity.h.  The battery's conversion losses
+ * and self-discharge are in W.h, its wear as equivalent full cycles averaged
+ * over the households, as are the mean absolute errors of the hourly solar and
+ * load forecasts, in W.  Only the first household sends telemetry.
+ * tools/scenario_runner.py runs many of these at once and collects the
+ * summaries.
+ */
+
+/* Standard includes. */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "SerialLog.h"
+#include "EnergyManagement.h"
+#include "EnergyCommunity.h"
+#include "EnergyPool.h"
+#include "TraceRecorder.h"
+
+/* One second of run time represents one hour, see EnergyConfig.h. */
+#define mainTICKS_PER_DAY             pdMS_TO_TICKS( 24UL * 1000UL )
+
+/* Simulated days to run for when -d is not given. */
+#define mainDEFAULT_DAYS              ( 365UL )
+
+/* Most devices that can be given with -l. */
+#define mainMAX_DEVICES               ( 64 )
+
+/* Most households that can be given with -n. */
+#define mainMAX_HOUSEHOLDS            ( 256 )
+
+/* Most periods that can be given with -u. */
+#define mainMAX_PERIODS               ( 48 )
+
+/* The supervisor runs above the energy tasks so it stops the simulation on
+ * the tick it was asked to. */
+#define mainSUPERVISOR_PRIORITY       ( configMAX_PRIORITIES - 1 )
+
+/*
+ * Waits for the requested number of simulated days, then prints a summary and
+ * ends the process.
+ */
+static void prvSupervisorTask( void * pvParameters );
+
+/*
+ * Parse a device given as name:W:prio:on into pxDevice.  pcArg is modified, and
+ * the name is left pointing into it.  Returns pdFAIL if it is malformed.
+ */
+static BaseType_t prvParseDevice( char * pcArg,
+                                  Appliance * pxDevice );
+
+/*
+ * Parse a time of use schedule given as HH:MM=import/export,... and a list of
+ * tiers given as from_Wh=surcharge,... into xConfig.  Return pdFAIL if
+ * malformed.
+ */
+static BaseType_t prvParseSchedule( char * pcArg );
+static BaseType_t prvParseTiers( char * pcArg );
+
+/*
+ * Parse a whole number that fits an int32_t into *plValue.  Returns pdFAIL if
+ * malformed or out of range.
+ */
+static BaseType_t prvParseInt32( const char * pcArg,
+                                 int32_t * plValue );
+
+/*
+ * Returns pdFAIL unless the amplitude of pxCurve fits the 16 bits
+ * lEnergyCurveEvaluate() allows, and the curve stays within an int32_t.
+ */
+static BaseType_t prvCheckCurve( const EnergyCurve_t * pxCurve );
+
+/*
+ * Parse forecast smoothing factors given as alpha,beta,gamma into pxParams.
+ * Returns pdFAIL if malformed or not between 0 and 1.
+ */
+static BaseType_t prvParseForecast( const char * pcArg,
+                                    EnergyForecastParams_t * pxParams );
+
+/*
+ * Map the profile in pcPath into memory and point xConfig at it.  The
+ * mapping is never released, it is read until the process exits.  Returns
+ * pdFAIL if the file cannot be mapped.
+ */
+static BaseType_t prvMapProfile( const char * pcPath );
+
+/*
+ * Print the records of a tier of the history since xSince to standard error.
+ */
+static void prvPrintHistory( eHistoryTier eTier,
+                             TickType_t xSince );
+
+/*
+ * Print the timing of the tasks of the first household, and how long samples
+ * waited on its bus, to standard error.
+ */
+static void prvPrintLoopStats( void );
+
+/*
+ * Seconds of wall time since xStartTime.
+ */
+static double prvElapsedSeconds( void );
+
+/*-----------------------------------------------------------*/
+
+/* Simulated days to run for. */
+static unsigned long ulDays = mainDEFAULT_DAYS;
+
+/* The household being simulated, and the devices given with -l. */
+static EnergyManagementConfig_t xConfig;
+static Appliance xDevices[ mainMAX_DEVICES ];
+
+/* The time of use schedule given with -u and the tiers given with -t. */
+static TariffPeriod_t xPeriods[ mainMAX_PERIODS ];
+static TariffTier_t xTiers[ tariffMAX_TIERS ];
+
+/* The households of the community, the number of them with solar panels, and
+ * the aggregator that adds them up. */
+static EnergyHousehold_t * pxHouseholds[ mainMAX_HOUSEHOLDS ];
+static unsigned long ulNumHouseholds = 1;
+static unsigned long ulSolarHouseholds = mainMAX_HOUSEHOLDS;
+static EnergyCommunity_t * pxCommunity = NULL;
+
+/* Workers to step the households on, or 0 for them to have their own tasks. */
+static unsigned long ulWorkers = 0;
+
+/* Whether to print the history, and the timing of the tasks, before the
+ * summary. */
+static BaseType_t xPrintHistory = pdFALSE;
+static BaseType_t xPrintLoopStats = pdFALSE;
+
+/* Mode to record the kernel's events in, given with -R. */
+static eTraceMode eTrace = eTraceOff;
+
+/* Wall time at which the scheduler was started. */
+static struct timespec xStartTime;
+
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    int iOption;
+    size_t xNumDevices = 0;
+    unsigned long ulHousehold;
+    BaseType_t xValid = pdTRUE;
+    BaseType_t xExportGiven = pdFALSE;
+    const BatteryModelParams_t xIdealModel = modelIDEAL;
+    const BatteryModelParams_t xLithiumIonModel = modelLITHIUM_ION;
+
+    vEnergyManagementGetDefaultConfig( &xConfig );
+
+    while( ( xValid != pdFALSE ) && ( ( iOption = getopt( argc, argv, "d:c:i:a:b:p:e:u:t:f:l:r:o:w:m:F:HSR:n:s:T:P:" ) ) != -1 ) )
+    {
+        switch( iOption )
+        {
+            case 'd':
+                ulDays = strtoul( optarg, NULL, 0 );
+                break;
+
+            case 'c':
+                xConfig.ulCapacity = ( uint32_t ) strtoul( optarg, NULL, 0 );
+                break;
+
+            case 'i':
+                xConfig.ulInitialBatteryLevel = ( uint32_t ) strtoul( optarg, NULL, 0 );
+                break;
+
+            case 'a':
+                xValid = prvParseInt32( optarg, &( xConfig.xSolarCurve.lAmplitude ) );
+                break;
+
+            case 'b':
+                xValid = prvParseInt32( optarg, &( xConfig.xTariff.xImportCurve.lOffset ) );
+                break;
+
+            case 'p':
+                xValid = prvParseInt32( optarg, &( xConfig.xTariff.xImportCurve.lAmplitude ) );
+                break;
+
+            case 'e':
+                xExportGiven = pdTRUE;
+                xConfig.xTariff.xExportCurve.lAmplitude = 0;
+                xValid = prvParseInt32( optarg, &( xConfig.xTariff.xExportCurve.lOffset ) );
+                break;
+
+            case 'u':
+                xValid = prvParseSchedule( optarg );
+                break;
+
+            case 't':
+                xValid = prvParseTiers( optarg );
+                break;
+
+            case 'f':
+                xConfig.xTariff.ulDailyCharge = ( uint32_t ) strtoul( optarg, NULL, 0 );
+                break;
+
+            case 'l':
+
+                if( xNumDevices < mainMAX_DEVICES )
+                {
+                    xValid = prvParseDevice( optarg, &xDevices[ xNumDevices ] );
+                    xNumDevices++;
+                }
+                else
+                {
+                    xValid = pdFALSE;
+                }
+
+                break;
+
+            case 'r':
+                xValid = prvMapProfile( optarg );
+                break;
+
+            case 'o':
+
+                if( strcmp( optarg, "greedy" ) == 0 )
+                {
+                    xConfig.xOptimisedDispatch = pdFALSE;
+                }
+                else if( strcmp( optarg, "optimised" ) == 0 )
+                {
+                    xConfig.xOptimisedDispatch = pdTRUE;
+                }
+                else
+                {
+                    xValid = pdFALSE;
+                }
+
+                break;
+
+            case 'w':
+                xConfig.ulMaxPower = ( uint32_t ) strtoul( optarg, NULL, 0 );
+                break;
+
+            case 'm':
+
+                if( strcmp( optarg, "ideal" ) == 0 )
+                {
+                    xConfig.xBatteryModel = xIdealModel;
+                }
+                else if( strcmp( optarg, "li-ion" ) == 0 )
+                {
+                    xConfig.xBatteryModel = xLithiumIonModel;
+                }
+                else
+                {
+                    xValid = pdFALSE;
+                }
+
+                break;
+
+            case 'F':
+                xValid = prvParseForecast( optarg, &( xConfig.xForecast ) );
+                break;
+
+            case 'H':
+                xPrintHistory = pdTRUE;
+                break;
+
+            case 'S':
+                xPrintLoopStats = pdTRUE;
+                break;
+
+            case 'R':
+
+                if( strcmp( optarg, "snapshot" ) == 0 )
+                {
+                    eTrace = eTraceSnapshot;
+                }
+                else if( strcmp( optarg, "stream" ) == 0 )
+                {
+                    eTrace = eTraceStream;
+                }
+                else
+                {
+                    xValid = pdFALSE;
+                }
+
+                break;
+
+            case 'n':
+                ulNumHouseholds = strtoul( optarg, NULL, 0 );
+                break;
+
+            case 's':
+                ulSolarHouseholds = strtoul( optarg, NULL, 0 );
+                break;
+
+            case 'T':
+                xConfig.xPeriod = pdMS_TO_TICKS( strtoul( optarg, NULL, 0 ) );
+                break;
+
+            case 'P':
+                ulWorkers = strtoul( optarg, NULL, 0 );
+                break;
+
+            default:
+                xValid = pdFALSE;
+                break;
+        }
+    }
+
+    /* Energy is sold at the price it is bought at unless -e says otherwise. */
+    if( xExportGiven == pdFALSE )
+    {
+        xConfig.xTariff.xExportCurve = xConfig.xTariff.xImportCurve;
+    }
+
+    if( xNumDevices > 0 )
+    {
+        xConfig.pxDevices = xDevices;
+        xConfig.xNumDevices = xNumDevices;
+    }
+
+    if( ( xConfig.ulCapacity == 0UL ) || ( xConfig.ulCapacity > ( uint32_t ) INT32_MAX ) ||
+        ( xConfig.ulInitialBatteryLevel > xConfig.ulCapacity ) ||
+        ( prvCheckCurve( &( xConfig.xSolarCurve ) ) == pdFAIL ) ||
+        ( prvCheckCurve( &( xConfig.xTariff.xImportCurve ) ) == pdFAIL ) ||
+        ( prvCheckCurve( &( xConfig.xTariff.xExportCurve ) ) == pdFAIL ) ||
+        ( ulNumHouseholds == 0UL ) || ( ulNumHouseholds > mainMAX_HOUSEHOLDS ) ||
+        ( ulWorkers > poolMAX_WORKERS ) ||
+        ( xConfig.xPeriod == 0U ) || ( xConfig.xPeriod > xEnergyManagementGetHourTicks() ) )
+    {
+        xValid = pdFALSE;
+    }
+
+    if( xValid == pdFALSE )
+    {
+        fprintf( stderr, "usage: %s [-d days] [-c capacity] [-i level] [-a amplitude] "
+                         "[-b base_price] [-p amplitude] [-e price] [-u schedule] [-t tiers] [-f charge] "
+                         "[-l name:W:prio:on]... [-r profile] "
+                         "[-o greedy|optimised] [-w power] [-m ideal|li-ion] [-F alpha,beta,gamma] [-H] [-S] [-R snapshot|stream] [-n households] [-s households] [-T period] [-P workers]\n", argv[ 0 ] );
+        return EXIT_FAILURE;
+    }
+
+    vSerialLogInit();
+
+    /* Start the households, the first sending the telemetry, and add them up
+     * once there is more than one. */
+    for( ulHousehold = 0; ( ulHousehold < ulNumHouseholds ) && ( xValid != pdFALSE ); ulHousehold++ )
+    {
+        if( ulHousehold == ulSolarHouseholds )
+        {
+            xConfig.xSolarCurve.lOffset = 0;
+            xConfig.xSolarCurve.lAmplitude = 0;
+        }
+
+        xConfig.xTelemetry = ( ulHousehold == 0UL ) ? pdTRUE : pdFALSE;
+        xConfig.xPooled = ( ulWorkers > 0UL ) ? pdTRUE : pdFALSE;
+        pxHouseholds[ ulHousehold ] = pxEnergyManagementStart( &xConfig );
+        xValid = ( pxHouseholds[ ulHousehold ] != NULL ) ? pdTRUE : pdFALSE;
+    }
+
+    if( ( xValid != pdFALSE ) && ( ulWorkers > 0UL ) )
+    {
+        xValid = ( pxEnergyPoolStart( pxHouseholds, ( size_t ) ulNumHouseholds, ( UBaseType_t ) ulWorkers ) != NULL ) ? pdTRUE : pdFALSE;
+    }
+
+    if( ( xValid != pdFALSE ) && ( ulNumHouseholds > 1UL ) )
+    {
+        pxCommunity = pxEnergyCommunityStart( pxHouseholds, ( size_t ) ulNumHouseholds );
+        xValid = ( pxCommunity != NULL ) ? pdTRUE : pdFALSE;
+    }
+
+    if( ( xValid != pdFALSE ) && ( eTrace != eTraceOff ) )
+    {
+        xValid = xTraceRecorderStart( eTrace );
+    }
+
+    if( ( xValid != pdFALSE ) &&
+        ( xTaskCreate( prvSupervisorTask, "Supervisor", configMINIMAL_STACK_SIZE, NULL, mainSUPERVISOR_PRIORITY, NULL ) == pdPASS ) )
+    {
+        clock_gettime( CLOCK_MONOTONIC, &xStartTime );
+        vTaskStartScheduler();
+    }
+
+    /* The scheduler only returns if it could not be started. */
+    fprintf( stderr, "Could not start the energy application\n" );
+
+    return EXIT_FAILURE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSupervisorTask( void * pvParameters )
+{
+    EnergyManagementTotals_t xTotals, xHousehold;
+    EnergyAccountSettlement_t xMonth, xHouseholdMonth;
+    EnergyCommunityTotals_t xCommunity;
+    const uint64_t * pullEnergy = xTotals.xAccount.ullEnergy;
+    unsigned long ulHousehold;
+    size_t xFlow;
+
+    ( void ) pvParameters;
+
+    vTaskDelay( ( TickType_t ) ulDays * mainTICKS_PER_DAY );
+
+    /* Add up the households.  The settlements of all of them are made on the
+     * same tick, so are for the same month. */
+    memset( &xTotals, 0x00, sizeof( xTotals ) );
+    memset( &xMonth, 0x00, sizeof( xMonth ) );
+
+    for( ulHousehold = 0; ulHousehold < ulNumHouseholds; ulHousehold++ )
+    {
+        vEnergyManagementGetTotals( pxHouseholds[ ulHousehold ], &xHousehold );
+        xTotals.xAccount.llBill += xHousehold.xAccount.llBill;
+        xTotals.ulBatteryLevel += xHousehold.ulBatteryLevel;
+        xTotals.ulPlans += xHousehold.ulPlans;
+        xTotals.ulTrades += xHousehold.ulTrades;
+        xTotals.ulSettlements += xHousehold.ulSettlements;
+        xTotals.xBattery.ulChargeLoss += xHousehold.xBattery.ulChargeLoss;
+        xTotals.xBattery.ulDischargeLoss += xHousehold.xBattery.ulDischargeLoss;
+        xTotals.xBattery.ulSelfDischarge += xHousehold.xBattery.ulSelfDischarge;
+        xTotals.xBattery.ulMilliCycles += xHousehold.xBattery.ulMilliCycles;
+        xTotals.xBattery.ulCapacity += xHousehold.xBattery.ulCapacity;
+        xTotals.ulSolarForecastError += xHousehold.ulSolarForecastError;
+        xTotals.ulLoadForecastError += xHousehold.ulLoadForecastError;
+
+        for( xFlow = 0; xFlow < accountNUM_FLOWS; xFlow++ )
+        {
+            xTotals.xAccount.ullEnergy[ xFlow ] += xHousehold.xAccount.ullEnergy[ xFlow ];
+        }
+
+        if( xEnergyManagementGetSettlement( pxHouseholds[ ulHousehold ], eAccountMonth, &xHouseholdMonth ) != pdFALSE )
+        {
+            xMonth.xTotals.llBill += xHouseholdMonth.xTotals.llBill;
+        }
+    }
+
+    if( xPrintHistory != pdFALSE )
+    {
+        prvPrintHistory( eHistoryHourly, xTaskGetTickCount() - mainTICKS_PER_DAY );
+        prvPrintHistory( eHistoryDaily, 0 );
+    }
+
+    if( xPrintLoopStats != pdFALSE )
+    {
+        prvPrintLoopStats();
+    }
+
+    /* Write out what is left of the trace.  Recording stops first, so the
+     * writing is not itself recorded. */
+    if( eTrace != eTraceOff )
+    {
+        vTraceRecorderDump();
+    }
+
+    /* The bills are exact, in micro cents.  Energy is rounded down to W.h. */
+    fprintf( stderr, "days=%lu seconds=%.3f bill_ucents=%lld battery=%lu generated=%llu consumed=%llu imported=%llu exported=%llu "
+                     "solar_exported=%llu plans=%lu month_bill_ucents=%lld losses=%lu self_discharge=%lu cycles=%.3f capacity=%lu "
+                     "solar_forecast_error=%lu load_forecast_error=%lu trades=%lu settlements=%lu",
+             ulDays,
+             prvElapsedSeconds(),
+             ( long long ) xTotals.xAccount.llBill,
+             ( unsigned long ) xTotals.ulBatteryLevel,
+             ( unsigned long long ) ( pullEnergy[ eEnergyGenerated ] / accountMICRO ),
+             ( unsigned long long ) ( pullEnergy[ eEnergyConsumed ] / accountMICRO ),
+             ( unsigned long long ) ( pullEnergy[ eEnergyImported ] / accountMICRO ),
+             ( unsigned long long ) ( pullEnergy[ eEnergyExported ] / accountMICRO ),
+             ( unsigned long long ) ( pullEnergy[ eEnergySolarExported ] / accountMICRO ),
+             ( unsigned long ) xTotals.ulPlans,
+             ( long long ) xMonth.xTotals.llBill,
+             ( unsigned long ) ( xTotals.xBattery.ulChargeLoss + xTotals.xBattery.ulDischargeLoss ),
+             ( unsigned long ) xTotals.xBattery.ulSelfDischarge,
+             ( double ) xTotals.xBattery.ulMilliCycles / ( 1000.0 * ( double ) ulNumHouseholds ),
+             ( unsigned long ) xTotals.xBattery.ulCapacity,
+             ( unsigned long ) ( xTotals.ulSolarForecastError / ulNumHouseholds ),
+             ( unsigned long ) ( xTotals.ulLoadForecastError / ulNumHouseholds ),
+             ( unsigned long ) xTotals.ulTrades,
+             ( unsigned long ) xTotals.ulSettlements );
+
+    if( pxCommunity != NULL )
+    {
+        vEnergyCommunityGetTotals( pxCommunity, &xCommunity );
+        fprintf( stderr, " households=%lu community_imported=%llu community_exported=%llu shared=%llu peak_import=%lu",
+                 ulNumHouseholds,
+                 ( unsigned long long ) ( xCommunity.ullImported / accountMICRO ),
+                 ( unsigned long long ) ( xCommunity.ullExported / accountMICRO ),
+                 ( unsigned long long ) ( xCommunity.ullShared / accountMICRO ),
+                 ( unsigned long ) xCommunity.ulPeakImport );
+    }
+
+    fprintf( stderr, "\n" );
+
+    exit( EXIT_SUCCESS );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvParseDevice( char * pcArg,
+                                  Appliance * pxDevice )
+{
+    char * pcFields[ 4 ];
+    char * pcSave = NULL;
+    unsigned long ulPower, ulPriority;
+    BaseType_t xReturn = pdFAIL;
+    size_t x;
+
+    pcFields[ 0 ] = strtok_r( pcArg, ":", &pcSave );
+
+    for( x = 1; x < 4; x++ )
+    {
+        pcFields[ x ] = strtok_r( NULL, ":", &pcSave );
+    }
+
+    if( pcFields[ 3 ] != NULL )
+    {
+        ulPower = strtoul( pcFields[ 1 ], NULL, 0 );
+        ulPriority = strtoul( pcFields[ 2 ], NULL, 0 );
+
+        if( ( ulPower <= UINT16_MAX ) && ( ulPriority < applianceNUM_PRIORITIES ) )
+        {
+            pxDevice->pcName = pcFields[ 0 ];
+            pxDevice->usPower = ( uint16_t ) ulPower;
+            pxDevice->ucPriority = ( uint8_t ) ulPriority;
+            pxDevice->bStatus = ( strtoul( pcFields[ 3 ], NULL, 0 ) != 0UL );
+            xReturn = pdPASS;
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvParseSchedule( char * pcArg )
+{
+    char * pcPeriod;
+    char * pcSave = NULL;
+    unsigned int uiHour, uiMinute;
+    long lImport, lExport;
+    size_t xNumPeriods = 0;
+    BaseType_t xReturn = pdPASS;
+
+    for( pcPeriod = strtok_r( pcArg, ",", &pcSave );
+         ( pcPeriod != NULL ) && ( xReturn == pdPASS );
+         pcPeriod = strtok_r( NULL, ",", &pcSave ) )
+    {
+        if( ( xNumPeriods < mainMAX_PERIODS ) &&
+            ( sscanf( pcPeriod, "%u:%u=%ld/%ld", &uiHour, &uiMinute, &lImport, &lExport ) == 4 ) &&
+            ( uiHour < 24U ) && ( uiMinute < 60U ) )
+        {
+            xPeriods[ xNumPeriods ].usStartMinute = ( uint16_t ) ( ( uiHour * 60U ) + uiMinute );
+            xPeriods[ xNumPeriods ].lImport = ( int32_t ) lImport;
+            xPeriods[ xNumPeriods ].lExport = ( int32_t ) lExport;
+
+            if( ( xNumPeriods > 0 ) && ( xPeriods[ xNumPeriods ].usStartMinute <= xPeriods[ xNumPeriods - 1 ].usStartMinute ) )
+            {
+                xReturn = pdFAIL;
+            }
+
+            xNumPeriods++;
+        }
+        else
+        {
+            xReturn = pdFAIL;
+        }
+    }
+
+    if( xNumPeriods == 0 )
+    {
+        xReturn = pdFAIL;
+    }
+
+    xConfig.xTariff.pxPeriods = xPeriods;
+    xConfig.xTariff.xNumPeriods = xNumPeriods;
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvParseTiers( char * pcArg )
+{
+    char * pcTier;
+    char * pcSave = NULL;
+    unsigned long ulFrom;
+    long lSurcharge;
+    size_t xNumTiers = 0;
+    BaseType_t xReturn = pdPASS;
+
+    for( pcTier = strtok_r( pcArg, ",", &pcSave );
+         ( pcTier != NULL ) && ( xReturn == pdPASS );
+         pcTier = strtok_r( NULL, ",", &pcSave ) )
+    {
+        if( ( xNumTiers < tariffMAX_TIERS ) &&
+            ( sscanf( pcTier, "%lu=%ld", &ulFrom, &lSurcharge ) == 2 ) &&
+            ( ( xNumTiers == 0 ) || ( ulFrom >= xTiers[ xNumTiers - 1 ].ulFrom ) ) )
+        {
+            xTiers[ xNumTiers ].ulFrom = ( uint32_t ) ulFrom;
+            xTiers[ xNumTiers ].lSurcharge = ( int32_t ) lSurcharge;
+            xNumTiers++;
+        }
+        else
+        {
+            xReturn = pdFAIL;
+        }
+    }
+
+    xConfig.xTariff.pxTiers = xTiers;
+    xConfig.xTariff.xNumTiers = xNumTiers;
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvParseInt32( const char * pcArg,
+                                 int32_t * plValue )
+{
+    char * pcEnd;
+    long lValue;
+    BaseType_t xReturn = pdFAIL;
+
+    errno = 0;
+    lValue = strtol( pcArg, &pcEnd, 0 );
+
+    if( ( errno == 0 ) && ( pcEnd != pcArg ) && ( *pcEnd == '\0' ) &&
+        ( lValue >= ( long ) INT32_MIN ) && ( lValue <= ( long ) INT32_MAX ) )
+    {
+        *plValue = ( int32_t ) lValue;
+        xReturn = pdPASS;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCheckCurve( const EnergyCurve_t * pxCurve )
+{
+    int64_t llHighest = ( int64_t ) pxCurve->lOffset + pxCurve->lAmplitude;
+    int64_t llLowest = ( int64_t ) pxCurve->lOffset - pxCurve->lAmplitude;
+    BaseType_t xReturn = pdPASS;
+
+    if( ( pxCurve->lAmplitude < 0 ) || ( pxCurve->lAmplitude > ( int32_t ) UINT16_MAX ) ||
+        ( llHighest > INT32_MAX ) || ( llLowest < INT32_MIN ) )
+    {
+        xReturn = pdFAIL;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvParseForecast( const char * pcArg,
+                                    EnergyForecastParams_t * pxParams )
+{
+    double dFactors[ 3 ];
+    BaseType_t xReturn = pdFAIL;
+    size_t x;
+
+    if( sscanf( pcArg, "%lf,%lf,%lf", &dFactors[ 0 ], &dFactors[ 1 ], &dFactors[ 2 ] ) == 3 )
+    {
+        xReturn = pdPASS;
+
+        for( x = 0; x < 3; x++ )
+        {
+            if( ( dFactors[ x ] < 0.0 ) || ( dFactors[ x ] > 1.0 ) )
+            {
+                xReturn = pdFAIL;
+            }
+        }
+
+        pxParams->usAlpha = forecastQ15( dFactors[ 0 ] );
+        pxParams->usBeta = forecastQ15( dFactors[ 1 ] );
+        pxParams->usGamma = forecastQ15( dFactors[ 2 ] );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvMapProfile( const char * pcPath )
+{
+    int iFile;
+    struct stat xStat;
+    void * pvData = MAP_FAILED;
+
+    iFile = open( pcPath, O_RDONLY );
+
+    if( iFile >= 0 )
+    {
+        if( ( fstat( iFile, &xStat ) == 0 ) && ( xStat.st_size > 0 ) )
+        {
+            pvData = mmap( NULL, ( size_t ) xStat.st_size, PROT_READ, MAP_PRIVATE, iFile, 0 );
+        }
+
+        /* The mapping stays valid once the file is closed. */
+        close( iFile );
+    }
+
+    if( pvData != MAP_FAILED )
+    {
+        xConfig.pucProfile = ( const uint8_t * ) pvData;
+        xConfig.xProfileLength = ( size_t ) xStat.st_size;
+    }
+    else
+    {
+        fprintf( stderr, "Could not map %s\n", pcPath );
+    }
+
+    return ( pvData != MAP_FAILED ) ? pdPASS : pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPrintHistory( eHistoryTier eTier,
+                             TickType_t xSince )
+{
+    static HistoryRecord_t xRecords[ historyHOURLY_RECORDS ];
+    size_t xCount, x;
+
+    xCount = xEnergyHistoryQuery( pxEnergyManagementGetHistory( pxHouseholds[ 0 ] ), eTier, xSince, xRecords, historyHOURLY_RECORDS );
+
+    fprintf( stderr, "%s,tick,battery_min,battery_max,battery_mean,solar_min,solar_max,solar_mean,"
+                     "load_min,load_max,load_mean,grid_min,grid_max,grid_mean\n",
+             ( eTier == eHistoryDaily ) ? "day" : "hour" );
+
+    for( x = 0; x < xCount; x++ )
+    {
+        fprintf( stderr, "%s,%llu", ( eTier == eHistoryDaily ) ? "day" : "hour", ( unsigned long long ) xRecords[ x ].xTime );
+
+        for( size_t xChannel = 0; xChannel < historyNUM_CHANNELS; xChannel++ )
+        {
+            fprintf( stderr, ",%ld,%ld,%ld", ( long ) xRecords[ x ].lMin[ xChannel ],
+                     ( long ) xRecords[ x ].lMax[ xChannel ], ( long ) xRecords[ x ].lMean[ xChannel ] );
+        }
+
+        fprintf( stderr, "\n" );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvPrintLoopStats( void )
+{
+    static const char * const pcTasks[ energyNUM_TASKS ] = { "solar", "battery", "load", "grid", "dispatch" };
+    static const char * const pcTopics[ busNUM_TOPICS ] = { "generation", "grid" };
+    const LoopHistogram_t * pxHistogram;
+    LoopTaskStats_t xStats;
+    LoopHistogram_t xResidency;
+    size_t x;
+
+    fprintf( stderr, "task,cpu_us,wakes,missed,latency_mean_us,latency_p50_us,latency_p99_us,latency_max_us\n" );
+
+    for( x = 0; x < energyNUM_TASKS; x++ )
+    {
+        if( xEnergyManagementGetLoopStats( pxHouseholds[ 0 ], ( EnergyLoopTask_t ) x, &xStats ) != pdFALSE )
+        {
+            pxHistogram = &( xStats.xWakeLatency );
+            fprintf( stderr, "%s,%llu,%lu,%lu,%llu,%lu,%lu,%lu\n", pcTasks[ x ],
+                     ( unsigned long long ) ullLoopStatsToMicroseconds( xStats.ullRunTime ),
+                     ( unsigned long ) xStats.ulWakes,
+                     ( unsigned long ) xStats.ulMissedDeadlines,
+                     ( unsigned long long ) ( ( pxHistogram->ulCount > 0U ) ? ( pxHistogram->ullTotal / pxHistogram->ulCount ) : 0U ),
+                     ( unsigned long ) ulLoopStatsPercentile( pxHistogram, 50 ),
+                     ( unsigned long ) ulLoopStatsPercentile( pxHistogram, 99 ),
+                     ( unsigned long ) pxHistogram->ulMax );
+        }
+    }
+
+    fprintf( stderr, "topic,samples,residency_mean_us,residency_p50_us,residency_p99_us,residency_max_us\n" );
+
+    for( x = 0; x < busNUM_TOPICS; x++ )
+    {
+        vEnergyManagementGetResidency( pxHouseholds[ 0 ], ( EnergyTopic_t ) x, &xResidency );
+        fprintf( stderr, "%s,%lu,%llu,%lu,%lu,%lu\n", pcTopics[ x ],
+                 ( unsigned long ) xResidency.ulCount,
+                 ( unsigned long long ) ( ( xResidency.ulCount > 0U ) ? ( xResidency.ullTotal / xResidency.ulCount ) : 0U ),
+                 ( unsigned long ) ulLoopStatsPercentile( &xResidency, 50 ),
+                 ( unsigned long ) ulLoopStatsPercentile( &xResidency, 99 ),
+                 ( unsigned long ) xResidency.ulMax );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static double prvElapsedSeconds( void )
+{
+    struct timespec xNow;
+
+    clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( double ) ( xNow.tv_sec - xStartTime.tv_sec ) +
+           ( ( double ) ( xNow.tv_nsec - xStartTime.tv_nsec ) / 1e9 );
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationIdleHook( void )
+{
+    /* It will be called on each iteration of the idle task, so with virtual
+     * time this is where the tick count is moved on. */
+    #if ( configPOSIX_VIRTUAL_TIME == 1 )
+    {
+        vPortVirtualTimeIdle();
+    }
+    #endif /* configPOSIX_VIRTUAL_TIME */
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationMallocFailedHook( void )
+{
+    fprintf( stderr, "Malloc failed\n" );
+    abort();
+}
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFileName,
+                    uint32_t ulLine )
+{
+    fprintf( stderr, "ASSERT! Line %lu, file %s\n", ( unsigned long ) ulLine, pcFileName );
+    abort();
+}
+/*-----------------------------------------------------------*/
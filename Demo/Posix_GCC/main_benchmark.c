@@ -0,0 +1,109 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/******************************************************************************
+ * Host build of the kernel microbenchmarks, see KernelBenchmark.h.
+ *
+ * Build and run with:
+ *   make benchmark
+ *   ./output/posix_benchmark > kernel.json
+ *
+ * The results are written to standard output as JSON, and the program exits
+ * once they have all been written.  The figures are for the Posix port, so
+ * a context switch is a switch between host threads, and vary with the load
+ * on the host.  Run with the process pinned to one idle core, with taskset
+ * for example, for figures that can be compared from one run to the next.
+ *
+ * The Makefile always builds the benchmark with configPOSIX_VIRTUAL_TIME set
+ * to 0, so it runs against the wall clock and only uses what every revision of
+ * the Posix port provides.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "SerialLog.h"
+#include "KernelBenchmark.h"
+
+/*
+ * Runs the benchmarks, then ends the process.
+ */
+static void prvBenchmarkTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    vSerialLogInit();
+
+    if( xTaskCreate( prvBenchmarkTask, "Benchmark", kernelbenchSTACK_SIZE, NULL, kernelbenchPRIORITY, NULL ) == pdPASS )
+    {
+        vTaskStartScheduler();
+    }
+
+    /* The scheduler only returns if it could not be started. */
+    fprintf( stderr, "Could not start the kernel benchmark\n" );
+
+    return EXIT_FAILURE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    vKernelBenchmarkRun( "posix" );
+
+    exit( EXIT_SUCCESS );
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationIdleHook( void )
+{
+    /* Nothing to do, the tick is driven by the port's timer. */
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationMallocFailedHook( void )
+{
+    fprintf( stderr, "Malloc failed\n" );
+    abort();
+}
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFileName,
+                    uint32_t ulLine )
+{
+    fprintf( stderr, "ASSERT! Line %lu, file %s\n", ( unsigned long ) ulLine, pcFileName );
+    abort();
+}
+/*-----------------------------------------------------------*/
@@ -40,6 +40,10 @@
 * The timer interrupt uses SIGALRM and care is taken to ensure that
 * the signal handler runs only on the thread for the current task.
 *
+* With configPOSIX_VIRTUAL_TIME set to 1 there is no timer interrupt.
+* The tick count is advanced from the idle task instead, so time only
+* passes while every task is blocked and then passes instantly.
+*
 * Use of part of the standard C library requires care as some
 * functions can take pthread mutexes internally which can result in
 * deadlocks as the FreeRTOS kernel can switch tasks while they're
@@ -76,6 +80,15 @@
 #include "utils/wait_for_event.h"
 /*-----------------------------------------------------------*/
 
+#ifndef configPOSIX_VIRTUAL_TIME
+    #define configPOSIX_VIRTUAL_TIME    0
+#endif
+
+#if ( configPOSIX_VIRTUAL_TIME == 1 ) && ( configUSE_TICKLESS_IDLE != 1 )
+    #error configPOSIX_VIRTUAL_TIME requires configUSE_TICKLESS_IDLE to be set to 1
+#endif
+/*-----------------------------------------------------------*/
+
 #define SIG_RESUME    SIGUSR1
 
 typedef struct THREAD
@@ -106,9 +119,17 @@ static sigset_t xSchedulerOriginalSignalMask;
 static pthread_t hMainThread = ( pthread_t ) NULL;
 static volatile BaseType_t uxCriticalNesting;
 static BaseType_t xSchedulerEnd = pdFALSE;
-static pthread_t hTimerTickThread;
-static bool xTimerTickThreadShouldRun;
+#if ( configPOSIX_VIRTUAL_TIME == 0 )
+    static pthread_t hTimerTickThread;
+    static bool xTimerTickThreadShouldRun;
+#endif
 static uint64_t prvStartTimeNs;
+
+#if ( configPOSIX_VIRTUAL_TIME == 1 )
+    /* Set when the idle task last advanced the tick count through
+     * vPortSuppressTicksAndSleep(). */
+    static BaseType_t xVirtualTimeStepped = pdFALSE;
+#endif
 /*-----------------------------------------------------------*/
 
 static void prvSetupSignalsAndSchedulerPolicy( void );
@@ -277,8 +298,12 @@ void vPortEndScheduler( void )
     Thread_t * pxCurrentThread;
 
     /* Stop the timer tick thread. */
-    xTimerTickThreadShouldRun = false;
-    pthread_join( hTimerTickThread, NULL );
+    #if ( configPOSIX_VIRTUAL_TIME == 0 )
+    {
+        xTimerTickThreadShouldRun = false;
+        pthread_join( hTimerTickThread, NULL );
+    }
+    #endif /* configPOSIX_VIRTUAL_TIME */
 
     /* Signal the scheduler to exit its loop. */
     xSchedulerEnd = pdTRUE;
@@ -379,25 +404,29 @@ static uint64_t prvGetTimeNs( void )
  * to adjust timing according to full demo requirements */
 /* static uint64_t prvTickCount; */
 
-static void * prvTimerTickHandler( void * arg )
-{
-    ( void ) arg;
-
-    prvPortSetCurrentThreadName("Scheduler timer");
+#if ( configPOSIX_VIRTUAL_TIME == 0 )
 
-    while( xTimerTickThreadShouldRun )
+    static void * prvTimerTickHandler( void * arg )
     {
-        /*
-         * signal to the active task to cause tick handling or
-         * preemption (if enabled)
-         */
-        Thread_t * thread = prvGetThreadFromTask( xTaskGetCurrentTaskHandle() );
-        pthread_kill( thread->pthread, SIGALRM );
-        usleep( portTICK_RATE_MICROSECONDS );
+        ( void ) arg;
+
+        prvPortSetCurrentThreadName("Scheduler timer");
+
+        while( xTimerTickThreadShouldRun )
+        {
+            /*
+             * signal to the active task to cause tick handling or
+             * preemption (if enabled)
+             */
+            Thread_t * thread = prvGetThreadFromTask( xTaskGetCurrentTaskHandle() );
+            pthread_kill( thread->pthread, SIGALRM );
+            usleep( portTICK_RATE_MICROSECONDS );
+        }
+
+        return NULL;
     }
 
-    return NULL;
-}
+#endif /* configPOSIX_VIRTUAL_TIME */
 /*-----------------------------------------------------------*/
 
 /*
@@ -406,13 +435,53 @@ static void * prvTimerTickHandler( void * arg )
  */
 void prvSetupTimerInterrupt( void )
 {
-    xTimerTickThreadShouldRun = true;
-    pthread_create( &hTimerTickThread, NULL, prvTimerTickHandler, NULL );
+    /* In virtual time the tick is driven by the idle task, not a timer. */
+    #if ( configPOSIX_VIRTUAL_TIME == 0 )
+    {
+        xTimerTickThreadShouldRun = true;
+        pthread_create( &hTimerTickThread, NULL, prvTimerTickHandler, NULL );
+    }
+    #endif /* configPOSIX_VIRTUAL_TIME */
 
     prvStartTimeNs = prvGetTimeNs();
 }
 /*-----------------------------------------------------------*/
 
+#if ( configPOSIX_VIRTUAL_TIME == 1 )
+
+    void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+    {
+        /* Called by the idle task, with the scheduler suspended, when no task
+         * can run for xExpectedIdleTime ticks.  Nothing can happen in that
+         * time, so rather than sleeping step the tick count straight to the
+         * tick on which the next task unblocks.  vTaskStepTick() leaves that
+         * last tick pending, so it is processed when the idle task resumes the
+         * scheduler, which then switches to the unblocked task. */
+        if( eTaskConfirmSleepModeStatus() != eAbortSleep )
+        {
+            vTaskStepTick( xExpectedIdleTime );
+            xVirtualTimeStepped = pdTRUE;
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+    void vPortVirtualTimeIdle( void )
+    {
+        /* Gaps of less than configEXPECTED_IDLE_TIME_BEFORE_SLEEP ticks never
+         * reach vPortSuppressTicksAndSleep(), so if the previous pass of the
+         * idle task did not advance the tick count do it here, one tick at a
+         * time. */
+        if( xVirtualTimeStepped == pdFALSE )
+        {
+            ( void ) xTaskCatchUpTicks( 1 );
+        }
+
+        xVirtualTimeStepped = pdFALSE;
+    }
+    /*-----------------------------------------------------------*/
+
+#endif /* configPOSIX_VIRTUAL_TIME */
+
 static void vPortSystemTickHandler( int sig )
 {
     Thread_t * pxThreadToSuspend;
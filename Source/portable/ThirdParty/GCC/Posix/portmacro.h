@@ -140,6 +140,18 @@ extern void vPortCancelThread( void * pxTaskToDelete );
  */
 #define portMEMORY_BARRIER()                        __asm volatile ( "" ::: "memory" )
 
+/* Virtual time.  When configPOSIX_VIRTUAL_TIME is 1 there is no wall clock
+ * tick.  Instead, whenever every task is blocked, the tick count is advanced
+ * straight to the next tick on which a task unblocks, so the application runs
+ * as fast as the host allows.  Requires configUSE_TICKLESS_IDLE to be 1, and
+ * the idle hook to call vPortVirtualTimeIdle(). */
+#if defined( configPOSIX_VIRTUAL_TIME ) && ( configPOSIX_VIRTUAL_TIME == 1 )
+    extern void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime );
+    extern void vPortVirtualTimeIdle( void );
+    #define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime )    vPortSuppressTicksAndSleep( xExpectedIdleTime )
+#endif /* configPOSIX_VIRTUAL_TIME */
+/*-----------------------------------------------------------*/
+
 extern uint32_t ulPortGetRunTime( void );
 #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()    /* no-op */
 #define portGET_RUN_TIME_COUNTER_VALUE()            ulPortGetRunTime()
@@ -0,0 +1,196 @@
+#!/usr/bin/env python3
+"""Compare the kernel benchmarks of two revisions of Source/ on the host.
+
+Builds the kernel microbenchmarks (see
+Demo/CORTEX_MPS2_QEMU_IAR_GCC/KernelBenchmark.h) against the Posix port
+twice, once with Source/ as it was at each of two git revisions, and the rest
+of the tree as it is now.  Then runs the two builds in turn, pinned to one
+core, and compares their times for each operation:
+
+    tools/kernel_regression.py origin/main HEAD
+    tools/kernel_regression.py HEAD WORKTREE --runs 30 --cpu 3
+
+WORKTREE stands for Source/ as it is on disk, uncommitted changes included.
+
+Each run reports the fastest batch of every operation.  The runs of the two
+builds are compared with a two sided Mann-Whitney U test, which makes no
+assumption about how the times are distributed.  An operation fails when it
+is slower by more than --threshold percent, comparing medians, and the
+difference is significant at --alpha.  The exit status is 1 if any failed.
+Pin to a core with nothing else running on it for results worth having.
+"""
+
+import argparse
+import io
+import json
+import math
+import os
+import shutil
+import statistics
+import subprocess
+import sys
+import tarfile
+import tempfile
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+POSIX_DIR = os.path.join(ROOT, "Demo", "Posix_GCC")
+WORKTREE = "WORKTREE"
+
+
+def export_source(revision, dest):
+    """Write Source/ as it was at revision under dest."""
+    if revision == WORKTREE:
+        shutil.copytree(os.path.join(ROOT, "Source"), os.path.join(dest, "Source"))
+        return
+    archive = subprocess.run(["git", "-C", ROOT, "archive", "--format=tar", revision, "Source"],
+                             stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    if archive.returncode != 0:
+        sys.exit("cannot export Source/ at %s: %s" % (revision, archive.stderr.decode().strip()))
+    with tarfile.open(fileobj=io.BytesIO(archive.stdout)) as tar:
+        tar.extractall(dest)
+
+
+def build(revision, dest, jobs):
+    """Build the benchmark with Source/ at revision, returning its path."""
+    export_source(revision, dest)
+    output = os.path.join(dest, "output")
+    result = subprocess.run(["make", "-C", POSIX_DIR, "-j%d" % jobs, "benchmark",
+                             "KERNEL_DIR=%s" % os.path.join(dest, "Source"),
+                             "OUTPUT_DIR=%s" % output, "VIRTUAL_TIME=0"],
+                            stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    if result.returncode != 0:
+        sys.exit("build of %s failed:\n%s" % (revision, result.stdout))
+    return os.path.join(output, "posix_benchmark")
+
+
+def run(binary, cpu):
+    """Run a benchmark once and return {(name, parameter): ns}."""
+    def pin():
+        if cpu is not None:
+            os.sched_setaffinity(0, {cpu})
+
+    result = subprocess.run([binary], stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                            text=True, preexec_fn=pin)
+    if result.returncode != 0:
+        sys.exit("%s failed: %s" % (binary, result.stderr.strip()))
+    times = {}
+    for r in json.loads(result.stdout)["results"]:
+        parameter = "".join("%s=%s" % (k, v) for k, v in r.items()
+                            if k not in ("name", "ops", "min_ns", "mean_ns", "max_ns"))
+        times[(r["name"], parameter)] = r["min_ns"]
+    return times
+
+
+def mann_whitney(a, b):
+    """Two sided p value of the Mann-Whitney U test of a against b, by the
+    normal approximation with a correction for ties."""
+    values = sorted((v, i) for i, v in enumerate(a + b))
+    ranks = [0.0] * len(values)
+    ties = 0.0
+    i = 0
+    while i < len(values):
+        j = i
+        while j + 1 < len(values) and values[j + 1][0] == values[i][0]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[values[k][1]] = (i + j) / 2.0 + 1.0
+        ties += (j - i + 1) ** 3 - (j - i + 1)
+        i = j + 1
+
+    n1, n2 = len(a), len(b)
+    n = n1 + n2
+    u = sum(ranks[:n1]) - n1 * (n1 + 1) / 2.0
+    variance = n1 * n2 / 12.0 * ((n + 1) - ties / (n * (n - 1)))
+    if variance <= 0:
+        return 1.0
+    # Continuity correction of a half towards the mean.
+    z = (abs(u - n1 * n2 / 2.0) - 0.5) / math.sqrt(variance)
+    return min(1.0, math.erfc(max(z, 0.0) / math.sqrt(2.0)))
+
+
+def compare(base, new, threshold, alpha):
+    """Return a row for each operation and whether any failed."""
+    rows = []
+    failed = False
+    for key in sorted(set(base) & set(new)):
+        before = statistics.median(base[key])
+        after = statistics.median(new[key])
+        change = 100.0 * (after - before) / before if before else 0.0
+        p = mann_whitney(base[key], new[key])
+        if p < alpha and change > threshold:
+            verdict = "FAIL"
+            failed = True
+        elif p < alpha and change < -threshold:
+            verdict = "faster"
+        else:
+            verdict = "ok"
+        rows.append([key[0], key[1], "%.1f" % before, "%.1f" % after,
+                     "%+.1f%%" % change, "%.4f" % p, verdict])
+    for key in sorted(set(base) ^ set(new)):
+        rows.append([key[0], key[1], "", "", "", "", "only in one"])
+    return rows, failed
+
+
+def print_table(rows):
+    header = ["operation", "parameter", "base_ns", "new_ns", "change", "p", "verdict"]
+    rows = [header] + rows
+    widths = [max(len(row[i]) for row in rows) for i in range(len(header))]
+    for row in rows:
+        print("  ".join(cell.ljust(widths[i]) if i < 2 else cell.rjust(widths[i])
+                        for i, cell in enumerate(row)).rstrip())
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("base", help="revision to compare against")
+    parser.add_argument("new", nargs="?", default=WORKTREE,
+                        help="revision to test (default: %(default)s)")
+    parser.add_argument("--runs", type=int, default=15,
+                        help="runs of each build (default: %(default)s)")
+    parser.add_argument("--cpu", type=int, default=os.cpu_count() - 1,
+                        help="core to pin the runs to, -1 for none (default: %(default)s)")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="percent slower that fails (default: %(default)s)")
+    parser.add_argument("--alpha", type=float, default=0.01,
+                        help="significance level (default: %(default)s)")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count(),
+                        help="make jobs (default: %(default)s)")
+    parser.add_argument("--keep", action="store_true",
+                        help="keep the builds, and print where they are")
+    args = parser.parse_args()
+
+    if args.runs < 3:
+        parser.error("--runs must be at least 3")
+    cpu = args.cpu if args.cpu >= 0 else None
+
+    work = tempfile.mkdtemp(prefix="kernel_regression_")
+    try:
+        binaries = [build(revision, os.path.join(work, name), args.jobs)
+                    for revision, name in ((args.base, "base"), (args.new, "new"))]
+
+        # Alternate the builds, so a change in the host's load or clock
+        # speed part way through affects both alike.
+        base = {}
+        new = {}
+        for i in range(args.runs):
+            for binary, results in zip(binaries, (base, new)):
+                for key, ns in run(binary, cpu).items():
+                    results.setdefault(key, []).append(ns)
+            print("run %d of %d" % (i + 1, args.runs), file=sys.stderr)
+    finally:
+        if args.keep:
+            print("builds kept in %s" % work, file=sys.stderr)
+        else:
+            shutil.rmtree(work, ignore_errors=True)
+
+    rows, failed = compare(base, new, args.threshold, args.alpha)
+    print("%s -> %s, %d runs each, fail if over %.1f%% slower at p < %g" %
+          (args.base, args.new, args.runs, args.threshold, args.alpha))
+    print_table(rows)
+    print("FAIL" if failed else "PASS")
+    if failed:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
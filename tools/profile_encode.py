@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""Compress a recorded solar and load profile for replay by the energy tasks.
+
+Reads a CSV file with a header row and one row per measurement, and writes the
+profile format described in Demo/CORTEX_MPS2_QEMU_IAR_GCC/EnergyProfile.h.
+The energy tasks take one sample every 12 simulated minutes, so measurements
+taken at a different interval are linearly interpolated to that rate.
+
+    tools/profile_encode.py measured.csv --interval 15 -o profile.bin
+
+profile.bin can be replayed by the host build with -r profile.bin.  To link a
+profile into the MPS2 image instead, build with
+
+    make PROFILE=measured.csv PROFILE_INTERVAL=15
+
+which runs this script with --c-source.  The CSV written by
+tools/telemetry_decode.py can be used directly, with the default --interval.
+"""
+
+import argparse
+import csv
+import math
+import struct
+import sys
+
+SAMPLE_MINUTES = 12
+VERSION = 1
+
+
+def resample(values, interval):
+    """Linearly interpolate values taken every interval minutes to
+    SAMPLE_MINUTES."""
+    if interval == SAMPLE_MINUTES or len(values) < 2:
+        return list(values)
+    out = []
+    t = 0.0
+    end = (len(values) - 1) * interval
+    while t <= end:
+        i = int(t // interval)
+        frac = (t - i * interval) / interval
+        nxt = values[min(i + 1, len(values) - 1)]
+        out.append(values[i] + (nxt - values[i]) * frac)
+        t += SAMPLE_MINUTES
+    return out
+
+
+def varint(value):
+    zigzag = (value << 1) ^ (value >> 31)
+    zigzag &= 0xFFFFFFFF
+    out = bytearray()
+    while True:
+        byte = zigzag & 0x7F
+        zigzag >>= 7
+        if zigzag:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return out
+
+
+def encode(solar, load):
+    data = bytearray(b"EPRF")
+    data += struct.pack("<BBHI", VERSION, 0, SAMPLE_MINUTES, len(solar))
+    prev_solar = prev_load = 0
+    for s, l in zip(solar, load):
+        data += varint(s - prev_solar)
+        data += varint(l - prev_load)
+        prev_solar, prev_load = s, l
+    return bytes(data)
+
+
+def c_source(data, source):
+    lines = ["/* Generated by tools/profile_encode.py from %s, do not edit. */" % source,
+             "",
+             "#include <stddef.h>",
+             "#include <stdint.h>",
+             "",
+             "const uint8_t ucEnergyProfile[] =",
+             "{"]
+    for i in range(0, len(data), 16):
+        lines.append("    " + " ".join("0x%02x," % b for b in data[i:i + 16]))
+    lines += ["};",
+              "",
+              "const size_t xEnergyProfileLength = sizeof( ucEnergyProfile );",
+              ""]
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("csv", help="measurements, one row per sample")
+    parser.add_argument("--solar-column", default="solar_w",
+                        help="column holding solar power in W (default: %(default)s)")
+    parser.add_argument("--load-column", default="load_w",
+                        help="column holding load in W (default: %(default)s)")
+    parser.add_argument("--interval", type=float, default=SAMPLE_MINUTES,
+                        help="minutes between rows (default: %(default)s)")
+    parser.add_argument("-o", "--output", help="write the binary profile here")
+    parser.add_argument("--c-source", help="write the profile as a C array here")
+    args = parser.parse_args()
+
+    if not args.output and not args.c_source:
+        parser.error("give -o and/or --c-source")
+
+    solar = []
+    load = []
+    with open(args.csv, newline="") as f:
+        reader = csv.DictReader(f)
+        for column in (args.solar_column, args.load_column):
+            if column not in (reader.fieldnames or []):
+                sys.exit("%s has no column %s" % (args.csv, column))
+        for row in reader:
+            try:
+                s = float(row[args.solar_column])
+                l = float(row[args.load_column])
+            except (TypeError, ValueError):
+                # A short row gives None, a bad cell a string float() refuses.
+                s = l = math.nan
+            if not (math.isfinite(s) and math.isfinite(l)):
+                sys.exit("%s line %d: %s and %s must be numbers" %
+                         (args.csv, reader.line_num, args.solar_column,
+                          args.load_column))
+            solar.append(max(0.0, s))
+            load.append(max(0.0, l))
+    if not solar:
+        sys.exit("%s has no samples" % args.csv)
+
+    solar = [int(round(v)) for v in resample(solar, args.interval)]
+    load = [int(round(v)) for v in resample(load, args.interval)]
+    data = encode(solar, load)
+
+    if args.output:
+        with open(args.output, "wb") as f:
+            f.write(data)
+    if args.c_source:
+        with open(args.c_source, "w") as f:
+            f.write(c_source(data, args.csv))
+
+    print("%d samples, %d days, %d bytes (%.2f bytes per sample)" %
+          (len(solar), len(solar) * SAMPLE_MINUTES // (24 * 60), len(data),
+           len(data) / len(solar)), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
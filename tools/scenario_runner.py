@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+"""Run many household simulations in parallel and summarise them.
+
+Each scenario is one run of the Posix host build of the energy application
+(Demo/Posix_GCC), in its own process, with as many running at once as there
+are cores.  Build it first:
+
+    make -C Demo/Posix_GCC
+
+Scenarios are read from a CSV file with a header row.  Recognised columns,
+any of which can be left out or empty to use the value in EnergyConfig.h:
+
+    name             label for the summary, the row number if omitted
+    days             simulated days to run for
+    capacity         battery capacity in W.h
+    initial          energy in the battery at start up, in W.h
+    amplitude        peak solar power in W
+    base_price       mean price of energy in miliCents/W.h
+    price_amplitude  swing of the price either side of the mean
+    export_price     flat price paid for energy sold, in miliCents/W.h
+    tou              time of use prices as HH:MM=import/export,...
+    tiers            import tier surcharges as from_Wh=surcharge,...
+    daily_charge     fixed charge for each day, in miliCents
+    appliances       devices as name:W:prio:on, separated by ';'
+    profile          recorded profile to replay, from tools/profile_encode.py
+    policy           battery dispatch, greedy or optimised
+    max_power        most power the battery trades with the grid, in W
+    battery_model    ideal or li-ion, see BatteryModel.h
+    forecast         forecast smoothing as alpha,beta,gamma, see EnergyForecast.h
+    period           ms between samples of solar and load, 200 is 12 minutes
+    households       households in the community, summed in the summary
+    solar_households how many of them have solar panels
+    workers          step the households on this many pooled workers
+
+then run:
+
+    tools/scenario_runner.py scenarios.csv
+
+See tools/scenarios_example.csv, and tools/dispatch_benchmark.csv which
+compares the greedy and optimised battery dispatch over a simulated month.
+"""
+
+import argparse
+import concurrent.futures
+import csv
+import os
+import subprocess
+import sys
+
+DEFAULT_BINARY = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                              "..", "Demo", "Posix_GCC", "output", "posix_energy")
+
+# CSV column and the option of posix_energy it is passed as.
+OPTIONS = [
+    ("days", "-d"),
+    ("capacity", "-c"),
+    ("initial", "-i"),
+    ("amplitude", "-a"),
+    ("base_price", "-b"),
+    ("price_amplitude", "-p"),
+    ("export_price", "-e"),
+    ("tou", "-u"),
+    ("tiers", "-t"),
+    ("daily_charge", "-f"),
+    ("profile", "-r"),
+    ("policy", "-o"),
+    ("max_power", "-w"),
+    ("battery_model", "-m"),
+    ("forecast", "-F"),
+    ("period", "-T"),
+    ("households", "-n"),
+    ("solar_households", "-s"),
+    ("workers", "-P"),
+]
+
+COLUMNS = ["name", "bill", "self_consumption", "imported_wh", "exported_wh",
+           "generated_wh", "consumed_wh", "battery_wh", "seconds"]
+
+
+def command(binary, row):
+    """Build the command line that runs one scenario."""
+    cmd = [binary]
+    for column, option in OPTIONS:
+        value = (row.get(column) or "").strip()
+        if value:
+            cmd += [option, value]
+    for device in (row.get("appliances") or "").split(";"):
+        if device.strip():
+            cmd += ["-l", device.strip()]
+    return cmd
+
+
+def run(binary, name, row):
+    """Run one scenario and return its summary as a dict."""
+    result = subprocess.run(command(binary, row), stdout=subprocess.DEVNULL,
+                            stderr=subprocess.PIPE, text=True)
+    lines = result.stderr.strip().splitlines()
+    if result.returncode != 0 or not lines:
+        return {"name": name, "error": lines[-1] if lines else
+                "exit status %d" % result.returncode}
+
+    totals = dict(field.split("=", 1) for field in lines[-1].split())
+    generated = int(totals["generated"])
+    imported = int(totals["imported"])
+    exported = int(totals["exported"])
+    solar_exported = int(totals["solar_exported"])
+    return {
+        "name": name,
+        # Micro cents, positive is profit.
+        "bill": int(totals["bill_ucents"]),
+        # Share of the solar energy that was not sold as it was made.
+        # Stored energy the dispatch plan sells is not counted against it.
+        "self_consumption": (generated - solar_exported) / generated
+                            if generated else 0.0,
+        "imported_wh": imported,
+        "exported_wh": exported,
+        "generated_wh": generated,
+        "consumed_wh": int(totals["consumed"]),
+        "battery_wh": int(totals["battery"]),
+        "seconds": float(totals["seconds"]),
+    }
+
+
+def print_table(results):
+    rows = [COLUMNS]
+    for r in results:
+        if "error" in r:
+            rows.append([r["name"], "error: " + r["error"]])
+            continue
+        rows.append([r["name"], "%.2f" % (r["bill"] / 1e8),
+                     "%.1f%%" % (100.0 * r["self_consumption"])] +
+                    [str(r[c]) for c in COLUMNS[3:-1]] + ["%.3f" % r["seconds"]])
+    widths = [max(len(row[i]) for row in rows if i < len(row))
+              for i in range(len(COLUMNS))]
+    for row in rows:
+        print("  ".join(cell.rjust(widths[i]) if i else cell.ljust(widths[i])
+                        for i, cell in enumerate(row)).rstrip())
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("scenarios", help="CSV file of scenarios")
+    parser.add_argument("--binary", default=DEFAULT_BINARY,
+                        help="host build to run (default: %(default)s)")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count(),
+                        help="simulations to run at once (default: one per core)")
+    parser.add_argument("--csv", action="store_true",
+                        help="print the summary as CSV, bill in micro cents")
+    args = parser.parse_args()
+
+    if not os.access(args.binary, os.X_OK):
+        sys.exit("%s not found, build Demo/Posix_GCC first" % args.binary)
+
+    with open(args.scenarios, newline="") as f:
+        scenarios = [((row.get("name") or "").strip() or str(i), row)
+                     for i, row in enumerate(csv.DictReader(f), 1)]
+
+    # The work is done by the child processes, threads only wait for them.
+    with concurrent.futures.ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        results = list(pool.map(lambda s: run(args.binary, *s), scenarios))
+
+    if args.csv:
+        writer = csv.writer(sys.stdout)
+        writer.writerow(COLUMNS + ["error"])
+        for r in results:
+            writer.writerow([r.get(c, "") for c in COLUMNS] + [r.get("error", "")])
+    else:
+        print_table(results)
+
+    if any("error" in r for r in results):
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
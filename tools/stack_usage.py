@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+"""Recommend a stack size for each task of the energy application.
+
+Combines two measures of the stack a task needs:
+
+- the deepest chain of calls from the task's function, adding up the frame
+  of each function as the compiler reports it.  Build with
+
+      make STACK_USAGE=1
+
+  for the compiler to write a .ci call graph next to each object, for the
+  MPS2 in Demo/CORTEX_MPS2_QEMU_IAR_GCC/build/gcc/output or for the host in
+  Demo/Posix_GCC/output;
+
+- the most each task was seen to use on the MPS2, from the lines
+  Demo/CORTEX_MPS2_QEMU_IAR_GCC/StackProfile.c prints with STACK_PROFILE set
+  in main.c, in a capture of the serial port.
+
+then run:
+
+    tools/stack_usage.py Demo/CORTEX_MPS2_QEMU_IAR_GCC/build/gcc/output \\
+        --measured capture.bin
+
+Each task is given the larger of the two, plus the context the kernel saves
+on its stack when it is switched out, plus a margin, and the result is
+printed as the #define that sets its size.  The call graph cannot see
+through calls made through pointers, to library functions built without
+STACK_USAGE, or recursion; functions that make them are listed.  --call adds the calls made
+through pointers, after which the caller is no longer listed:
+
+    --call prvPeriodAdd=prvEndHour --call prvPeriodAdd=prvEndDay
+
+For a host build use
+--word-bytes 8 --context-bytes 0: the figures show what the code needs
+rather than what the Posix port gives it.
+"""
+
+import argparse
+import glob
+import math
+import os
+import re
+import sys
+
+# Task name, the function that implements it and the macro that sets its
+# stack size, in words.
+TASKS = [
+    ("SolarGen", "vTaskSolarPowerGeneration", "energySOLAR_STACK_SIZE"),
+    ("BatteryMgmt", "vTaskBatteryManagement", "energyBATTERY_STACK_SIZE"),
+    ("LoadMgmt", "vTaskLoadManagement", "energyLOAD_STACK_SIZE"),
+    ("GridInteract", "vTaskGridInteraction", "energyGRID_STACK_SIZE"),
+    ("Dispatch", "vTaskBatteryDispatch", "energyDISPATCH_STACK_SIZE"),
+    ("PoolWorker", "prvWorkerTask", "poolWORKER_STACK_SIZE"),
+    ("Community", "prvCommunityTask", "communityTASK_STACK_SIZE"),
+]
+
+# configMAX_TASK_NAME_LEN in FreeRTOSConfig.h, including the terminator.
+MAX_TASK_NAME_LEN = 12
+
+NODE = re.compile(r'node: \{ title: "([^"]+)" label: "([^"]*)"')
+EDGE = re.compile(r'edge: \{ sourcename: "([^"]+)" targetname: "([^"]+)"')
+FRAME = re.compile(r"\\n(\d+) bytes \(([a-z,]+)\)(?:\\n(\d+) dynamic objects)?")
+MEASURED = re.compile(rb"stack,([^,\r\n]+),(\d+),(\d+)")
+
+INDIRECT = "__indirect_call"
+
+
+class CallGraph:
+    def __init__(self):
+        self.frames = {}   # title: bytes
+        self.dynamic = set()
+        self.calls = {}    # title: set of titles
+
+    def load(self, path):
+        with open(path) as f:
+            for line in f:
+                node = NODE.match(line)
+                if node:
+                    frame = FRAME.search(node.group(2))
+                    if frame:
+                        self.frames[node.group(1)] = int(frame.group(1))
+                        if frame.group(2) != "static" or int(frame.group(3) or 0):
+                            self.dynamic.add(node.group(1))
+                    continue
+                edge = EDGE.match(line)
+                if edge:
+                    self.calls.setdefault(edge.group(1), set()).add(edge.group(2))
+
+    def find(self, name):
+        """Title of the function called name, static ones being file:name."""
+        if name in self.frames:
+            return name
+        matches = [t for t in self.frames if t.endswith(":" + name)]
+        return matches[0] if len(matches) == 1 else None
+
+    def deepest(self, root):
+        """Return the bytes of the deepest chain of calls from root, and the
+        functions on any chain whose depth is not known for certain."""
+        unknown = {"indirect": set(), "external": set(), "recursive": set(),
+                   "dynamic": set()}
+        memo = {}
+
+        def visit(title, path):
+            if title in memo:
+                return memo[title]
+            if title in path:
+                unknown["recursive"].add(title)
+                return 0
+            if title not in self.frames:
+                unknown["external"].add(title)
+                return 0
+            if title in self.dynamic:
+                unknown["dynamic"].add(title)
+            path.add(title)
+            deepest = 0
+            for callee in self.calls.get(title, ()):
+                if callee == INDIRECT:
+                    unknown["indirect"].add(title)
+                    continue
+                deepest = max(deepest, visit(callee, path))
+            path.discard(title)
+            memo[title] = self.frames[title] + deepest
+            return memo[title]
+
+        return visit(root, set()), unknown
+
+
+def measured(paths):
+    """Return {task name: (stack words, most words used)} from captures."""
+    result = {}
+    for path in paths:
+        with open(path, "rb") as f:
+            for match in MEASURED.finditer(f.read()):
+                name = match.group(1).decode("ascii", "replace")
+                size, used = int(match.group(2)), int(match.group(3))
+                if name not in result or used > result[name][1]:
+                    result[name] = (size, used)
+    return result
+
+
+def short(title):
+    return title.rsplit(":", 1)[-1]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("output", help="build directory holding the .ci files")
+    parser.add_argument("--measured", action="append", default=[],
+                        help="capture with StackProfile.c lines, may be repeated")
+    parser.add_argument("--call", action="append", default=[], metavar="CALLER=CALLEE",
+                        help="add a call the compiler cannot see, may be repeated")
+    parser.add_argument("--word-bytes", type=int, default=4,
+                        help="bytes in a stack word (default: %(default)s)")
+    parser.add_argument("--context-bytes", type=int, default=64,
+                        help="bytes the kernel saves on a task's stack when it is "
+                             "switched out, 16 words on the Cortex-M3 (default: %(default)s)")
+    parser.add_argument("--margin", type=float, default=25.0,
+                        help="percent added to the larger figure (default: %(default)s)")
+    args = parser.parse_args()
+
+    graph = CallGraph()
+    files = glob.glob(os.path.join(args.output, "*.ci"))
+    for path in files:
+        graph.load(path)
+    if not files:
+        sys.exit("no .ci files in %s, build with make STACK_USAGE=1" % args.output)
+
+    for call in args.call:
+        caller, _, callee = call.partition("=")
+        caller_title, callee_title = graph.find(caller), graph.find(callee)
+        if caller_title is None or callee_title is None:
+            sys.exit("--call %s: no function %s" % (call, caller if caller_title is None else callee))
+        graph.calls.setdefault(caller_title, set()).add(callee_title)
+        graph.calls[caller_title].discard(INDIRECT)
+
+    seen = measured(args.measured)
+
+    rows = [["task", "static_bytes", "measured_words", "size_words", "recommended_words", "notes"]]
+    defines = []
+    for name, function, macro in TASKS:
+        root = graph.find(function)
+        if root is None:
+            continue
+        depth, unknown = graph.deepest(root)
+        static_words = math.ceil((depth + args.context_bytes) / args.word_bytes)
+        size, used = seen.get(name[:MAX_TASK_NAME_LEN - 1], (None, None))
+        need = max(static_words, used or 0)
+        # Round up to a multiple of 8 words, keeping the stack aligned.
+        recommended = 8 * math.ceil(need * (1.0 + args.margin / 100.0) / 8)
+        notes = ["%s: %s" % (kind, " ".join(sorted(short(t) for t in titles)))
+                 for kind, titles in sorted(unknown.items()) if titles]
+        rows.append([name, str(depth), "" if used is None else str(used),
+                     "" if size is None else str(size), str(recommended), "; ".join(notes)])
+        defines.append("#define %-28s( %d )" % (macro, recommended))
+
+    widths = [max(len(row[i]) for row in rows) for i in range(len(rows[0]) - 1)]
+    for row in rows:
+        print("  ".join(cell.ljust(widths[i]) if i == 0 else cell.rjust(widths[i])
+                        for i, cell in enumerate(row[:-1])) + ("  " + row[-1] if row[-1] else ""))
+    print()
+    print("\n".join(defines))
+
+
+if __name__ == "__main__":
+    main()
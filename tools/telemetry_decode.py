@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""Convert a capture of the energy application's serial output to CSV.
+
+The firmware emits binary telemetry frames (see
+Demo/CORTEX_MPS2_QEMU_IAR_GCC/Telemetry.h) interleaved with ordinary text.
+Capture the serial port to a file, for example:
+
+    qemu-system-arm -machine mps2-an385 -cpu cortex-m3 \
+        -kernel ./output/RTOSDemo.out -monitor none -nographic \
+        -serial file:capture.bin
+
+then run:
+
+    tools/telemetry_decode.py capture.bin > samples.csv
+
+Bytes that are not part of a valid frame are skipped.  Use --text to echo
+them to stderr instead.
+"""
+
+import argparse
+import struct
+import sys
+
+SYNC = b"\xa5\x5a"
+HEADER_SIZE = 4
+CHECKSUM_SIZE = 2
+
+# Payload layout for each known version: struct format and CSV columns.
+LAYOUTS = {
+    1: ("<IiiII", ["tick", "battery_wh", "bill_millicents", "solar_w", "load_w"]),
+    2: ("<IiqII", ["tick", "battery_wh", "bill_millicents", "solar_w", "load_w"]),
+}
+
+
+def fletcher16(data):
+    sum1 = 0
+    sum2 = 0
+    for byte in data:
+        sum1 = (sum1 + byte) % 255
+        sum2 = (sum2 + sum1) % 255
+    return sum1, sum2
+
+
+def frames(data, text_out=None):
+    """Yield (version, fields) for every valid frame in data."""
+    pos = 0
+    while True:
+        start = data.find(SYNC, pos)
+        if start < 0:
+            if text_out is not None:
+                text_out.write(data[pos:].decode("ascii", "replace"))
+            return
+        if text_out is not None:
+            text_out.write(data[pos:start].decode("ascii", "replace"))
+        if start + HEADER_SIZE > len(data):
+            return
+        version = data[start + 2]
+        length = data[start + 3]
+        end = start + HEADER_SIZE + length + CHECKSUM_SIZE
+        layout = LAYOUTS.get(version)
+        if layout is None or struct.calcsize(layout[0]) != length or end > len(data):
+            # Not a frame we understand - resynchronise one byte further on.
+            pos = start + 1
+            continue
+        body = data[start + 2:start + HEADER_SIZE + length]
+        if fletcher16(body) != (data[end - 2], data[end - 1]):
+            pos = start + 1
+            continue
+        yield version, struct.unpack_from(layout[0], data, start + HEADER_SIZE)
+        pos = end
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", nargs="?", help="capture file, stdin if omitted")
+    parser.add_argument("--text", action="store_true",
+                        help="copy non-frame bytes to stderr")
+    args = parser.parse_args()
+
+    if args.capture:
+        with open(args.capture, "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    header_version = None
+    for version, fields in frames(data, sys.stderr if args.text else None):
+        if version != header_version:
+            print(",".join(LAYOUTS[version][1]))
+            header_version = version
+        print(",".join(str(v) for v in fields))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,238 @@
+#!/usr/bin/env python3
+"""Convert a kernel trace captured from the serial output to Chrome trace JSON.
+
+The trace recorder (see Demo/CORTEX_MPS2_QEMU_IAR_GCC/TraceRecorder.h) sends
+the events it records in frames with the same framing as the telemetry, so
+both can be in the one capture.  Set TRACE_RECORDER_MODE in main.c, capture
+the serial port to a file as for tools/telemetry_decode.py, or run the host
+build with -R:
+
+    Demo/Posix_GCC/output/posix_energy -d 2 -R stream > capture.bin
+
+then run:
+
+    tools/trace_decode.py capture.bin > trace.json
+
+and open trace.json in https://ui.perfetto.dev or chrome://tracing.  Each
+task has a track showing when it ran, when it was made ready and what it did
+with queues.  Queue operations from interrupts are on a track of their own.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+SYNC = b"\xa5\x5a"
+HEADER_SIZE = 4
+CHECKSUM_SIZE = 2
+
+VERSION_HEADER = 0x20
+VERSION_TASK = 0x21
+VERSION_EVENTS = 0x22
+
+HEADER = struct.Struct("<IIIB3x")
+TASK = struct.Struct("<HBx12s")
+EVENT = struct.Struct("<IBBH")
+
+# Event kinds, traceEVENT_... in TraceHooks.h.
+SWITCH_IN = 1
+READY = 2
+TASK_CREATE = 3
+DELAY = 4
+QUEUE_CREATE = 5
+QUEUE_SEND = 6
+QUEUE_SEND_FAILED = 7
+QUEUE_RECEIVE = 8
+QUEUE_RECEIVE_FAILED = 9
+QUEUE_BLOCK_SEND = 10
+QUEUE_BLOCK_RECEIVE = 11
+QUEUE_SEND_FROM_ISR = 12
+QUEUE_RECEIVE_FROM_ISR = 13
+
+# Events on a queue, drawn on the track of the running task, or on the ISR
+# track for those from an interrupt.
+QUEUE_EVENTS = {
+    QUEUE_CREATE: "create",
+    QUEUE_SEND: "send",
+    QUEUE_SEND_FAILED: "send failed",
+    QUEUE_RECEIVE: "receive",
+    QUEUE_RECEIVE_FAILED: "receive failed",
+    QUEUE_BLOCK_SEND: "block on send",
+    QUEUE_BLOCK_RECEIVE: "block on receive",
+    QUEUE_SEND_FROM_ISR: "send from ISR",
+    QUEUE_RECEIVE_FROM_ISR: "receive from ISR",
+}
+ISR_EVENTS = (QUEUE_SEND_FROM_ISR, QUEUE_RECEIVE_FROM_ISR)
+
+# queueQUEUE_TYPE_... in queue.h.
+QUEUE_TYPES = {
+    0: "queue",
+    1: "mutex",
+    2: "counting semaphore",
+    3: "binary semaphore",
+    4: "recursive mutex",
+    5: "set",
+}
+
+PID = 1
+ISR_TID = 0
+
+
+def fletcher16(data):
+    sum1 = 0
+    sum2 = 0
+    for byte in data:
+        sum1 = (sum1 + byte) % 255
+        sum2 = (sum2 + sum1) % 255
+    return sum1, sum2
+
+
+def valid_length(version, length):
+    if version in (VERSION_HEADER, VERSION_TASK):
+        return length == HEADER.size
+    if version == VERSION_EVENTS:
+        return length > 0 and length % EVENT.size == 0
+    return False
+
+
+def frames(data):
+    """Yield (version, payload) for every valid trace frame in data."""
+    pos = 0
+    while True:
+        start = data.find(SYNC, pos)
+        if start < 0 or start + HEADER_SIZE > len(data):
+            return
+        version = data[start + 2]
+        length = data[start + 3]
+        end = start + HEADER_SIZE + length + CHECKSUM_SIZE
+        if not valid_length(version, length) or end > len(data):
+            # Telemetry, text, or not a frame - resynchronise one byte on.
+            pos = start + 1
+            continue
+        body = data[start + 2:start + HEADER_SIZE + length]
+        if fletcher16(body) != (data[end - 2], data[end - 1]):
+            pos = start + 1
+            continue
+        yield version, data[start + HEADER_SIZE:start + HEADER_SIZE + length]
+        pos = end
+
+
+def decode(data):
+    """Return the header fields, task names and events of a capture.  Event
+    times are unwrapped from 32 bits."""
+    header = None
+    tasks = {}
+    events = []
+    last = None
+    time = 0
+    for version, payload in frames(data):
+        if version == VERSION_HEADER:
+            hz, recorded, dropped, mode = HEADER.unpack(payload)
+            header = {"hz": hz, "recorded": recorded, "dropped": dropped, "mode": mode}
+        elif version == VERSION_TASK:
+            number, priority, name = TASK.unpack(payload)
+            tasks[number] = (name.split(b"\0", 1)[0].decode("ascii", "replace"), priority)
+        else:
+            for raw, kind, value, obj in EVENT.iter_unpack(payload):
+                if last is not None:
+                    step = (raw - last) & 0xFFFFFFFF
+                    # An event can be stamped a little before the one ahead
+                    # of it in the ring, when its hook interrupted the other
+                    # between claiming a slot and reading the clock.  Only a
+                    # step forward of over half the range is taken as one
+                    # back.
+                    time += step if step < 0x80000000 else step - 0x100000000
+                last = raw
+                events.append((time, kind, value, obj))
+    # Sorting is stable, so events stamped alike keep the order recorded.
+    events.sort(key=lambda e: e[0])
+    return header, tasks, events
+
+
+def chrome_trace(header, tasks, events):
+    hz = header["hz"] if header and header["hz"] else 1000000
+    origin = events[0][0] if events else 0
+    out = [{"name": "process_name", "ph": "M", "pid": PID,
+            "args": {"name": "FreeRTOS"}},
+           {"name": "thread_name", "ph": "M", "pid": PID, "tid": ISR_TID,
+            "args": {"name": "ISR"}}]
+
+    def us(time):
+        return (time - origin) * 1e6 / hz
+
+    def task_name(number):
+        return tasks[number][0] if number in tasks else "task %d" % number
+
+    seen = set()
+    running = None
+    since = 0
+    for time, kind, value, obj in events:
+        if kind in (SWITCH_IN, READY, TASK_CREATE, DELAY):
+            seen.add(obj)
+        if kind == SWITCH_IN:
+            if running is not None:
+                out.append({"name": task_name(running), "ph": "X", "pid": PID,
+                            "tid": running, "ts": us(since), "dur": us(time) - us(since),
+                            "args": {"priority": tasks.get(running, ("", None))[1]}})
+            running = obj
+            since = time
+        elif kind == READY:
+            out.append({"name": "ready", "ph": "i", "s": "t", "pid": PID,
+                        "tid": obj, "ts": us(time)})
+        elif kind == TASK_CREATE:
+            out.append({"name": "create", "ph": "i", "s": "t", "pid": PID,
+                        "tid": obj, "ts": us(time), "args": {"priority": value}})
+        elif kind == DELAY:
+            out.append({"name": "delay", "ph": "i", "s": "t", "pid": PID,
+                        "tid": obj, "ts": us(time)})
+        elif kind in QUEUE_EVENTS:
+            if kind == QUEUE_CREATE:
+                args = {"queue": obj, "type": QUEUE_TYPES.get(value, value)}
+            else:
+                args = {"queue": obj, "waiting": value}
+            tid = ISR_TID if kind in ISR_EVENTS or running is None else running
+            out.append({"name": "%s q%d" % (QUEUE_EVENTS[kind], obj), "ph": "i",
+                        "s": "t", "pid": PID, "tid": tid, "ts": us(time),
+                        "args": args})
+    if running is not None and events:
+        out.append({"name": task_name(running), "ph": "X", "pid": PID,
+                    "tid": running, "ts": us(since), "dur": us(events[-1][0]) - us(since)})
+
+    for number in sorted(seen | set(tasks)):
+        out.append({"name": "thread_name", "ph": "M", "pid": PID, "tid": number,
+                    "args": {"name": task_name(number)}})
+        out.append({"name": "thread_sort_index", "ph": "M", "pid": PID,
+                    "tid": number, "args": {"sort_index": number}})
+    return {"traceEvents": out, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", nargs="?", help="capture file, stdin if omitted")
+    parser.add_argument("-o", "--output", help="write the JSON here, stdout if omitted")
+    args = parser.parse_args()
+
+    if args.capture:
+        with open(args.capture, "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    header, tasks, events = decode(data)
+    if header is None and not events:
+        sys.exit("no trace frames found")
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(chrome_trace(header, tasks, events), f)
+    else:
+        json.dump(chrome_trace(header, tasks, events), sys.stdout)
+
+    # Dropped events leave gaps, so say how many there were.
+    print("%d tasks, %d events, %d dropped" %
+          (len(tasks), len(events), header["dropped"] if header else 0), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()